@@ -0,0 +1,82 @@
+import csv
+import os
+import re
+import sys
+from collections import defaultdict
+
+# 汇总 bench_ls_backend.sh 的日志: 每个实例一行，并按 benchmark 族给出各配置的平均值
+DEFAULT_BACKENDS = ["ls", "sls"]
+METRICS = {
+    "steps_per_second": re.compile(r"LS steps per second: (\S+)"),
+    "time_to_first_sample": re.compile(r"Time to first sample: (\S+)"),
+    "unique_per_minute": re.compile(r"Unique samples per minute: (\S+)"),
+    "score_cache_hit_rate": re.compile(r"Score cache hit rate: (\S+)"),
+    "peak_rss_mb": re.compile(r"Peak RSS \(MB\): (\S+)"),
+}
+
+
+def parse_log(path: str) -> dict[str, float]:
+    res = {}
+    with open(path, "r", errors="replace") as f:
+        text = f.read()
+    for name, pattern in METRICS.items():
+        m = pattern.search(text)
+        if m:
+            res[name] = float(m.group(1))
+    return res
+
+
+def family_of(input_dir: str) -> dict[str, str]:
+    # 实例名 -> input_dir 下的第一级子目录
+    families = {}
+    for root, _, files in os.walk(input_dir):
+        rel = os.path.relpath(root, input_dir)
+        family = rel.split(os.sep)[0] if rel != "." else "."
+        for name in files:
+            if name.endswith(".smt2"):
+                families[name[: -len(".smt2")]] = family
+    return families
+
+
+def main(input_dir: str, output_dir: str, backends: list[str]):
+    families = family_of(input_dir)
+    rows = []
+    for instance, family in sorted(families.items()):
+        row = {"instance": instance, "family": family}
+        for backend in backends:
+            log = os.path.join(output_dir, backend, "logs", instance + ".log")
+            stats = parse_log(log) if os.path.exists(log) else {}
+            for name in METRICS:
+                row[f"{backend}_{name}"] = stats.get(name, "")
+        rows.append(row)
+
+    csv_path = os.path.join(output_dir, "ls_backend.csv")
+    with open(csv_path, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=list(rows[0].keys()) if rows else ["instance"])
+        writer.writeheader()
+        writer.writerows(rows)
+
+    # 时间到首个样本: 没有样本的实例 (-1 或缺失) 不计入平均
+    per_family = defaultdict(lambda: defaultdict(list))
+    for row in rows:
+        for key, value in row.items():
+            if key in ("instance", "family") or value == "" or (key.endswith("time_to_first_sample") and value < 0):
+                continue
+            per_family[row["family"]][key].append(value)
+
+    print(f"{'family':<24}" + "".join(f"{b + ' ' + n:>28}" for n in METRICS for b in backends))
+    for family, values in sorted(per_family.items()):
+        line = f"{family:<24}"
+        for name in METRICS:
+            for backend in backends:
+                v = values.get(f"{backend}_{name}", [])
+                line += f"{(sum(v) / len(v) if v else float('nan')):>28.2f}"
+        print(line)
+    print(f"per instance results: {csv_path}")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print(f"Usage: {sys.argv[0]} <input directory> <output directory> [config names ...]")
+        sys.exit(1)
+    main(sys.argv[1], sys.argv[2], sys.argv[3:] or DEFAULT_BACKENDS)
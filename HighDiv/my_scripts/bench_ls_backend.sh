@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# LS 后端/配置的对比测试，结果用 bench_ls_backend.py 汇总
+# 每个配置写成 name:highdiv 参数，默认对比 CCSS (-m ls) 与 z3 sls 引擎 (-m sls)，例如
+#   bench_ls_backend.sh 300 benchmarks out "full:-m ls" "k8:-m ls -k 8"
+#   bench_ls_backend.sh 300 benchmarks/pb2010 out "pb:-m ls" "generic:-m ls -G"
+#   bench_ls_backend.sh 300 benchmarks/CAV_2009_benchmarks out "idl:-m ls" "generic:-m ls -D"
+if [ "$#" -lt 3 ]; then
+  echo "Usage: $0 <time_limit> <input_directory> <output_directory> [name:flags ...]"
+  exit 1
+fi
+
+time_limit="$1"
+input_directory="$2"
+output_directory="$3"
+shift 3
+configs=("$@")
+if [ "${#configs[@]}" -eq 0 ]; then
+  configs=("ls:-m ls" "sls:-m sls")
+fi
+
+names=()
+for config in "${configs[@]}"; do
+  name="${config%%:*}"
+  names+=("$name")
+  mkdir -p "$output_directory/$name/logs"
+  echo "${config#*:}" > "$output_directory/$name/flags"
+done
+
+# 每个实例分别用各配置运行相同的时间，样本数不设上限
+find "$input_directory" -name '*.smt2' -type f | parallel -j 15 --bar \
+  timeout --kill-after=30 $((time_limit + 5)) "./highdiv -t $time_limit -n 100000000 -o $output_directory/{2} -s 0 \$(cat $output_directory/{2}/flags) -i {1} > $output_directory/{2}/logs/{1/.}.log 2>&1" :::: - ::: "${names[@]}"
+
+python3 "$(dirname "$0")/bench_ls_backend.py" "$input_directory" "$output_directory" "${names[@]}"
@@ -14,6 +14,7 @@ from fractions import Fraction
 import z3
 
 import sys
+import sample_reader
 
 sys.setrecursionlimit(20000000)
 
@@ -538,7 +539,10 @@ def calc_metric(
     print_first=False,
 ) -> fractions.Fraction:
     formula = _load_formula(_formula)
-    samples = parse_samples(_samples)
+    if sample_reader.is_binary(_samples.name):
+        samples = sample_reader.iter_binary_samples(_samples.name)
+    else:
+        samples = parse_samples(_samples)
 
     if _metric == "satisfies":
         metric: Metric = SatisfiesMetric(formula, use_c_api=_use_c_api)
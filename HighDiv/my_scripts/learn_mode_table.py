@@ -0,0 +1,105 @@
+import csv
+import os
+import re
+import sys
+from collections import defaultdict
+
+# 从候选配置的基准测试结果学习 -m auto 的模式表 (格式见 src/sampler/modeselect.h):
+# 每个公式类别选平均指标最高的配置, 另加一行 "*" 作为全体实例上最好的配置
+CLASS_PATTERN = re.compile(r"Formula class: (\S+)")
+UNIQUE_PATTERN = re.compile(r"Unique samples per minute: (\S+)")
+MODES = ("ls", "cdcl", "hybrid", "2ls")
+
+
+def instance_of(path: str) -> str:
+    # 日志 <实例>.log 与 results/ 中的 <目录>/<实例>.smt2 对应同一个实例名
+    name = os.path.basename(path)
+    for suffix in (".log", ".smt2"):
+        if name.endswith(suffix):
+            name = name[: -len(suffix)]
+    return name
+
+
+def parse_config(spec: str) -> tuple:
+    parts = spec.split(":")
+    defaults = ["hybrid", "1", "0.5", "60"]
+    parts += defaults[len(parts):]
+    mode, epoch, pct, timeout = parts[:4]
+    if mode not in MODES or int(epoch) <= 0 or not 0 <= float(pct) <= 1 or int(timeout) <= 0:
+        raise ValueError(spec)
+    return mode, int(epoch), float(pct), int(timeout)
+
+
+def read_classes(log_dir: str) -> dict[str, str]:
+    classes = {}
+    for name in os.listdir(log_dir):
+        if not name.endswith(".log"):
+            continue
+        with open(os.path.join(log_dir, name), "r", errors="replace") as f:
+            m = CLASS_PATTERN.search(f.read())
+        if m:
+            classes[instance_of(name)] = m.group(1)
+    return classes
+
+
+def read_metric(path: str) -> tuple[str, dict[str, float]]:
+    values = {}
+    if os.path.isdir(path):
+        for name in os.listdir(path):
+            if not name.endswith(".log"):
+                continue
+            with open(os.path.join(path, name), "r", errors="replace") as f:
+                m = UNIQUE_PATTERN.search(f.read())
+            if m:
+                values[instance_of(name)] = float(m.group(1))
+        return "unique samples per minute", values
+    # results/ 的 CSV: Filename,Percentage
+    with open(path, newline="") as f:
+        for row in csv.DictReader(f):
+            values[instance_of(row["Filename"])] = float(row["Percentage"].rstrip("%"))
+    return "coverage (%)", values
+
+
+def main(class_dir: str, table_path: str, sources: list[str]):
+    classes = read_classes(class_dir)
+    if not classes:
+        print(f"no 'Formula class:' line in the logs of {class_dir}")
+        exit(1)
+    configs, metrics, kinds = [], [], set()
+    for source in sources:
+        spec, path = source.split("=", 1)
+        configs.append(parse_config(spec))
+        kind, values = read_metric(path)
+        kinds.add(kind)
+        metrics.append(values)
+    if len(kinds) != 1:
+        print("all sources must be log directories, or all results CSVs")
+        exit(1)
+
+    # 缺失的实例 (超时或崩溃) 记为 0
+    per_class = defaultdict(list)
+    for instance, cls in classes.items():
+        per_class[cls].append(instance)
+    per_class["*"] = list(classes)
+
+    rows = []
+    for cls, instances in sorted(per_class.items(), key=lambda x: (x[0] == "*", x[0])):
+        means = [sum(values.get(i, 0.0) for i in instances) / len(instances) for values in metrics]
+        best = max(range(len(configs)), key=lambda k: (means[k], -k))
+        rows.append((cls, configs[best], means[best], len(instances)))
+
+    with open(table_path, "w") as f:
+        f.write(f"# learned by learn_mode_table.py, metric: {kinds.pop()}\n")
+        f.write("# class mode cdcl_epoch fixed_var_pct ls_timeout\n")
+        for cls, (mode, epoch, pct, timeout), mean, n in rows:
+            f.write(f"{cls} {mode} {epoch} {pct} {timeout}  # {n} instances, mean {mean:.2f}\n")
+    for cls, config, mean, n in rows:
+        print(f"{cls:<24}{':'.join(map(str, config)):>24}{mean:>12.2f}{n:>8}")
+    print(f"mode table: {table_path}")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 4:
+        print(f"Usage: {sys.argv[0]} <log directory with formula classes> <output table> <mode[:epoch[:pct[:ls_timeout]]]>=<log directory or results CSV> ...")
+        exit(1)
+    main(sys.argv[1], sys.argv[2], sys.argv[3:])
@@ -0,0 +1,125 @@
+import sys
+import typing as typ
+
+# 二进制样本文件 (HighDiv -f bin) 的读取器，格式说明见 src/sampler/sampleformat.h
+MAGIC = b"HDSB"
+FLAG_COMPRESSED = 1
+CODEC_ZERO_RUN = 1
+
+
+def _get_varint(buf: bytes, pos: int) -> tuple[int, int]:
+    value = 0
+    shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return value, pos
+        shift += 7
+
+
+def _read_varint(f: typ.BinaryIO) -> typ.Optional[int]:
+    value = 0
+    shift = 0
+    while True:
+        b = f.read(1)
+        if not b:
+            return None
+        value |= (b[0] & 0x7F) << shift
+        if not b[0] & 0x80:
+            return value
+        shift += 7
+
+
+def _zigzag_decode(v: int) -> int:
+    return (v >> 1) ^ -(v & 1)
+
+
+def _to_int128(v: int) -> int:
+    # 差分在写入端按 128 位回绕计算
+    v &= (1 << 128) - 1
+    return v - (1 << 128) if v >> 127 else v
+
+
+def _zero_run_decompress(payload: bytes) -> bytes:
+    out = bytearray()
+    pos = 0
+    while pos < len(payload):
+        b = payload[pos]
+        pos += 1
+        if b:
+            out.append(b)
+        else:
+            run, pos = _get_varint(payload, pos)
+            out.extend(bytes(run))
+    return bytes(out)
+
+
+def is_binary(path: str) -> bool:
+    with open(path, "rb") as f:
+        return f.read(len(MAGIC)) == MAGIC
+
+
+def read_columns(f: typ.BinaryIO) -> list[tuple[str, str]]:
+    if f.read(len(MAGIC)) != MAGIC:
+        raise ValueError("not a binary samples file")
+    version, _flags = f.read(2)
+    if version != 1:
+        raise ValueError(f"unsupported samples format version {version}")
+    columns = []
+    for _ in range(_read_varint(f)):
+        sort = "bool" if f.read(1) == b"B" else "int"
+        name = f.read(_read_varint(f)).decode()
+        columns.append((name, sort))
+    return columns
+
+
+def iter_binary_samples(path: str) -> typ.Iterator[list[tuple[str, int]]]:
+    with open(path, "rb") as f:
+        columns = read_columns(f)
+        names = [name for name, _ in columns]
+        while True:
+            nsamples = _read_varint(f)
+            if nsamples is None:
+                return
+            codec = f.read(1)[0]
+            payload = f.read(_read_varint(f))
+            if codec == CODEC_ZERO_RUN:
+                payload = _zero_run_decompress(payload)
+            prev = [0] * len(columns)
+            pos = 0
+            for _ in range(nsamples):
+                for c in range(len(columns)):
+                    zz, pos = _get_varint(payload, pos)
+                    prev[c] = _to_int128(prev[c] + _zigzag_decode(zz))
+                yield list(zip(names, prev))
+
+
+def iter_text_samples(path: str) -> typ.Iterator[list[tuple[str, int]]]:
+    with open(path, "r") as f:
+        for line in f:
+            p = line.split(" ", maxsplit=1)[1].strip("; \n").split(";")
+            sample = []
+            for x in p:
+                var, value = x.split(":")
+                if value in ("true", "false"):
+                    sample.append((var, int(value == "true")))
+                else:
+                    sample.append((var, int(value.strip("()").replace(" ", ""))))
+            yield sample
+
+
+def iter_samples(path: str) -> typ.Iterator[list[tuple[str, int]]]:
+    if is_binary(path):
+        return iter_binary_samples(path)
+    return iter_text_samples(path)
+
+
+# 将二进制样本文件转换为文本格式输出
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print(f"Usage: {sys.argv[0]} <samples file>")
+        sys.exit(1)
+    for idx, sample in enumerate(iter_samples(sys.argv[1])):
+        print(f"{idx}: " + "".join(f"{var}:{value};" for var, value in sample))
@@ -0,0 +1,332 @@
+#include "highdiv_api.h"
+
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include "../sampler/liasampler.h"
+
+namespace {
+
+struct SamplerParams {
+    sampler::SamplingMode mode = sampler::HYBRID;
+    unsigned seed = 0;
+    size_t max_samples = std::numeric_limits<unsigned>::max();
+    double time_limit = std::numeric_limits<double>::max();
+    size_t cdcl_epoch = 1;
+    double fixed_pct = 0.5;
+    bool cdcl_epoch_set = false;  // kept by the auto mode
+    bool fixed_pct_set = false;
+    size_t buffer = 1024;
+    bool bit_guided = false;
+    bool score_cache = false;
+    bool cdcl_diversify = false;
+    bool eliminate_equalities = false;
+    bool verbose = false;  // the sampler's log on stdout
+    unsigned candidate_clauses = 0;
+    unsigned warm_restart = 0;
+    size_t expand = 0;
+    size_t hash_batch = 16;
+    unsigned ls_timeout = 0;
+    std::string mode_table;
+    unsigned threads = 1;
+    size_t coverage_plateau = 0;
+};
+
+/*
+    Buffer between the sampling thread and the caller.  write_sample runs on
+    the sampling thread and waits while the buffer is full; a stop request
+    drops the sample being written and lets the sampling thread finish.
+*/
+class QueueSampleSink : public sampler::SampleSink {
+   public:
+    std::mutex mu;
+    std::condition_variable cv;
+    std::vector<sampler::SampleColumn> columns;
+    std::deque<std::vector<__int128_t>> queue;
+    size_t capacity = 1024;
+    bool opened = false;
+    bool finished = false;
+    bool stop = false;
+
+    bool open(const std::vector<sampler::SampleColumn>& _columns) override {
+        std::lock_guard<std::mutex> lock(mu);
+        columns = _columns;
+        opened = true;
+        cv.notify_all();
+        return true;
+    }
+
+    void write_sample(size_t /*idx*/, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) override {
+        // align to the columns as BinarySampleWriter::write_sample does
+        std::vector<__int128_t> row(columns.size(), 0);
+        auto it = sample.begin();
+        size_t val_idx = 0;
+        for (size_t c = 0; c < columns.size(); ++c) {
+            while (it != sample.end() && it->first < columns[c].name) {
+                ++it;
+                ++val_idx;
+            }
+            if (it != sample.end() && it->first == columns[c].name) {
+                row[c] = values[val_idx];
+            }
+        }
+        std::unique_lock<std::mutex> lock(mu);
+        cv.wait(lock, [&] { return stop || queue.size() < capacity; });
+        if (stop) {
+            return;
+        }
+        queue.push_back(std::move(row));
+        cv.notify_all();
+    }
+};
+
+}  // namespace
+
+struct _highdiv_sampler {
+    z3::context ctx;
+    z3::expr formula;
+    SamplerParams params;
+    std::unique_ptr<sampler::LiaSampler> sampler;
+    QueueSampleSink* sink = nullptr;  // owned by sampler
+    std::thread worker;
+    bool started = false;
+    std::chrono::steady_clock::time_point start_time;
+    size_t num_returned = 0;
+    size_t num_truncated = 0;
+    std::string error;
+
+    _highdiv_sampler() : formula(ctx) {}
+};
+
+static void start_sampling(highdiv_sampler s) {
+    if (s->started) {
+        return;
+    }
+    s->started = true;
+    s->start_time = std::chrono::steady_clock::now();
+    const SamplerParams& p = s->params;
+    s->sampler = std::make_unique<sampler::LiaSampler>(&s->ctx, "", "", p.max_samples, p.time_limit, p.mode, p.seed, p.cdcl_epoch, p.fixed_pct);
+    s->sampler->set_formula(s->formula);
+    s->sampler->set_log(p.verbose ? std::cout.rdbuf() : nullptr);
+    s->sampler->set_samples_file(false);
+    s->sampler->set_bit_guided(p.bit_guided);
+    s->sampler->set_score_cache(p.score_cache);
+    s->sampler->set_cdcl_diversify(p.cdcl_diversify);
+    s->sampler->set_eliminate_equalities(p.eliminate_equalities);
+    s->sampler->set_candidate_clauses(p.candidate_clauses);
+    s->sampler->set_warm_restart(p.warm_restart);
+    s->sampler->set_model_expansion(p.expand);
+    s->sampler->set_hash_batch(p.hash_batch);
+    s->sampler->set_ls_timeout(p.ls_timeout);
+    s->sampler->keep_mode_params(p.cdcl_epoch_set, p.fixed_pct_set);
+    if (!p.mode_table.empty()) {
+        s->sampler->set_mode_table(p.mode_table);  // read once by highdiv_set_param already
+    }
+    s->sampler->set_parallel_cdcl(p.threads, p.threads);
+    s->sampler->set_coverage(false, p.coverage_plateau);
+    auto sink = std::make_unique<QueueSampleSink>();
+    sink->capacity = std::max(p.buffer, (size_t)1);
+    s->sink = sink.get();
+    s->sampler->add_sink(std::move(sink));
+    s->worker = std::thread([s] {
+        try {
+            s->sampler->sampling();
+        } catch (z3::exception& ex) {
+            std::lock_guard<std::mutex> lock(s->sink->mu);
+            s->error = ex.msg();
+        }
+        std::lock_guard<std::mutex> lock(s->sink->mu);
+        s->sink->finished = true;
+        s->sink->cv.notify_all();
+    });
+}
+
+static highdiv_sampler create(const std::function<z3::expr(z3::context&)>& mk_formula) {
+    highdiv_sampler s = new _highdiv_sampler();
+    try {
+        s->formula = mk_formula(s->ctx);
+    } catch (z3::exception&) {
+        delete s;
+        return nullptr;
+    }
+    return s;
+}
+
+extern "C" {
+
+highdiv_sampler highdiv_create_from_file(const char* path) {
+    return create([&](z3::context& ctx) { return z3::mk_and(ctx.parse_file(path)); });
+}
+
+highdiv_sampler highdiv_create_from_string(const char* smtlib2) {
+    return create([&](z3::context& ctx) { return z3::mk_and(ctx.parse_string(smtlib2)); });
+}
+
+highdiv_sampler highdiv_create_from_ast(Z3_context c, Z3_ast a) {
+    return create([&](z3::context& ctx) {
+        z3::expr e(ctx, Z3_translate(c, a, ctx));
+        ctx.check_error();
+        return e;
+    });
+}
+
+bool highdiv_set_param(highdiv_sampler s, const char* name, const char* value) {
+    if (s->started) {
+        return false;
+    }
+    SamplerParams& p = s->params;
+    std::string n = name, v = value;
+    bool is_flag = v == "true" || v == "false";
+    char* end;
+    double num = strtod(value, &end);
+    bool is_num = *value != 0 && *end == 0 && num >= 0;
+    if (n == "mode") {
+        static const std::map<std::string, sampler::SamplingMode> modes = {
+            {"ls", sampler::LS}, {"sls", sampler::SLS}, {"cdcl", sampler::CDCL}, {"hybrid", sampler::HYBRID}, {"2ls", sampler::LS_ITER}, {"adaptive", sampler::ADAPTIVE}, {"hash", sampler::HASH}, {"auto", sampler::AUTO}};
+        auto it = modes.find(v);
+        if (it == modes.end()) {
+            return false;
+        }
+        p.mode = it->second;
+    } else if (is_flag && (n == "bit_guided" || n == "score_cache" || n == "cdcl_diversify" || n == "eliminate_equalities" || n == "verbose")) {
+        bool f = v == "true";
+        (n == "bit_guided" ? p.bit_guided : n == "score_cache" ? p.score_cache : n == "cdcl_diversify" ? p.cdcl_diversify : n == "verbose" ? p.verbose : p.eliminate_equalities) = f;
+    } else if (n == "mode_table") {
+        sampler::ModeSelector selector;
+        if (!selector.load(v)) {
+            return false;
+        }
+        p.mode_table = v;
+    } else if (!is_num) {
+        return false;
+    } else if (n == "seed") {
+        p.seed = (unsigned)num;
+    } else if (n == "max_samples") {
+        p.max_samples = std::min(num, (double)std::numeric_limits<unsigned>::max());
+    } else if (n == "time_limit") {
+        p.time_limit = num;
+    } else if (n == "cdcl_epoch") {
+        p.cdcl_epoch = (size_t)num;
+        p.cdcl_epoch_set = true;
+    } else if (n == "fixed_pct" && num <= 1) {
+        p.fixed_pct = num;
+        p.fixed_pct_set = true;
+    } else if (n == "buffer") {
+        p.buffer = (size_t)num;
+    } else if (n == "candidate_clauses") {
+        p.candidate_clauses = (unsigned)num;
+    } else if (n == "warm_restart" && num <= 100) {
+        p.warm_restart = (unsigned)num;
+    } else if (n == "expand") {
+        p.expand = (size_t)num;
+    } else if (n == "ls_timeout" && num >= 1) {
+        p.ls_timeout = (unsigned)num;
+    } else if (n == "hash_batch" && num >= 1) {
+        p.hash_batch = (size_t)num;
+    } else if (n == "threads" && num >= 1) {
+        p.threads = (unsigned)num;
+    } else if (n == "coverage_plateau") {
+        p.coverage_plateau = (size_t)num;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// waits until the sampler has opened its sinks, which follows parsing and preprocessing
+static const std::vector<sampler::SampleColumn>& get_columns(highdiv_sampler s) {
+    start_sampling(s);
+    std::unique_lock<std::mutex> lock(s->sink->mu);
+    s->sink->cv.wait(lock, [&] { return s->sink->opened || s->sink->finished; });
+    return s->sink->columns;
+}
+
+unsigned highdiv_num_columns(highdiv_sampler s) {
+    return get_columns(s).size();
+}
+
+const char* highdiv_column_name(highdiv_sampler s, unsigned i) {
+    const std::vector<sampler::SampleColumn>& columns = get_columns(s);
+    return i < columns.size() ? columns[i].name.c_str() : "";
+}
+
+bool highdiv_column_is_bool(highdiv_sampler s, unsigned i) {
+    const std::vector<sampler::SampleColumn>& columns = get_columns(s);
+    return i < columns.size() && columns[i].sort == 'B';
+}
+
+unsigned highdiv_next_batch(highdiv_sampler s, unsigned k, int64_t* values) {
+    size_t ncols = get_columns(s).size();
+    QueueSampleSink* sink = s->sink;
+    std::unique_lock<std::mutex> lock(sink->mu);
+    sink->cv.wait(lock, [&] { return sink->finished || sink->queue.size() >= std::min((size_t)k, sink->capacity); });
+    unsigned n = 0;
+    while (n < k) {
+        if (sink->queue.empty()) {
+            if (sink->finished) {
+                break;
+            }
+            sink->cv.wait(lock, [&] { return sink->finished || !sink->queue.empty(); });
+            continue;
+        }
+        const std::vector<__int128_t>& row = sink->queue.front();
+        for (size_t c = 0; c < ncols; ++c) {
+            __int128_t v = row[c];
+            if (v > std::numeric_limits<int64_t>::max() || v < std::numeric_limits<int64_t>::min()) {
+                v = v > 0 ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min();
+                s->num_truncated++;
+            }
+            values[n * ncols + c] = (int64_t)v;
+        }
+        sink->queue.pop_front();
+        sink->cv.notify_all();
+        n++;
+    }
+    s->num_returned += n;
+    return n;
+}
+
+double highdiv_get_stat(highdiv_sampler s, const char* name) {
+    std::string n = name;
+    if (n == "samples") {
+        return s->num_returned;
+    }
+    if (n == "truncated_values") {
+        return s->num_truncated;
+    }
+    if (n == "time") {
+        return s->started ? std::chrono::duration<double>(std::chrono::steady_clock::now() - s->start_time).count() : 0;
+    }
+    if (n == "buffered" || n == "finished") {
+        if (!s->started) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(s->sink->mu);
+        return n == "buffered" ? s->sink->queue.size() : s->sink->finished;
+    }
+    return -1;
+}
+
+const char* highdiv_get_error(highdiv_sampler s) {
+    if (!s->started) {
+        return s->error.c_str();
+    }
+    std::lock_guard<std::mutex> lock(s->sink->mu);
+    return s->error.c_str();
+}
+
+void highdiv_destroy(highdiv_sampler s) {
+    if (s->started) {
+        {
+            std::lock_guard<std::mutex> lock(s->sink->mu);
+            s->sink->stop = true;
+            s->sink->cv.notify_all();
+        }
+        s->sampler->request_stop();
+        s->worker.join();
+    }
+    delete s;
+}
+}
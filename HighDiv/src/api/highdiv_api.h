@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include <z3.h>
+
+/*
+    C API of the HighDiv sampler (libhighdiv), for callers that pull samples
+    in-process instead of running the highdiv binary and parsing its output.
+
+    A sampler owns its own Z3 context.  Sampling runs on a background thread,
+    started by the first call that needs the columns or the samples, and
+    feeds a bounded buffer; when the buffer is full the sampler waits for
+    the caller, so an idle caller costs no CPU.  No samples file is written.
+
+    Unless highdiv_set_param says otherwise, the sampler runs in the hybrid
+    mode without a sample or time limit, until it is destroyed.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _highdiv_sampler* highdiv_sampler;
+
+/**
+   \brief Create a sampler for the conjunction of the assertions of an SMT-LIB2 file.
+   Return NULL if the file cannot be parsed.
+*/
+highdiv_sampler highdiv_create_from_file(const char* path);
+
+/**
+   \brief Create a sampler for the conjunction of the assertions of an SMT-LIB2 string.
+   Return NULL if the string cannot be parsed.
+*/
+highdiv_sampler highdiv_create_from_string(const char* smtlib2);
+
+/**
+   \brief Create a sampler for the Boolean formula \c a of the context \c c.
+   The formula is translated into the sampler's context, \c c is not used afterwards.
+*/
+highdiv_sampler highdiv_create_from_ast(Z3_context c, Z3_ast a);
+
+/**
+   \brief Set a parameter before sampling starts; return false for an unknown name or value, or once sampling has started.
+
+   - mode: ls, sls, cdcl, hybrid (default), 2ls, adaptive, hash, auto
+   - mode_table: file of the auto mode table, see HighDiv/src/sampler/modeselect.h; cdcl_epoch, fixed_pct and ls_timeout set here win over it
+   - seed, max_samples, time_limit (seconds), cdcl_epoch, fixed_pct
+   - buffer: samples buffered ahead of the caller (default 1024)
+   - bit_guided, score_cache, cdcl_diversify, eliminate_equalities: true / false
+   - verbose: true prints the sampler's progress and statistics on stdout (default false)
+   - candidate_clauses, warm_restart, expand, threads, coverage_plateau, hash_batch, ls_timeout
+*/
+bool highdiv_set_param(highdiv_sampler s, const char* name, const char* value);
+
+/**
+   \brief Number of columns of a sample: the Int and Bool constants of the formula, sorted by name.
+*/
+unsigned highdiv_num_columns(highdiv_sampler s);
+
+/**
+   \brief Name of column \c i.
+*/
+const char* highdiv_column_name(highdiv_sampler s, unsigned i);
+
+/**
+   \brief True if column \c i is a Bool constant (values 0 / 1).
+*/
+bool highdiv_column_is_bool(highdiv_sampler s, unsigned i);
+
+/**
+   \brief Wait for up to \c k new unique samples and write them row by row to \c values,
+   which must hold k * highdiv_num_columns(s) entries.
+
+   Return the number of samples written: less than \c k only when sampling has finished.
+   Values outside the int64_t range are saturated and counted in the statistic truncated_values.
+*/
+unsigned highdiv_next_batch(highdiv_sampler s, unsigned k, int64_t* values);
+
+/**
+   \brief Value of a statistic: samples (returned so far), buffered, time (seconds since
+   sampling started), truncated_values, finished (0 / 1).  Return -1 for an unknown name.
+*/
+double highdiv_get_stat(highdiv_sampler s, const char* name);
+
+/**
+   \brief Message of the last error of the sampler (parse or sampling failure), empty if none.
+*/
+const char* highdiv_get_error(highdiv_sampler s);
+
+/**
+   \brief Stop sampling and free the sampler.
+*/
+void highdiv_destroy(highdiv_sampler s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,164 @@
+############################################
+# HighDiv Python interface
+#
+# Thin ctypes wrapper of the C API in highdiv_api.h.
+############################################
+
+"""Pull HighDiv samples in-process.
+
+libhighdiv.so is looked up in the HIGHDIV_LIB environment variable, then next
+to this module.  A sampler created from a z3 expression passes the expression
+to libhighdiv directly, so the z3 module must load the libz3 that libhighdiv
+was linked against.
+
+Small example:
+
+>>> s = Sampler('(declare-const x Int) (assert (and (>= x 0) (< x 4)))')
+>>> s.set(mode='cdcl', seed=1, max_samples=4, time_limit=10)
+>>> s.columns()
+[('x', 'Int')]
+>>> sorted(row[0] for row in s.next_batch(10))
+[0, 1, 2, 3]
+>>> s.statistics()['finished']
+1.0
+"""
+import ctypes
+import os
+
+
+class HighDivException(Exception):
+    def __init__(self, value):
+        self.value = value
+
+    def __str__(self):
+        return str(self.value)
+
+
+def _load_lib():
+    path = os.environ.get("HIGHDIV_LIB")
+    if path is None:
+        path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "libhighdiv.so")
+    lib = ctypes.CDLL(path)
+    lib.highdiv_create_from_file.restype = ctypes.c_void_p
+    lib.highdiv_create_from_file.argtypes = [ctypes.c_char_p]
+    lib.highdiv_create_from_string.restype = ctypes.c_void_p
+    lib.highdiv_create_from_string.argtypes = [ctypes.c_char_p]
+    lib.highdiv_create_from_ast.restype = ctypes.c_void_p
+    lib.highdiv_create_from_ast.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+    lib.highdiv_set_param.restype = ctypes.c_bool
+    lib.highdiv_set_param.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p]
+    lib.highdiv_num_columns.restype = ctypes.c_uint
+    lib.highdiv_num_columns.argtypes = [ctypes.c_void_p]
+    lib.highdiv_column_name.restype = ctypes.c_char_p
+    lib.highdiv_column_name.argtypes = [ctypes.c_void_p, ctypes.c_uint]
+    lib.highdiv_column_is_bool.restype = ctypes.c_bool
+    lib.highdiv_column_is_bool.argtypes = [ctypes.c_void_p, ctypes.c_uint]
+    lib.highdiv_next_batch.restype = ctypes.c_uint
+    lib.highdiv_next_batch.argtypes = [ctypes.c_void_p, ctypes.c_uint, ctypes.POINTER(ctypes.c_int64)]
+    lib.highdiv_get_stat.restype = ctypes.c_double
+    lib.highdiv_get_stat.argtypes = [ctypes.c_void_p, ctypes.c_char_p]
+    lib.highdiv_get_error.restype = ctypes.c_char_p
+    lib.highdiv_get_error.argtypes = [ctypes.c_void_p]
+    lib.highdiv_destroy.restype = None
+    lib.highdiv_destroy.argtypes = [ctypes.c_void_p]
+    return lib
+
+
+_lib = None
+
+
+def _get_lib():
+    global _lib
+    if _lib is None:
+        _lib = _load_lib()
+    return _lib
+
+
+_STATS = ["samples", "buffered", "time", "truncated_values", "finished"]
+
+
+class Sampler:
+    """Sampler of the models of an SMT(LIA) formula.
+
+    `formula` is a z3 Boolean expression or an SMT-LIB2 string; sampling
+    starts with the first call to columns() or next_batch() and runs on a
+    background thread until the sampler is deleted or a limit is reached.
+    """
+
+    def __init__(self, formula=None, _handle=None):
+        self.lib = _get_lib()
+        self.handle = _handle
+        if self.handle is None:
+            if isinstance(formula, str):
+                self.handle = self.lib.highdiv_create_from_string(formula.encode())
+            else:
+                self.handle = self.lib.highdiv_create_from_ast(formula.ctx_ref(), formula.as_ast())
+        if not self.handle:
+            raise HighDivException("cannot parse the formula")
+        self._columns = None
+
+    @classmethod
+    def from_file(cls, path):
+        """Create a sampler of the conjunction of the assertions of an SMT-LIB2 file."""
+        handle = _get_lib().highdiv_create_from_file(path.encode())
+        if not handle:
+            raise HighDivException("cannot parse %s" % path)
+        return cls(_handle=handle)
+
+    def __del__(self):
+        if getattr(self, "handle", None):
+            self.lib.highdiv_destroy(self.handle)
+            self.handle = None
+
+    def set(self, **kwargs):
+        """Set parameters before sampling starts, see highdiv_set_param.
+
+        >>> s = Sampler('(declare-const b Bool) (assert b)')
+        >>> s.set(mode='cdcl', cdcl_diversify=True)
+        >>> s.set(mode='random')  # doctest: +IGNORE_EXCEPTION_DETAIL
+        Traceback (most recent call last):
+        ...
+        HighDivException: invalid parameter mode=random
+        """
+        for name, value in kwargs.items():
+            v = ("true" if value else "false") if isinstance(value, bool) else str(value)
+            if not self.lib.highdiv_set_param(self.handle, name.encode(), v.encode()):
+                raise HighDivException("invalid parameter %s=%s" % (name, v))
+
+    def columns(self):
+        """Names and sorts ('Int' or 'Bool') of the sample columns, sorted by name."""
+        if self._columns is None:
+            n = self.lib.highdiv_num_columns(self.handle)
+            self._columns = [
+                (self.lib.highdiv_column_name(self.handle, i).decode(), "Bool" if self.lib.highdiv_column_is_bool(self.handle, i) else "Int")
+                for i in range(n)
+            ]
+            self._check_error()
+        return self._columns
+
+    def next_batch(self, k):
+        """Up to `k` new unique samples, each a list of one int per column.
+
+        Fewer than `k` samples are returned only once sampling has finished.
+        """
+        ncols = len(self.columns())
+        buf = (ctypes.c_int64 * (k * max(ncols, 1)))()
+        n = self.lib.highdiv_next_batch(self.handle, k, buf)
+        self._check_error()
+        return [buf[i * ncols:(i + 1) * ncols] for i in range(n)]
+
+    def statistics(self):
+        """Dictionary of the statistics of highdiv_get_stat."""
+        return {name: self.lib.highdiv_get_stat(self.handle, name.encode()) for name in _STATS}
+
+    def _check_error(self):
+        msg = self.lib.highdiv_get_error(self.handle)
+        if msg:
+            raise HighDivException(msg.decode())
+
+
+if __name__ == "__main__":
+    import doctest
+
+    if doctest.testmod().failed:
+        exit(1)
@@ -9,6 +9,36 @@ struct my_args {
     int randomSeed = 0;
     size_t cdclEpoch = 1;
     double fixedVarsPct = 0.5;
+    bool cdclEpochSet = false;  // -e / -p given: -m auto keeps them
+    bool fixedVarsPctSet = false;
+    sampler::SampleFormat format = sampler::TEXT_FORMAT;
+    bool compressBlocks = false;
+    bool bitGuided = false;
+    size_t expandModels = 0;
+    unsigned candidateClauses = 0;
+    bool scoreCache = false;
+    unsigned warmRestartPct = 0;
+    bool eliminateEqualities = false;
+    bool pbFastPath = true;
+    bool idlFastPath = true;
+    bool cdclDiversify = false;
+    size_t blockGcInterval = 1000;
+    size_t hashBatch = 16;
+    unsigned cdclThreads = 1;
+    unsigned cdclThreadModels = 0;
+    unsigned numWorkers = 0;  // 0: no partitioning
+    unsigned workerIdx = 0;
+    sampler::PartitionMode partitionMode = sampler::CUBE_PARTITION;
+    size_t poolSize = 0;
+    double poolCheckpointSec = 60.0;
+    double checkpointSec = 0;  // 0: no checkpoints
+    bool resume = false;
+    bool trackCoverage = false;
+    size_t coveragePlateau = 0;  // 0: no early stop
+    std::vector<std::unique_ptr<sampler::SampleSink>> sinks;
+    std::string lsTrace;
+    unsigned lsTimeout = 0;  // 0: the mode's default
+    std::string modeTable;
 };
 
 void printHelp(const char* programName) {
@@ -19,9 +49,34 @@ void printHelp(const char* programName) {
     std::cout << "  -n <num samples>            Specify the number of samples\n";
     std::cout << "  -t <time limit>             Set the time limit (in seconds)\n";
     std::cout << "  -s <seed>                   Set the random seed\n";
-    std::cout << "  -m <sampling mode>          Set the sampling mode <ls, cdcl, hybrid>\n";
-    std::cout << "  -e <cdcl epoch>             Set CDCL epochs for sampling (Only effective in hybrid mode)\n";
-    std::cout << "  -p <fixed var percentage>   Set the percentage of fixed variables (Only effective in hybrid mode)\n";
+    std::cout << "  -m <sampling mode>          Set the sampling mode <ls, sls, cdcl, hybrid, adaptive, hash, auto>\n";
+    std::cout << "  -e <cdcl epoch>             Set CDCL epochs for sampling (Only effective in hybrid mode, kept by auto)\n";
+    std::cout << "  -p <fixed var percentage>   Set the percentage of fixed (sls: seeded) variables (Only effective in hybrid/sls mode, kept by auto)\n";
+    std::cout << "  -f <output format>          Set the samples file format <text, bin> (default text)\n";
+    std::cout << "  -c                          Compress the blocks of the binary samples file\n";
+    std::cout << "  -b                          Bit guided LS: prefer moves covering value bits unseen in earlier samples\n";
+    std::cout << "  -x <k>                      Expand each CDCL(T) model into up to k more samples with the same Boolean skeleton\n";
+    std::cout << "  -k <num clauses>            LS builds move candidates from k sampled unsat clauses per step (0: all, default; 4 measured best)\n";
+    std::cout << "  -r                          LS caches move scores until a clause around the moved variable changes\n";
+    std::cout << "  -w <percentage>             LS restarts re-draw only this percentage of the Int variables (0: cold restarts, default)\n";
+    std::cout << "  -q                          LS eliminates unit Int equalities and searches over the remaining variables\n";
+    std::cout << "  -G                          LS keeps the generic search on pseudo-Boolean (all Int variables 0/1) instances\n";
+    std::cout << "  -D                          LS keeps the generic move scoring on difference logic (all literals x - y <= k) instances\n";
+    std::cout << "  -d                          CDCL(T) redraws decision phases, activities and arithmetic values between consecutive checks\n";
+    std::cout << "  --block-gc <n>              CDCL mode drops its blocking clauses and redraws the projection every n models (default 1000)\n";
+    std::cout << "  --hash-batch <n>            Hash mode samples n solutions per random cell and sizes the cells to hold about n (default 16)\n";
+    std::cout << "  -j <threads>[:<models>]     CDCL(T) checks run on this many threads and return up to <models> models of all threads (default <threads>)\n";
+    std::cout << "  -P <workers>:<index>        Sample only worker <index>'s cube of a split of the solution space among <workers> workers\n";
+    std::cout << "  -H                          Split the solution space by sample hash buckets instead of cubes (with -P)\n";
+    std::cout << "  -K <k>[:<seconds>]          Sample until the time limit and keep the k most mutually distant samples, written every <seconds> (default 60)\n";
+    std::cout << "  --checkpoint <seconds>      Save the sampling state next to the samples file at this interval\n";
+    std::cout << "  --resume                    Continue from the last checkpoint of the same output file, if any\n";
+    std::cout << "  --coverage                  Track the wire coverage of the samples and report it over time\n";
+    std::cout << "  --coverage-plateau <n>      Track the wire coverage and stop after n consecutive samples without new coverage\n";
+    std::cout << "  --sink <spec>               Also stream the samples to stdout, fifo:<path> or shm:<name>[:<slots>] (repeatable)\n";
+    std::cout << "  --ls-timeout <seconds>      Bound every LS check of the ls, sls, hybrid, 2ls and hash modes (default 60, ls: 50, hash: 10)\n";
+    std::cout << "  --mode-table <file>         Mode table of -m auto: formula class -> mode, cdcl epoch, fixed var percentage, LS timeout (-e, -p, --ls-timeout win)\n";
+    std::cout << "  --ls-trace <file>           Record the moves and scorings of the first LS search to this file for replay\n";
     std::cout << "  -h                          Display this help message\n";
 }
 
@@ -78,6 +133,14 @@ bool parseOpt(my_args* argp, int argc, char* argv[]) {
                     argp->mode = sampler::HYBRID;
                 } else if (m == "2ls" || m == "2LS"){
                     argp->mode = sampler::LS_ITER;
+                } else if (m == "sls" || m == "SLS") {
+                    argp->mode = sampler::SLS;
+                } else if (m == "adaptive" || m == "ADAPTIVE") {
+                    argp->mode = sampler::ADAPTIVE;
+                } else if (m == "hash" || m == "HASH") {
+                    argp->mode = sampler::HASH;
+                } else if (m == "auto" || m == "AUTO") {
+                    argp->mode = sampler::AUTO;
                 } else{
                     std::cerr << "Unknown sampling mode " << m << std::endl;
                     return false;
@@ -88,17 +151,165 @@ bool parseOpt(my_args* argp, int argc, char* argv[]) {
             }
 
         } else if (arg == "-e") {
-            if (i + 1 < argc)
-                argp->randomSeed = atoll(argv[++i]);
-            else {
+            if (i + 1 < argc) {
+                argp->cdclEpoch = atoll(argv[++i]);
+                argp->cdclEpochSet = true;
+            } else {
                 std::cerr << "Please enter CDCL epochs." << std::endl;
                 return false;
             }
         } else if (arg == "-p") {
+            if (i + 1 < argc) {
+                argp->fixedVarsPct = atof(argv[++i]);
+                argp->fixedVarsPctSet = true;
+            } else {
+                std::cerr << "Please enter fixed vars percentage." << std::endl;
+                return false;
+            }
+        } else if (arg == "-f") {
+            if (i + 1 < argc) {
+                ++i;
+                std::string f = argv[i];
+                if (f == "text") {
+                    argp->format = sampler::TEXT_FORMAT;
+                } else if (f == "bin") {
+                    argp->format = sampler::BINARY_FORMAT;
+                } else {
+                    std::cerr << "Unknown output format " << f << std::endl;
+                    return false;
+                }
+            } else {
+                std::cerr << "Please select output format." << std::endl;
+                return false;
+            }
+        } else if (arg == "-c") {
+            argp->compressBlocks = true;
+        } else if (arg == "-b") {
+            argp->bitGuided = true;
+        } else if (arg == "-x") {
             if (i + 1 < argc)
-                argp->randomSeed = atof(argv[++i]);
+                argp->expandModels = atoll(argv[++i]);
             else {
-                std::cerr << "Please enter fixed vars percentage." << std::endl;
+                std::cerr << "Please enter the number of samples per CDCL(T) model." << std::endl;
+                return false;
+            }
+        } else if (arg == "-k") {
+            if (i + 1 < argc)
+                argp->candidateClauses = atoi(argv[++i]);
+            else {
+                std::cerr << "Please enter the number of candidate clauses." << std::endl;
+                return false;
+            }
+        } else if (arg == "-r") {
+            argp->scoreCache = true;
+        } else if (arg == "-w") {
+            if (i + 1 < argc)
+                argp->warmRestartPct = atoi(argv[++i]);
+            else {
+                std::cerr << "Please enter the warm restart percentage." << std::endl;
+                return false;
+            }
+        } else if (arg == "-q") {
+            argp->eliminateEqualities = true;
+        } else if (arg == "-G") {
+            argp->pbFastPath = false;
+        } else if (arg == "-D") {
+            argp->idlFastPath = false;
+        } else if (arg == "-d") {
+            argp->cdclDiversify = true;
+        } else if (arg == "-j") {
+            unsigned threads, models;
+            int n = i + 1 < argc ? sscanf(argv[i + 1], "%u:%u", &threads, &models) : 0;
+            if (n >= 1 && threads > 0) {
+                argp->cdclThreads = threads;
+                argp->cdclThreadModels = n == 2 ? models : threads;
+                i++;
+            } else {
+                std::cerr << "Please enter <threads>[:<models>] for -j." << std::endl;
+                return false;
+            }
+        } else if (arg == "--block-gc") {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+                argp->blockGcInterval = atoi(argv[++i]);
+            else {
+                std::cerr << "Please enter a positive number of blocking clauses." << std::endl;
+                return false;
+            }
+        } else if (arg == "--hash-batch") {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+                argp->hashBatch = atoi(argv[++i]);
+            else {
+                std::cerr << "Please enter a positive number of solutions per cell." << std::endl;
+                return false;
+            }
+        } else if (arg == "-P") {
+            unsigned workers, idx;
+            if (i + 1 < argc && sscanf(argv[++i], "%u:%u", &workers, &idx) == 2 && workers > 0 && idx < workers) {
+                argp->numWorkers = workers;
+                argp->workerIdx = idx;
+            } else {
+                std::cerr << "Please enter the partition as <workers>:<index>." << std::endl;
+                return false;
+            }
+        } else if (arg == "-H") {
+            argp->partitionMode = sampler::HASH_PARTITION;
+        } else if (arg == "--checkpoint") {
+            if (i + 1 < argc)
+                argp->checkpointSec = atof(argv[++i]);
+            else {
+                std::cerr << "Please enter the checkpoint interval." << std::endl;
+                return false;
+            }
+        } else if (arg == "--resume") {
+            argp->resume = true;
+        } else if (arg == "--coverage") {
+            argp->trackCoverage = true;
+        } else if (arg == "--coverage-plateau") {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+                argp->coveragePlateau = atoi(argv[++i]);
+            else {
+                std::cerr << "Please enter a positive number of samples." << std::endl;
+                return false;
+            }
+        } else if (arg == "--sink") {
+            std::unique_ptr<sampler::SampleSink> sink = i + 1 < argc ? sampler::make_sample_sink(argv[++i]) : nullptr;
+            if (sink)
+                argp->sinks.push_back(std::move(sink));
+            else {
+                std::cerr << "Please enter the sink as stdout, fifo:<path> or shm:<name>[:<slots>]." << std::endl;
+                return false;
+            }
+        } else if (arg == "--ls-timeout") {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+                argp->lsTimeout = atoi(argv[++i]);
+            else {
+                std::cerr << "Please enter a positive LS timeout in seconds." << std::endl;
+                return false;
+            }
+        } else if (arg == "--mode-table") {
+            if (i + 1 < argc)
+                argp->modeTable = argv[++i];
+            else {
+                std::cerr << "Please enter a mode table file." << std::endl;
+                return false;
+            }
+        } else if (arg == "--ls-trace") {
+            if (i + 1 < argc)
+                argp->lsTrace = argv[++i];
+            else {
+                std::cerr << "Please enter the trace file." << std::endl;
+                return false;
+            }
+        } else if (arg == "-K") {
+            size_t k;
+            double sec;
+            int n = i + 1 < argc ? sscanf(argv[++i], "%zu:%lf", &k, &sec) : 0;
+            if (n >= 1 && k > 0) {
+                argp->poolSize = k;
+                if (n == 2)
+                    argp->poolCheckpointSec = sec;
+            } else {
+                std::cerr << "Please enter the pool size as <k>[:<seconds>]." << std::endl;
                 return false;
             }
         } else {
@@ -130,6 +341,37 @@ int main(int argc, char* argv[]) {
     z3::context ctx;
     sampler::LiaSampler mySampler(&ctx , arg.smtFilePath, arg.outputDir, arg.maxNumSamples, arg.maxTimeLimit, arg.mode, arg.randomSeed, arg.cdclEpoch, arg.fixedVarsPct);
 
+    mySampler.set_output_format(arg.format, arg.compressBlocks);
+    mySampler.set_bit_guided(arg.bitGuided);
+    mySampler.set_model_expansion(arg.expandModels);
+    mySampler.set_candidate_clauses(arg.candidateClauses);
+    mySampler.set_score_cache(arg.scoreCache);
+    mySampler.set_warm_restart(arg.warmRestartPct);
+    mySampler.set_eliminate_equalities(arg.eliminateEqualities);
+    mySampler.set_pb_fast_path(arg.pbFastPath);
+    mySampler.set_idl_fast_path(arg.idlFastPath);
+    mySampler.set_ls_trace(arg.lsTrace);
+    mySampler.set_ls_timeout(arg.lsTimeout);
+    mySampler.keep_mode_params(arg.cdclEpochSet, arg.fixedVarsPctSet);
+    if (!arg.modeTable.empty() && !mySampler.set_mode_table(arg.modeTable)) {
+        std::cerr << "Unable to read the mode table " << arg.modeTable << std::endl;
+        return 1;
+    }
+    mySampler.set_cdcl_diversify(arg.cdclDiversify);
+    mySampler.set_block_gc_interval(arg.blockGcInterval);
+    mySampler.set_hash_batch(arg.hashBatch);
+    mySampler.set_parallel_cdcl(arg.cdclThreads, arg.cdclThreadModels);
+    mySampler.set_checkpoint(arg.checkpointSec, arg.resume);
+    mySampler.set_coverage(arg.trackCoverage, arg.coveragePlateau);
+    for (auto& sink : arg.sinks) {
+        mySampler.add_sink(std::move(sink));
+    }
+    if (arg.poolSize > 0) {
+        mySampler.set_diverse_pool(arg.poolSize, arg.poolCheckpointSec);
+    }
+    if (arg.numWorkers > 0) {
+        mySampler.set_partition(arg.partitionMode, arg.numWorkers, arg.workerIdx);
+    }
     mySampler.sampling();
 
     return 0;
@@ -0,0 +1,125 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "sampleformat.h"
+
+namespace sampler {
+
+static void put_raw(std::string& out, const void* p, size_t len) {
+    out.append((const char*)p, len);
+}
+
+static void put_string(std::string& out, const std::string& s) {
+    put_varint(out, s.size());
+    out += s;
+}
+
+static bool get_raw(const uint8_t*& p, const uint8_t* end, void* dst, size_t len) {
+    if ((size_t)(end - p) < len) {
+        return false;
+    }
+    memcpy(dst, p, len);
+    p += len;
+    return true;
+}
+
+static bool get_u64(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    __uint128_t w;
+    if (!get_varint(p, end, w)) {
+        return false;
+    }
+    v = (uint64_t)w;
+    return true;
+}
+
+static bool get_string(const uint8_t*& p, const uint8_t* end, std::string& s) {
+    uint64_t len;
+    if (!get_u64(p, end, len) || (uint64_t)(end - p) < len) {
+        return false;
+    }
+    s.assign((const char*)p, (size_t)len);
+    p += len;
+    return true;
+}
+
+bool SamplerCheckpoint::save(const std::string& path) const {
+    std::string buf(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    buf.push_back((char)CHECKPOINT_VERSION);
+    for (uint64_t v : {num_samples, num_ls_samples, num_cdcl_samples, output_offset}) {
+        put_varint(buf, v);
+    }
+    for (double d : {elapsed, time_first_sample, ls_steps, ls_time, ls_score_lookups, ls_score_hits}) {
+        put_raw(buf, &d, sizeof(d));
+    }
+    put_string(buf, rng_state);
+    put_varint(buf, sample_hashes.size());
+    put_raw(buf, sample_hashes.data(), sample_hashes.size() * sizeof(__int128_t));
+    put_varint(buf, guide_sample.size());
+    for (auto& p : guide_sample) {
+        put_string(buf, p.first);
+        put_string(buf, p.second);
+    }
+
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::out | std::ios::binary);
+        out.write(buf.data(), buf.size());
+        if (!out) {
+            return false;
+        }
+    }
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+bool SamplerCheckpoint::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const uint8_t* p = (const uint8_t*)buf.data();
+    const uint8_t* end = p + buf.size();
+
+    char magic[4];
+    uint8_t version;
+    if (!get_raw(p, end, magic, sizeof(magic)) || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 ||
+        !get_raw(p, end, &version, 1) || version != CHECKPOINT_VERSION) {
+        return false;
+    }
+    for (uint64_t* v : {&num_samples, &num_ls_samples, &num_cdcl_samples, &output_offset}) {
+        if (!get_u64(p, end, *v)) {
+            return false;
+        }
+    }
+    for (double* d : {&elapsed, &time_first_sample, &ls_steps, &ls_time, &ls_score_lookups, &ls_score_hits}) {
+        if (!get_raw(p, end, d, sizeof(double))) {
+            return false;
+        }
+    }
+    if (!get_string(p, end, rng_state)) {
+        return false;
+    }
+    uint64_t n;
+    if (!get_u64(p, end, n) || (uint64_t)(end - p) / sizeof(__int128_t) < n) {
+        return false;
+    }
+    sample_hashes.resize((size_t)n);
+    get_raw(p, end, sample_hashes.data(), n * sizeof(__int128_t));
+    if (!get_u64(p, end, n)) {
+        return false;
+    }
+    guide_sample.clear();
+    for (uint64_t i = 0; i < n; ++i) {
+        std::string name, value;
+        if (!get_string(p, end, name) || !get_string(p, end, value)) {
+            return false;
+        }
+        guide_sample[name] = value;
+    }
+    return p == end;
+}
+
+}  // namespace sampler
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+    Sampling checkpoint ("HDCK"), written next to the samples file.
+
+    magic          : 4 bytes "HDCK"
+    version        : 1 byte
+    counters       : varint num_samples, num_ls_samples, num_cdcl_samples, output_offset
+    times          : 8-byte doubles elapsed, time_first_sample, ls_steps, ls_time, ls_score_lookups, ls_score_hits
+    rng            : varint length, std::mt19937 state as written by operator<<
+    sample hashes  : varint count, count x 16 bytes
+    guide sample   : varint count, count x { varint name_len, name, varint value_len, value }
+
+    Everything past output_offset in the samples file was written after the
+    checkpoint; a resumed run truncates it, so the samples file and the dedup
+    set stay consistent.
+*/
+
+namespace sampler {
+
+const char CHECKPOINT_MAGIC[4] = {'H', 'D', 'C', 'K'};
+const uint8_t CHECKPOINT_VERSION = 1;
+
+struct SamplerCheckpoint {
+    uint64_t num_samples = 0;
+    uint64_t num_ls_samples = 0;
+    uint64_t num_cdcl_samples = 0;
+    uint64_t output_offset = 0;  // bytes of the samples file covered by this checkpoint
+    double elapsed = 0;          // seconds of sampling before the checkpoint
+    double time_first_sample = -1;
+    double ls_steps = 0;
+    double ls_time = 0;
+    double ls_score_lookups = 0;
+    double ls_score_hits = 0;
+    std::string rng_state;
+    std::vector<__int128_t> sample_hashes;
+    std::map<std::string, std::string> guide_sample;  // last LS model, guides the CDCL(T) calls
+
+    /* written to path.tmp and renamed, so a preempted write leaves the previous checkpoint */
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
+
+}  // namespace sampler
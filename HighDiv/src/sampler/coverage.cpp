@@ -0,0 +1,252 @@
+#include "coverage.h"
+
+#include <limits>
+#include <unordered_map>
+#include "sampleformat.h"
+
+namespace sampler {
+
+static __int128_t wrap_add(__int128_t a, __int128_t b) { return (__int128_t)((__uint128_t)a + (__uint128_t)b); }
+static __int128_t wrap_sub(__int128_t a, __int128_t b) { return (__int128_t)((__uint128_t)a - (__uint128_t)b); }
+static __int128_t wrap_mul(__int128_t a, __int128_t b) { return (__int128_t)((__uint128_t)a * (__uint128_t)b); }
+
+// Bool and Int operators of a LIA formula
+static bool is_supported(Z3_decl_kind op) {
+    switch (op) {
+        case Z3_OP_TRUE:
+        case Z3_OP_FALSE:
+        case Z3_OP_ANUM:
+        case Z3_OP_UNINTERPRETED:
+        case Z3_OP_AND:
+        case Z3_OP_OR:
+        case Z3_OP_NOT:
+        case Z3_OP_IMPLIES:
+        case Z3_OP_XOR:
+        case Z3_OP_IFF:
+        case Z3_OP_EQ:
+        case Z3_OP_DISTINCT:
+        case Z3_OP_ITE:
+        case Z3_OP_LE:
+        case Z3_OP_LT:
+        case Z3_OP_GE:
+        case Z3_OP_GT:
+        case Z3_OP_ADD:
+        case Z3_OP_SUB:
+        case Z3_OP_MUL:
+        case Z3_OP_UMINUS:
+        case Z3_OP_IDIV:
+        case Z3_OP_MOD:
+        case Z3_OP_REM:
+        case Z3_OP_ABS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+CoverageTracker::CoverageTracker(const z3::expr& formula) {
+    compile(formula);
+}
+
+void CoverageTracker::compile(const z3::expr& formula) {
+    std::unordered_map<unsigned, unsigned> node_of;  // expr id -> node
+    std::map<std::string, std::vector<unsigned>> var_nodes;
+    std::vector<std::pair<z3::expr, bool>> todo;  // expr, children already pushed
+    todo.push_back({formula, false});
+    while (!todo.empty()) {
+        z3::expr e = todo.back().first;
+        bool expanded = todo.back().second;
+        todo.pop_back();
+        if (node_of.count(e.id())) {
+            continue;
+        }
+        if (!expanded && e.is_app() && e.num_args() > 0) {
+            todo.push_back({e, true});
+            for (unsigned i = e.num_args(); i-- > 0;) {
+                todo.push_back({e.arg(i), false});
+            }
+            continue;
+        }
+        Node n;
+        n.op = e.is_app() ? e.decl().decl_kind() : Z3_OP_UNINTERPRETED;
+        n.is_bool = e.is_bool();
+        n.tracked = e.is_app() && (n.is_bool || e.is_int()) && is_supported(n.op);
+        n.first_arg = args.size();
+        n.num_args = e.is_app() ? e.num_args() : 0;
+        for (unsigned i = 0; i < n.num_args; ++i) {
+            args.push_back(node_of.at(e.arg(i).id()));
+        }
+        if (n.tracked && n.op == Z3_OP_ANUM) {
+            n.value = string_to_int128(Z3_get_numeral_string(e.ctx(), e));
+        } else if (n.tracked && n.op == Z3_OP_UNINTERPRETED) {
+            if (n.num_args == 0) {
+                var_nodes[e.decl().name().str()].push_back(nodes.size());
+            } else {
+                n.tracked = false;  // uninterpreted function
+            }
+        }
+        if (n.tracked) {
+            num_total += n.is_bool ? 1 : 64;
+        } else {
+            num_unsupported++;
+        }
+        node_of[e.id()] = nodes.size();
+        nodes.push_back(n);
+    }
+    for (auto& [name, var_node_idxs] : var_nodes) {
+        for (unsigned node_idx : var_node_idxs) {
+            nodes[node_idx].var = var_names.size();
+        }
+        var_names.push_back(name);
+    }
+    var_values.resize(var_names.size(), 0);
+    values.resize(nodes.size(), 0);
+    seen_one.resize(nodes.size(), 0);
+    seen_zero.resize(nodes.size(), 0);
+}
+
+// both sorted by name
+void CoverageTracker::load_vars(const std::map<std::string, std::string>& sample) {
+    auto it = sample.begin();
+    for (size_t i = 0; i < var_names.size(); ++i) {
+        while (it != sample.end() && it->first < var_names[i]) {
+            ++it;
+        }
+        if (it == sample.end() || it->first != var_names[i]) {
+            var_values[i] = 0;
+        } else if (it->second == "true" || it->second == "false") {
+            var_values[i] = it->second == "true";
+        } else {
+            var_values[i] = string_to_int128(it->second);
+        }
+    }
+}
+
+// SMT-LIB div and mod: the remainder is in [0, |b|), division by 0 is taken as 0
+__int128_t CoverageTracker::eval(const Node& n) const {
+    auto arg = [&](unsigned i) { return values[args[n.first_arg + i]]; };
+    __int128_t r;
+    switch (n.op) {
+        case Z3_OP_TRUE:
+            return 1;
+        case Z3_OP_FALSE:
+            return 0;
+        case Z3_OP_ANUM:
+            return n.value;
+        case Z3_OP_UNINTERPRETED:
+            return n.var >= 0 ? var_values[n.var] : 0;
+        case Z3_OP_AND:
+            for (unsigned i = 0; i < n.num_args; ++i) {
+                if (!arg(i))
+                    return 0;
+            }
+            return 1;
+        case Z3_OP_OR:
+            for (unsigned i = 0; i < n.num_args; ++i) {
+                if (arg(i))
+                    return 1;
+            }
+            return 0;
+        case Z3_OP_NOT:
+            return !arg(0);
+        case Z3_OP_IMPLIES:
+            return !arg(0) || arg(1);
+        case Z3_OP_XOR:
+            r = 0;
+            for (unsigned i = 0; i < n.num_args; ++i) {
+                r ^= arg(i) != 0;
+            }
+            return r;
+        case Z3_OP_IFF:
+        case Z3_OP_EQ:
+            for (unsigned i = 1; i < n.num_args; ++i) {
+                if (arg(i) != arg(0))
+                    return 0;
+            }
+            return 1;
+        case Z3_OP_DISTINCT:
+            for (unsigned i = 0; i < n.num_args; ++i) {
+                for (unsigned j = i + 1; j < n.num_args; ++j) {
+                    if (arg(i) == arg(j))
+                        return 0;
+                }
+            }
+            return 1;
+        case Z3_OP_ITE:
+            return arg(0) ? arg(1) : arg(2);
+        case Z3_OP_LE:
+            return arg(0) <= arg(1);
+        case Z3_OP_LT:
+            return arg(0) < arg(1);
+        case Z3_OP_GE:
+            return arg(0) >= arg(1);
+        case Z3_OP_GT:
+            return arg(0) > arg(1);
+        case Z3_OP_ADD:
+            r = 0;
+            for (unsigned i = 0; i < n.num_args; ++i) {
+                r = wrap_add(r, arg(i));
+            }
+            return r;
+        case Z3_OP_SUB:
+            r = arg(0);
+            for (unsigned i = 1; i < n.num_args; ++i) {
+                r = wrap_sub(r, arg(i));
+            }
+            return r;
+        case Z3_OP_MUL:
+            r = 1;
+            for (unsigned i = 0; i < n.num_args; ++i) {
+                r = wrap_mul(r, arg(i));
+            }
+            return r;
+        case Z3_OP_UMINUS:
+            return wrap_sub(0, arg(0));
+        case Z3_OP_ABS:
+            return arg(0) < 0 ? wrap_sub(0, arg(0)) : arg(0);
+        case Z3_OP_IDIV:
+        case Z3_OP_MOD:
+        case Z3_OP_REM: {
+            __int128_t a = arg(0), b = arg(1);
+            if (b == 0 || (b == -1 && a == std::numeric_limits<__int128_t>::min()))
+                return 0;
+            __int128_t q = a / b, m = a % b;
+            if (m < 0) {
+                m += b > 0 ? b : -b;
+                q += b > 0 ? -1 : 1;
+            }
+            if (n.op == Z3_OP_IDIV)
+                return q;
+            return n.op == Z3_OP_REM && b < 0 ? -m : m;
+        }
+        default:
+            return 0;
+    }
+}
+
+size_t CoverageTracker::add(const std::map<std::string, std::string>& sample) {
+    load_vars(sample);
+    size_t before = num_covered;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const Node& n = nodes[i];
+        if (!n.tracked) {
+            values[i] = 0;
+            continue;
+        }
+        values[i] = eval(n);
+        uint64_t mask = n.is_bool ? 1 : ~(uint64_t)0;
+        uint64_t bits = n.is_bool ? (uint64_t)(values[i] != 0) : (uint64_t)values[i];
+        uint64_t old_covered = seen_one[i] & seen_zero[i];
+        seen_one[i] |= bits;
+        seen_zero[i] |= ~bits & mask;
+        num_covered += __builtin_popcountll(seen_one[i] & seen_zero[i]) - __builtin_popcountll(old_covered);
+    }
+    return num_covered - before;
+}
+
+void CoverageTracker::print_statistic(std::ostream& os) const {
+    os << "Wire coverage: " << coverage() << "% (" << num_covered << " of " << num_total << " bits over " << nodes.size() - num_unsupported
+       << " nodes, " << num_unsupported << " nodes not evaluated)\n";
+}
+
+}  // namespace sampler
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <z3++.h>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+    Online wire coverage of the samples, the metric of calc_metric.py.
+
+    Every node of the formula DAG is a wire: a Bool node is covered once it
+    has been seen both true and false, an Int node contributes the 64 low bits
+    of its value, each covered once it has been seen both 0 and 1.  The formula
+    is compiled once into a node array in post order (children first), so a
+    sample is evaluated by one pass over the array, with the variables read
+    from the sample and missing ones taken as 0 / false.
+
+    Nodes of an operator the evaluator does not know (uninterpreted functions,
+    arrays, reals, ...) are left out of the total; their parents see them as 0.
+*/
+
+namespace sampler {
+
+struct CoveragePoint {
+    size_t num_samples;
+    double time;
+    double coverage;  // percentage
+};
+
+class CoverageTracker {
+    struct Node {
+        Z3_decl_kind op;
+        bool is_bool;
+        bool tracked;  // false for the operators the evaluator does not know
+        unsigned first_arg;
+        unsigned num_args;
+        int var = -1;          // leaf constant
+        __int128_t value = 0;  // numeral
+    };
+
+    std::vector<Node> nodes;  // post order
+    std::vector<unsigned> args;
+    std::vector<std::string> var_names;  // sorted
+    std::vector<__int128_t> var_values;
+    std::vector<__int128_t> values;  // per node, for the current sample
+    std::vector<uint64_t> seen_one;  // Bool nodes use bit 0
+    std::vector<uint64_t> seen_zero;
+    size_t num_covered = 0;
+    size_t num_total = 0;
+    size_t num_unsupported = 0;
+
+    void compile(const z3::expr& formula);
+    void load_vars(const std::map<std::string, std::string>& sample);
+    __int128_t eval(const Node& n) const;
+
+   public:
+    CoverageTracker(const z3::expr& formula);
+
+    /* evaluates the formula on the sample, returns how many wire bits it covered first */
+    size_t add(const std::map<std::string, std::string>& sample);
+
+    double coverage() const { return num_total > 0 ? 100.0 * num_covered / num_total : 0.0; }
+    void print_statistic(std::ostream& os) const;
+};
+
+}  // namespace sampler
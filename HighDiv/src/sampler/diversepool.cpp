@@ -0,0 +1,151 @@
+#include "diversepool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+namespace sampler {
+
+DiversePool::DiversePool(size_t _capacity, const std::vector<std::string>& columns)
+    : capacity(std::max(_capacity, (size_t)1)) {
+    for (const std::string& name : columns) {
+        name2col.emplace(name, name2col.size());
+    }
+    entries.reserve(capacity);
+    dist_buf.resize(capacity);
+}
+
+double DiversePool::distance(const std::vector<__int128_t>& a, const std::vector<__int128_t>& b) const {
+    double d = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] != b[i]) {
+            __uint128_t diff = a[i] > b[i] ? (__uint128_t)a[i] - (__uint128_t)b[i] : (__uint128_t)b[i] - (__uint128_t)a[i];
+            d += std::log2(1.0 + (double)diff);
+        }
+    }
+    return d;
+}
+
+void DiversePool::recompute_nn(size_t i) {
+    PoolEntry& e = entries[i];
+    e.nn_dist = std::numeric_limits<double>::infinity();
+    e.nn = i;
+    for (size_t j = 0; j < entries.size(); ++j) {
+        if (j == i) {
+            continue;
+        }
+        double d = distance(e.point, entries[j].point);
+        if (d < e.nn_dist) {
+            e.nn_dist = d;
+            e.nn = j;
+        }
+    }
+}
+
+bool DiversePool::offer(const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) {
+    num_offered++;
+    std::vector<__int128_t> point(name2col.size(), 0);
+    size_t val_idx = 0;
+    for (auto& p : sample) {
+        auto it = name2col.find(p.first);
+        if (it != name2col.end()) {
+            point[it->second] = values[val_idx];
+        }
+        val_idx++;
+    }
+
+    size_t n = entries.size();
+    double new_nn_dist = std::numeric_limits<double>::infinity();
+    size_t new_nn = n;
+    for (size_t j = 0; j < n; ++j) {
+        dist_buf[j] = distance(point, entries[j].point);
+    }
+
+    if (n < capacity) {
+        for (size_t j = 0; j < n; ++j) {
+            if (dist_buf[j] < entries[j].nn_dist) {
+                entries[j].nn_dist = dist_buf[j];
+                entries[j].nn = n;
+            }
+            if (dist_buf[j] < new_nn_dist) {
+                new_nn_dist = dist_buf[j];
+                new_nn = j;
+            }
+        }
+        entries.push_back({sample, std::move(point), new_nn_dist, new_nn});
+        return true;
+    }
+
+    // the victim is one end of the closest pair
+    size_t victim = 0;
+    for (size_t j = 1; j < n; ++j) {
+        if (entries[j].nn_dist < entries[victim].nn_dist) {
+            victim = j;
+        }
+    }
+    for (size_t j = 0; j < n; ++j) {
+        if (j != victim && dist_buf[j] < new_nn_dist) {
+            new_nn_dist = dist_buf[j];
+            new_nn = j;
+        }
+    }
+    if (new_nn_dist <= entries[victim].nn_dist) {
+        return false;
+    }
+
+    num_replaced++;
+    entries[victim] = {sample, std::move(point), new_nn_dist, new_nn};
+    for (size_t j = 0; j < n; ++j) {
+        if (j == victim) {
+            continue;
+        }
+        if (entries[j].nn == victim) {
+            recompute_nn(j);
+        } else if (dist_buf[j] < entries[j].nn_dist) {
+            entries[j].nn_dist = dist_buf[j];
+            entries[j].nn = victim;
+        }
+    }
+    return true;
+}
+
+double DiversePool::min_distance() const {
+    if (entries.size() < 2) {
+        return 0;
+    }
+    double d = std::numeric_limits<double>::infinity();
+    for (const PoolEntry& e : entries) {
+        d = std::min(d, e.nn_dist);
+    }
+    return d;
+}
+
+bool DiversePool::write(const std::string& path) const {
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path);
+        if (!out) {
+            return false;
+        }
+        for (size_t i = 0; i < entries.size(); ++i) {
+            out << i << ": ";
+            for (auto& p : entries[i].sample) {
+                out << p.first << ":" << p.second << ";";
+            }
+            out << "\n";
+        }
+        if (!out) {
+            return false;
+        }
+    }
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+void DiversePool::print_statistic(std::ostream& os) const {
+    os << "Diverse pool: " << entries.size() << " of " << capacity << " samples, min pairwise distance "
+       << min_distance() << ", " << num_replaced << " replacements in " << num_offered << " offers\n";
+}
+
+}  // namespace sampler
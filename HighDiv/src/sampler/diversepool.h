@@ -0,0 +1,56 @@
+#pragma once
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+    Bounded pool of the K most mutually distant samples seen so far.
+
+    Samples are points over the Int/Bool columns of the formula (missing
+    values count as 0).  The distance between two points is the sum over the
+    columns of log2(1 + |a - b|), i.e. the number of value bits that differ in
+    magnitude, so a single huge-range variable does not drown the rest.
+
+    The pool keeps, for every member, its nearest other member (the distance
+    index).  Once the pool is full, a new sample replaces one end of the
+    closest pair whenever that raises the pool's minimum pairwise distance
+    (streaming k-center by swaps).  An offer costs K distance evaluations, plus
+    K more for each member whose nearest neighbour was evicted.
+*/
+
+namespace sampler {
+
+class DiversePool {
+    struct PoolEntry {
+        std::map<std::string, std::string> sample;
+        std::vector<__int128_t> point;
+        double nn_dist;  // distance to the nearest other member
+        size_t nn;
+    };
+
+    size_t capacity;
+    std::map<std::string, size_t> name2col;
+    std::vector<PoolEntry> entries;
+    std::vector<double> dist_buf;
+    size_t num_offered = 0;
+    size_t num_replaced = 0;
+
+    double distance(const std::vector<__int128_t>& a, const std::vector<__int128_t>& b) const;
+    void recompute_nn(size_t i);
+
+   public:
+    DiversePool(size_t _capacity, const std::vector<std::string>& columns);
+
+    /* values are those of sample, in the same (name) order; true if the sample entered the pool */
+    bool offer(const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values);
+    /* minimum pairwise distance inside the pool, 0 with fewer than two members */
+    double min_distance() const;
+    /* rewrites path with the pool in the text samples format, atomically */
+    bool write(const std::string& path) const;
+
+    void print_statistic(std::ostream& os) const;
+};
+
+}  // namespace sampler
@@ -0,0 +1,149 @@
+#include "enumerator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_set>
+
+namespace sampler {
+
+ProjectionEnumerator::ProjectionEnumerator(z3::context& _c, z3::solver& _solver, const z3::expr& formula, std::mt19937& _mt, size_t _gcInterval)
+    : c(_c), solver(_solver), mt(_mt), gc_interval(std::max(_gcInterval, (size_t)1)) {
+    collect(formula);
+}
+
+static bool is_arith_atom(const z3::expr& e) {
+    switch (e.decl().decl_kind()) {
+        case Z3_OP_LE:
+        case Z3_OP_GE:
+        case Z3_OP_LT:
+        case Z3_OP_GT:
+            return true;
+        case Z3_OP_EQ:
+        case Z3_OP_DISTINCT:
+            return e.num_args() > 0 && e.arg(0).is_arith();
+        default:
+            return false;
+    }
+}
+
+// Bool constants and arithmetic comparisons, Int constants
+void ProjectionEnumerator::collect(const z3::expr& formula) {
+    std::unordered_set<unsigned> visited;
+    std::vector<z3::expr> todo;
+    todo.push_back(formula);
+    while (!todo.empty()) {
+        z3::expr e = todo.back();
+        todo.pop_back();
+        if (!visited.insert(e.id()).second || !e.is_app()) {
+            continue;
+        }
+        if (e.is_const()) {
+            if (e.decl().decl_kind() != Z3_OP_UNINTERPRETED) {
+                continue;
+            }
+            if (e.is_bool()) {
+                atoms.push_back(e);
+            } else if (e.is_int()) {
+                int_vars.push_back(e);
+            }
+            continue;
+        }
+        if (e.is_bool() && is_arith_atom(e)) {
+            atoms.push_back(e);
+        }
+        for (unsigned i = 0; i < e.num_args(); ++i) {
+            todo.push_back(e.arg(i));
+        }
+    }
+}
+
+void ProjectionEnumerator::draw_projection() {
+    proj_atoms.clear();
+    proj_slices.clear();
+    bool use_slices = atoms.empty() || (!int_vars.empty() && mt() % 2 == 0);
+    if (use_slices) {
+        std::vector<z3::expr> vars = int_vars;
+        std::shuffle(vars.begin(), vars.end(), mt);
+        size_t n = 1 + mt() % std::min(vars.size(), (size_t)max_proj_slices);
+        for (size_t i = 0; i < n; ++i) {
+            proj_slices.push_back({vars[i], (unsigned)(mt() % (max_slice_shift + 1))});
+        }
+    } else {
+        std::vector<z3::expr> pool = atoms;
+        std::shuffle(pool.begin(), pool.end(), mt);
+        size_t n = 1 + mt() % std::min(pool.size(), (size_t)max_proj_atoms);
+        proj_atoms.assign(pool.begin(), pool.begin() + n);
+    }
+}
+
+void ProjectionEnumerator::new_scope() {
+    if (in_scope) {
+        solver.pop();
+        num_gcs++;
+    }
+    solver.push();
+    in_scope = true;
+    scope_blocks = 0;
+    draw_projection();
+}
+
+// false when the model cannot be blocked on the projection (no atom evaluates, slices out of 64 bits)
+bool ProjectionEnumerator::block(const z3::model& m) {
+    z3::expr_vector lits(c);
+    for (const z3::expr& a : proj_atoms) {
+        z3::expr v = m.eval(a, true);
+        if (v.is_true()) {
+            lits.push_back(!a);
+        } else if (v.is_false()) {
+            lits.push_back(a);
+        }
+    }
+    for (auto& [x, shift] : proj_slices) {
+        int64_t v;
+        if (!m.eval(x, true).is_numeral_i64(v)) {
+            continue;
+        }
+        __int128_t width = (__int128_t)1 << shift;
+        __int128_t lo = v >= 0 ? v / width * width : -((-((__int128_t)v + 1)) / width + 1) * width;  // floor to a multiple of width
+        if (lo < INT64_MIN || lo + width > INT64_MAX) {
+            continue;
+        }
+        lits.push_back(x < c.int_val((int64_t)lo) || x >= c.int_val((int64_t)(lo + width)));
+    }
+    if (lits.empty()) {
+        return false;
+    }
+    solver.add(z3::mk_or(lits));
+    scope_blocks++;
+    num_blocks++;
+    return true;
+}
+
+z3::check_result ProjectionEnumerator::next(z3::model& m) {
+    if (!in_scope || scope_blocks >= gc_interval) {
+        new_scope();
+    }
+    while (true) {
+        z3::check_result res = solver.check();
+        if (res == z3::sat) {
+            m = solver.get_model();
+            if (!block(m)) {
+                new_scope();  // blocks nothing, another projection next time
+            }
+            return res;
+        }
+        if (res == z3::unsat && scope_blocks > 0) {
+            num_exhausted++;  // every model of this projection has been seen
+            new_scope();
+            continue;
+        }
+        return res;
+    }
+}
+
+void ProjectionEnumerator::print_statistic(std::ostream& os) const {
+    os << "Projected enumeration: " << num_blocks << " blocking clauses, " << num_gcs << " collections, " << num_exhausted
+       << " exhausted projections (" << atoms.size() << " skeleton atoms, " << int_vars.size() << " Int variables)\n";
+}
+
+}  // namespace sampler
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <z3++.h>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+    Projected model enumeration for the CDCL(T) sampler.
+
+    After each model a blocking clause over a projection is added inside a
+    push scope of the solver, so the next check must differ from every model
+    of the scope on that projection and cannot return a duplicate sample.  A
+    projection is either a random subset of the Boolean skeleton atoms (Bool
+    constants and arithmetic comparisons of the formula), or bit-slices of a
+    random subset of Int constants: the model value with its low s bits
+    dropped, blocked as x < lo \/ x >= lo + 2^s.
+
+    Every gc_interval blocking clauses, and whenever the projection is
+    exhausted (unsat inside the scope), the scope is popped, which drops the
+    blocking clauses and keeps the solver's learned state for the formula,
+    and a new projection is drawn.  The solver therefore never carries more
+    than gc_interval extra clauses and the cost of a check stays flat.
+*/
+
+namespace sampler {
+
+class ProjectionEnumerator {
+    z3::context& c;
+    z3::solver& solver;
+    std::mt19937& mt;
+    size_t gc_interval;
+    std::vector<z3::expr> atoms;    // Boolean skeleton
+    std::vector<z3::expr> int_vars;
+    std::vector<z3::expr> proj_atoms;  // current projection
+    std::vector<std::pair<z3::expr, unsigned>> proj_slices;  // Int constant, dropped low bits
+    size_t scope_blocks = 0;
+    bool in_scope = false;
+
+    size_t num_blocks = 0;
+    size_t num_gcs = 0;
+    size_t num_exhausted = 0;
+
+    static const unsigned max_proj_atoms = 64;
+    static const unsigned max_proj_slices = 8;
+    static const unsigned max_slice_shift = 8;
+
+    void collect(const z3::expr& formula);
+    void draw_projection();
+    void new_scope();
+    bool block(const z3::model& m);
+
+   public:
+    ProjectionEnumerator(z3::context& _c, z3::solver& _solver, const z3::expr& formula, std::mt19937& _mt, size_t _gcInterval);
+
+    /* a model unseen on the current projection; unsat once the whole formula is exhausted */
+    z3::check_result next(z3::model& m);
+
+    void print_statistic(std::ostream& os) const;
+};
+
+}  // namespace sampler
@@ -0,0 +1,261 @@
+#include "formulafeatures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace sampler {
+
+static bool is_int_var(const z3::expr& e) {
+    return e.is_const() && e.decl().decl_kind() == Z3_OP_UNINTERPRETED && e.is_int();
+}
+
+static bool is_arith_atom(const z3::expr& e) {
+    switch (e.decl().decl_kind()) {
+        case Z3_OP_LE:
+        case Z3_OP_GE:
+        case Z3_OP_LT:
+        case Z3_OP_GT:
+            return true;
+        case Z3_OP_EQ:
+            return e.arg(0).is_arith();
+        default:
+            return false;
+    }
+}
+
+// value of a numeral, also written (- k) as the SMT-LIB parser keeps it
+static bool numeral_value(const z3::expr& e, double& v) {
+    if (e.is_numeral()) {
+        v = e.as_double();
+        return true;
+    }
+    if (e.is_app() && e.decl().decl_kind() == Z3_OP_UMINUS && numeral_value(e.arg(0), v)) {
+        v = -v;
+        return true;
+    }
+    return false;
+}
+
+// lhs - rhs as sum(coefs[x] * x) + constant, false on a non-linear or non-arithmetic term
+static bool linearize(const z3::expr& lhs, const z3::expr& rhs, std::map<std::string, double>& coefs, double& constant) {
+    std::vector<std::pair<z3::expr, double>> todo;
+    todo.push_back({lhs, 1.0});
+    todo.push_back({rhs, -1.0});
+    constant = 0;
+    while (!todo.empty()) {
+        auto [t, scale] = todo.back();
+        todo.pop_back();
+        double v;
+        if (numeral_value(t, v)) {
+            constant += scale * v;
+            continue;
+        }
+        if (is_int_var(t)) {
+            coefs[t.decl().name().str()] += scale;
+            continue;
+        }
+        if (!t.is_app()) {
+            return false;
+        }
+        switch (t.decl().decl_kind()) {
+            case Z3_OP_ADD:
+                for (unsigned i = 0; i < t.num_args(); ++i) {
+                    todo.push_back({t.arg(i), scale});
+                }
+                break;
+            case Z3_OP_SUB:
+                todo.push_back({t.arg(0), scale});
+                for (unsigned i = 1; i < t.num_args(); ++i) {
+                    todo.push_back({t.arg(i), -scale});
+                }
+                break;
+            case Z3_OP_UMINUS:
+                todo.push_back({t.arg(0), -scale});
+                break;
+            case Z3_OP_TO_REAL:
+            case Z3_OP_TO_INT:
+                todo.push_back({t.arg(0), scale});
+                break;
+            case Z3_OP_MUL: {
+                double k = scale;
+                int term = -1;
+                for (unsigned i = 0; i < t.num_args(); ++i) {
+                    if (numeral_value(t.arg(i), v)) {
+                        k *= v;
+                    } else if (term == -1) {
+                        term = i;
+                    } else {
+                        return false;
+                    }
+                }
+                if (term == -1) {
+                    constant += k;
+                } else {
+                    todo.push_back({t.arg(term), k});
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    for (auto it = coefs.begin(); it != coefs.end();) {
+        it = it->second == 0 ? coefs.erase(it) : std::next(it);
+    }
+    return true;
+}
+
+// tightens [lo, hi] of x from a top-level atom c * x + k op 0 with c = +-1
+static void update_bounds(Z3_decl_kind op, double c, double k, double& lo, double& hi) {
+    // c * x op -k, integer strict bounds are shifted by one
+    double rhs = -k;
+    bool upper = op == Z3_OP_LE || op == Z3_OP_LT || op == Z3_OP_EQ;
+    bool lower = op == Z3_OP_GE || op == Z3_OP_GT || op == Z3_OP_EQ;
+    if (op == Z3_OP_LT) {
+        rhs -= 1;
+    } else if (op == Z3_OP_GT) {
+        rhs += 1;
+    }
+    if (c < 0) {  // -x op rhs: x op' -rhs
+        rhs = -rhs;
+        std::swap(upper, lower);
+    }
+    if (upper) {
+        hi = std::min(hi, rhs);
+    }
+    if (lower) {
+        lo = std::max(lo, rhs);
+    }
+}
+
+FormulaFeatures extract_features(const z3::expr& formula) {
+    FormulaFeatures f;
+    std::unordered_map<unsigned, unsigned> height;  // node id -> height, the visited set
+    std::map<std::string, size_t> int_occs;         // Int variable -> atoms it occurs in
+    std::map<std::string, std::pair<double, double>> bounds;
+    size_t idl_atoms = 0, eq_atoms = 0, num_coeffs = 0;
+    double coeff_log2_sum = 0;
+
+    // top-level conjuncts, the unit bounds among them decide the pseudo-Boolean variables
+    std::vector<z3::expr> conjuncts, todo_and;
+    todo_and.push_back(formula);
+    while (!todo_and.empty()) {
+        z3::expr e = todo_and.back();
+        todo_and.pop_back();
+        if (e.is_app() && e.decl().decl_kind() == Z3_OP_AND) {
+            for (unsigned i = 0; i < e.num_args(); ++i) {
+                todo_and.push_back(e.arg(i));
+            }
+        } else {
+            conjuncts.push_back(e);
+        }
+    }
+    f.num_clauses = conjuncts.size();
+    const double inf = std::numeric_limits<double>::infinity();
+    for (const z3::expr& e : conjuncts) {
+        std::map<std::string, double> coefs;
+        double k;
+        if (!e.is_app() || !is_arith_atom(e) || !linearize(e.arg(0), e.arg(1), coefs, k) || coefs.size() != 1 ||
+            std::abs(coefs.begin()->second) != 1) {
+            continue;
+        }
+        auto it = bounds.emplace(coefs.begin()->first, std::make_pair(-inf, inf)).first;
+        update_bounds(e.decl().decl_kind(), coefs.begin()->second, k, it->second.first, it->second.second);
+    }
+
+    // post-order over the DAG: a node is expanded on its first visit and gets its height once its arguments have theirs
+    std::vector<std::pair<z3::expr, bool>> todo;
+    todo.push_back({formula, false});
+    while (!todo.empty()) {
+        auto [e, expanded] = todo.back();
+        if (expanded) {
+            todo.pop_back();
+            unsigned h = 0;
+            for (unsigned i = 0; i < e.num_args(); ++i) {
+                h = std::max(h, height[e.arg(i).id()] + 1);
+            }
+            height[e.id()] = h;
+            continue;
+        }
+        if (height.count(e.id())) {
+            todo.pop_back();
+            continue;
+        }
+        f.num_nodes++;
+        if (!e.is_app() || e.is_const()) {
+            todo.pop_back();
+            height[e.id()] = 0;
+            if (e.is_const() && e.decl().decl_kind() == Z3_OP_UNINTERPRETED) {
+                Z3_sort_kind k = e.get_sort().sort_kind();
+                (k == Z3_INT_SORT ? f.num_ints : k == Z3_BOOL_SORT ? f.num_bools : f.num_others)++;
+            }
+            continue;
+        }
+        todo.back().second = true;
+        if (e.decl().decl_kind() == Z3_OP_UNINTERPRETED) {
+            f.num_others++;
+        } else if (is_arith_atom(e)) {
+            f.num_atoms++;
+            eq_atoms += e.decl().decl_kind() == Z3_OP_EQ;
+            std::map<std::string, double> coefs;
+            double k;
+            if (linearize(e.arg(0), e.arg(1), coefs, k)) {
+                bool unit = coefs.size() == 1 && std::abs(coefs.begin()->second) == 1;
+                bool diff = coefs.size() == 2 && coefs.begin()->second == -std::next(coefs.begin())->second &&
+                            std::abs(coefs.begin()->second) == 1;
+                idl_atoms += unit || diff;
+                for (auto& [name, c] : coefs) {
+                    int_occs[name]++;
+                    double l = std::log2(std::max(1.0, std::abs(c)));
+                    f.max_coeff_log2 = std::max(f.max_coeff_log2, l);
+                    coeff_log2_sum += l;
+                    num_coeffs++;
+                }
+            }
+        }
+        for (unsigned i = 0; i < e.num_args(); ++i) {
+            todo.push_back({e.arg(i), false});
+        }
+    }
+    f.depth = height[formula.id()];
+
+    size_t pb_vars = 0;
+    for (auto& [name, b] : bounds) {
+        pb_vars += b.first >= 0 && b.second <= 1;
+    }
+    f.pb_fraction = f.num_ints > 0 ? (double)pb_vars / f.num_ints : 0.0;
+    f.idl_fraction = f.num_atoms > 0 ? (double)idl_atoms / f.num_atoms : 0.0;
+    f.eq_fraction = f.num_atoms > 0 ? (double)eq_atoms / f.num_atoms : 0.0;
+    f.mean_coeff_log2 = num_coeffs > 0 ? coeff_log2_sum / num_coeffs : 0.0;
+    size_t max_occs = 0, sum_occs = 0;
+    for (auto& [name, n] : int_occs) {
+        max_occs = std::max(max_occs, n);
+        sum_occs += n;
+    }
+    f.occurrence_skew = sum_occs > 0 ? (double)max_occs * int_occs.size() / sum_occs : 0.0;
+    return f;
+}
+
+std::string FormulaFeatures::class_name() const {
+    std::string kind = pb_fraction >= 0.9 ? "pb" : idl_fraction >= 0.9 ? "idl" : eq_fraction >= 0.5 ? "eq" : "lia";
+    size_t num_vars = num_ints + num_bools;
+    std::string size = num_vars < 64 ? "s" : num_vars < 1024 ? "m" : "l";
+    std::string coeffs = max_coeff_log2 <= 4 ? "small" : "big";  // |c| <= 16
+    std::string skew = occurrence_skew > 4 ? "skewed" : "flat";
+    return kind + "-" + size + "-" + coeffs + "-" + skew;
+}
+
+void FormulaFeatures::print(std::ostream& os) const {
+    os << "Formula features: " << num_nodes << " nodes, depth " << depth << ", " << num_ints << " Int / " << num_bools
+       << " Bool / " << num_others << " other symbols, " << num_clauses << " conjuncts, " << num_atoms << " atoms\n";
+    os << "Formula shape: PB " << pb_fraction << ", IDL " << idl_fraction << ", equalities " << eq_fraction
+       << ", log2 coefficient max / mean " << max_coeff_log2 << " / " << mean_coeff_log2 << ", occurrence skew "
+       << occurrence_skew << "\n";
+    os << "Formula class: " << class_name() << "\n";
+}
+
+}  // namespace sampler
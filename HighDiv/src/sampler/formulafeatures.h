@@ -0,0 +1,45 @@
+#pragma once
+
+#include <z3++.h>
+#include <iostream>
+#include <string>
+
+/*
+    Formula-level features, the input of the automatic mode selection.
+
+    One pass over the formula DAG with an explicit stack, so deep formulas do
+    not overflow the call stack.  Every arithmetic comparison is linearized to
+    sum(c_i * x_i) op k; its shape gives the pseudo-Boolean, difference logic
+    and equality fractions, its numerals the coefficient magnitudes and its
+    variables the occurrence counts.  Comparisons over non-linear or ite terms
+    count as atoms but not as difference logic.
+
+    class_name() buckets the features into the formula classes of the mode
+    table, see modeselect.h.
+*/
+
+namespace sampler {
+
+struct FormulaFeatures {
+    size_t num_nodes = 0;        // distinct AST nodes
+    unsigned depth = 0;          // longest path from the root to a leaf
+    size_t num_ints = 0;         // uninterpreted constants by sort
+    size_t num_bools = 0;
+    size_t num_others = 0;       // constants of other sorts and uninterpreted functions
+    size_t num_clauses = 0;      // top-level conjuncts
+    size_t num_atoms = 0;        // arithmetic comparisons
+    double pb_fraction = 0;      // Int variables bounded to [0, 1] by top-level conjuncts
+    double idl_fraction = 0;     // atoms x - y op k or x op k
+    double eq_fraction = 0;      // atoms that are equalities
+    double max_coeff_log2 = 0;   // log2 of the largest absolute coefficient
+    double mean_coeff_log2 = 0;  // mean log2 of the absolute coefficients
+    double occurrence_skew = 0;  // atoms of the most frequent Int variable over the mean per Int variable
+
+    /* kind-size-coefficients-skew, e.g. idl-m-small-flat */
+    std::string class_name() const;
+    void print(std::ostream& os) const;
+};
+
+FormulaFeatures extract_features(const z3::expr& formula);
+
+}  // namespace sampler
@@ -0,0 +1,107 @@
+#include "hashcell.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_set>
+
+namespace sampler {
+
+// Int constants of the expressions with the number of their occurrences as a direct argument
+static void count_int_consts(const std::vector<z3::expr>& roots, std::map<std::string, std::pair<unsigned, z3::expr>>& occs) {
+    std::unordered_set<unsigned> visited;
+    std::vector<z3::expr> todo(roots.begin(), roots.end());
+    while (!todo.empty()) {
+        z3::expr e = todo.back();
+        todo.pop_back();
+        if (!visited.insert(e.id()).second || !e.is_app())
+            continue;
+        if (e.is_const()) {
+            if (e.decl().decl_kind() == Z3_OP_UNINTERPRETED && e.is_int()) {
+                occs.emplace(e.decl().name().str(), std::make_pair(0U, e));  // a root by itself
+            }
+            continue;
+        }
+        for (unsigned i = 0; i < e.num_args(); ++i) {
+            z3::expr a = e.arg(i);
+            if (a.is_const() && a.decl().decl_kind() == Z3_OP_UNINTERPRETED && a.is_int()) {
+                auto it = occs.emplace(a.decl().name().str(), std::make_pair(0U, a)).first;
+                it->second.first++;
+            } else {
+                todo.push_back(a);
+            }
+        }
+    }
+}
+
+HashCellGenerator::HashCellGenerator(z3::context& _c, const z3::goal& ls_goal, const z3::expr& formula, size_t _batch)
+    : c(_c), batch(std::max(_batch, (size_t)1)) {
+    std::vector<z3::expr> goal_roots;
+    for (unsigned i = 0; i < ls_goal.size(); ++i) {
+        goal_roots.push_back(ls_goal[i]);
+    }
+    std::map<std::string, std::pair<unsigned, z3::expr>> goal_occs, formula_occs;
+    count_int_consts(goal_roots, goal_occs);
+    count_int_consts({formula}, formula_occs);
+
+    // the preamble may introduce constants of its own, only the formula's are hashed
+    std::vector<std::pair<unsigned, std::string>> order;
+    for (auto& [name, occ] : goal_occs) {
+        if (formula_occs.count(name)) {
+            order.push_back({occ.first, name});
+        }
+    }
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    order.resize(std::min(order.size(), max_vars));
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+    for (auto& o : order) {
+        vars.push_back(goal_occs.at(o.second).second);
+    }
+}
+
+z3::expr HashCellGenerator::draw_cell(std::mt19937& mt) {
+    std::uniform_int_distribution<unsigned> dist(0, prime - 1);
+    num_cells++;
+    z3::expr cell = c.bool_val(true);
+    for (unsigned j = 0; j < num_hashes; ++j) {
+        z3::expr_vector terms(c);
+        for (const z3::expr& x : vars) {
+            unsigned a = dist(mt);
+            if (a != 0) {
+                terms.push_back(a == 1 ? x : c.int_val(a) * x);
+            }
+        }
+        std::string q_name = quotient_prefix + std::to_string(num_quotients++);
+        z3::expr q = c.int_const(q_name.c_str());
+        terms.push_back(c.int_val(-(int)prime) * q);
+        cell = cell && z3::sum(terms) == c.int_val(dist(mt));
+    }
+    return cell;
+}
+
+void HashCellGenerator::update(size_t found, bool exhausted) {
+    num_solutions += found;
+    if (found == 0) {
+        empty_cells++;
+    }
+    if (!exhausted) {
+        large_cells++;
+        num_hashes++;
+        max_hashes = std::max(max_hashes, num_hashes);
+    } else if (found * prime < batch) {
+        small_cells++;
+        if (num_hashes > 0) {
+            num_hashes--;
+        }
+    }
+}
+
+void HashCellGenerator::print_statistic(std::ostream& os) const {
+    os << "Hash cells: " << num_cells << " over " << vars.size() << " Int variables mod " << prime << " ("
+       << empty_cells << " empty, " << small_cells << " small, " << large_cells << " large), hashes now / max: "
+       << num_hashes << " / " << max_hashes << "\n";
+    os << "Solutions per hash cell: " << (num_cells > 0 ? (double)num_solutions / num_cells : 0.0) << "\n";
+}
+
+}  // namespace sampler
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <z3++.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Random cells of the solution space for near-uniform sampling.
+
+    A cell is the set of solutions of m random linear-modular hashes
+        a_j1 * x_1 + ... + a_jn * x_n == r_j  (mod p)
+    over the hashed Int variables, with a_ji and r_j uniform in [0, p).  The
+    hash is encoded in LIA with a fresh quotient variable per constraint,
+        a_j1 * x_1 + ... + a_jn * x_n - p * q_j == r_j,
+    so the same cell constraint goes to CDCL(T) and to LS.  The family is
+    pairwise independent, so every solution falls in a cell of the drawn
+    size with the same probability, and the solutions of a small random cell
+    are close to a uniform sample of the whole space.
+
+    m is tuned from the solution counts the sampler observes: a cell that
+    still has solutions after a full batch is too large (m grows), a cell
+    exhausted with fewer than batch / p solutions is too small (m shrinks).
+    Every cell then holds about one batch, and the cost of enumerating it,
+    so the cost per unique sample, no longer depends on the size of the space.
+
+    The hashed variables are the Int constants left in the LS goal, which the
+    preamble has not eliminated, so the cell constrains both engines alike.
+*/
+
+namespace sampler {
+
+class HashCellGenerator {
+    z3::context& c;
+    std::vector<z3::expr> vars;  // hashed Int variables, sorted by name
+    size_t batch;                // solutions wanted per cell
+    unsigned num_hashes = 0;     // m, there are prime^m cells
+    unsigned max_hashes = 0;     // largest m reached
+    size_t num_quotients = 0;
+    size_t num_cells = 0;
+    size_t empty_cells = 0;
+    size_t small_cells = 0;      // exhausted with fewer than batch / prime solutions
+    size_t large_cells = 0;      // not exhausted by a batch
+    size_t num_solutions = 0;
+
+    static constexpr unsigned prime = 5;
+    static constexpr size_t max_vars = 64;  // most frequent Int variables hashed
+
+   public:
+    static constexpr const char* quotient_prefix = "hash!q";
+
+    HashCellGenerator(z3::context& _c, const z3::goal& ls_goal, const z3::expr& formula, size_t _batch);
+
+    /* the conjunction of num_hashes fresh random hash constraints, true while num_hashes is 0 */
+    z3::expr draw_cell(std::mt19937& mt);
+    /* tunes num_hashes from the solutions found in the last cell and whether they were all of them */
+    void update(size_t found, bool exhausted);
+    /* whether a model constant is a quotient variable of a cell, which stays out of the samples */
+    static bool is_quotient(const std::string& name) { return name.rfind(quotient_prefix, 0) == 0; }
+
+    size_t get_batch() const { return batch; }
+    bool empty() const { return vars.empty(); }
+    void print_statistic(std::ostream& os) const;
+};
+
+}  // namespace sampler
@@ -1,8 +1,12 @@
 #include "liasampler.h"
 
+#include <algorithm>
 #include <filesystem>  // C++17 引入的库
 #include <fstream>
 #include <regex>
+#include <sstream>
+
+#include <sys/resource.h>
 
 namespace sampler {
 
@@ -18,34 +22,6 @@ __int128_t polynomialHash(const std::vector<__int128_t>& data, __int128_t seed =
     return hashValue;
 }
 
-__int128_t string_to_int128(const std::string& str) {
-    if (str == "false") return 0;
-    if (str == "true") return 1;
-    __int128_t result = 0;
-    bool is_negative = false;
-    size_t start_idx = 0;
-
-    if (str[0] == '-') {
-        is_negative = true;
-        start_idx = 1;
-    }
-
-    // 逐字符处理字符串并转换为数字
-    for (size_t i = start_idx; i < str.size(); ++i) {
-        char c = str[i];
-        if (c < '0' || c > '9') {
-            throw std::invalid_argument("Invalid character in the string");
-        }
-        result = result * 10 + (c - '0');
-    }
-
-    if (is_negative) {
-        result = -result;
-    }
-
-    return result;
-}
-
 std::string processNegNumber(const std::string& input) {
     // 定义正则表达式以匹配类似 "(- 4294967281)" 的模式
     std::regex pattern(R"(\(\s*(-\s*\d+)\s*\))");
@@ -83,10 +59,96 @@ std::string extract_filename(const std::string& path) {
     return path;  // 如果没有 '/'，假设整个路径就是文件名
 }
 
+// a solver keeps the statistics of all its checks, the last entry of a key is the one of the last check
+double stat_value(const z3::stats& st, const char* key) {
+    for (unsigned i = st.size(); i-- > 0;) {
+        if (st.key(i) == key) {
+            return st.is_uint(i) ? st.uint_value(i) : st.double_value(i);
+        }
+    }
+    return 0;
+}
+
 void LiaSampler::print_statistic() {
-    std::cout << "--------------------- After sampling: statistic ---------------------\n";
-    std::cout << "Sampling time: " << TimeElapsed() << "\n";
-    std::cout << "Total samples number: " << num_samples << "\n";
+    double sampling_time = TimeElapsed();
+    log_stream << "--------------------- After sampling: statistic ---------------------\n";
+    log_stream << "Sampling time: " << sampling_time << "\n";
+    log_stream << "Total samples number: " << num_samples << "\n";
+    log_stream << "Time to first sample: " << time_first_sample << "\n";
+    log_stream << "Unique samples per minute: " << (sampling_time > 0 ? num_samples * 60.0 / sampling_time : 0.0) << "\n";
+    if (mode == LS || mode == SLS || mode == HASH) {
+        log_stream << "LS steps: " << ls_steps << "\n";
+        log_stream << "LS steps per second: " << (ls_time > 0 ? ls_steps / ls_time : 0.0) << "\n";
+        if (ls_pb_checks > 0) {
+            log_stream << "LS checks on the pseudo-Boolean fast path: " << ls_pb_checks << "\n";
+        }
+        if (ls_idl_checks > 0) {
+            log_stream << "LS checks on the difference logic fast path: " << ls_idl_checks << "\n";
+        }
+        if (ls_build_time > 0) {
+            log_stream << "LS instance build time: " << ls_build_time << " (largest instance " << ls_instance_mb_peak << " MB)\n";
+        }
+        if (ls_score_lookups > 0) {
+            log_stream << "Score cache hit rate: " << ls_score_hits / ls_score_lookups << "\n";
+        }
+    }
+    if (cdcl_checks > 0) {
+        log_stream << "CDCL(T) unique models per check: " << (double)cdcl_unique_models / cdcl_checks << " (" << cdcl_unique_models << " of "
+                  << cdcl_checks << (cdcl_diversify ? ", diversified" : "") << ")\n";
+    }
+    if (enumerator) {
+        enumerator->print_statistic(log_stream);
+    }
+    if (coverage) {
+        if (coverage_timeline.empty() || coverage_timeline.back().num_samples != num_samples) {
+            coverage_timeline.push_back({num_samples, sampling_time, coverage->coverage()});
+        }
+        coverage->print_statistic(log_stream);
+        log_stream << "Coverage over time (samples, seconds, %):";
+        for (const CoveragePoint& p : coverage_timeline) {
+            log_stream << " " << p.num_samples << " " << p.time << " " << p.coverage << ";";
+        }
+        log_stream << "\n";
+        if (coverage_plateau_hit) {
+            log_stream << "Stopped on a coverage plateau: no new coverage in the last " << samples_since_coverage << " samples\n";
+        }
+    }
+    if (ls_coverable_bits > 0) {
+        if (bit_coverage_timeline.empty() || bit_coverage_timeline.back().num_samples != num_samples) {
+            bit_coverage_timeline.push_back({num_samples, sampling_time, 100.0 * ls_covered_bits / ls_coverable_bits});
+        }
+        log_stream << "Bit coverage: " << ls_covered_bits << " / " << ls_coverable_bits << " bits of the LS variables\n";
+        log_stream << "Bit coverage over time (samples, seconds, %):";
+        for (const CoveragePoint& p : bit_coverage_timeline) {
+            log_stream << " " << p.num_samples << " " << p.time << " " << p.coverage << ";";
+        }
+        log_stream << "\n";
+    }
+    if (cdcl_threads > 1) {
+        log_stream << "Parallel CDCL(T) models: " << parallel_models << " from " << cdcl_threads << " threads\n";
+    }
+    if (pool) {
+        pool->print_statistic(log_stream);
+    }
+    if (partitioner) {
+        partitioner->print_statistic(log_stream);
+        log_stream << "Partition rejects: " << partition_rejects << "\n";
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        log_stream << "Peak RSS (MB): " << usage.ru_maxrss / 1024.0 << "\n";  // ru_maxrss is in KB on Linux
+    }
+    z3_alloc_peak = std::max(z3_alloc_peak, (size_t)Z3_get_estimated_alloc_size());
+    log_stream << "Z3 allocations peak / at exit (MB): " << z3_alloc_peak / 1048576.0 << " / "
+              << Z3_get_estimated_alloc_size() / 1048576.0 << "\n";
+    if (cells) {
+        cells->print_statistic(log_stream);
+        log_stream << "CDCL(T) samples: " << num_cdcl_samples << ", LS samples: " << num_ls_samples << "\n";
+    }
+    if (scheduler) {
+        log_stream << "CDCL(T) samples: " << num_cdcl_samples << ", LS samples: " << num_ls_samples << "\n";
+        scheduler->print_statistic(log_stream);
+    }
 }
 
 double LiaSampler::TimeElapsed() {
@@ -131,28 +193,64 @@ z3::tactic LiaSampler::mk_preamble_tactic(z3::context& ctx) {
                     main_p);
 }
 
+// bit guided: the coverage of the context's seen bits, which every LS check of any mode extends
+void LiaSampler::read_bit_coverage(const z3::solver& ls_solver) {
+    if (!bit_guided) {
+        return;
+    }
+    z3::stats st = ls_solver.statistics();
+    ls_covered_bits = std::max(ls_covered_bits, stat_value(st, "ls-sampler-covered-bits"));
+    ls_coverable_bits = std::max(ls_coverable_bits, stat_value(st, "ls-sampler-coverable-bits"));
+}
+
 void LiaSampler::ls_sampling_core(z3::solver& ls_solver, const z3::goal& subgoal) {
     ls_solver.set("random_seed", gen_random_seed());
 
+    std::chrono::steady_clock::time_point call_start = std::chrono::steady_clock::now();
     z3::check_result check_res = ls_solver.check();
+    std::chrono::duration<double> call_time = std::chrono::steady_clock::now() - call_start;
+    ls_time += call_time.count();
+    z3::stats st = ls_solver.statistics();
+    ls_steps += stat_value(st, "ls-sampler-steps");
+    ls_score_lookups += stat_value(st, "ls-sampler-score-lookups");
+    ls_score_hits += stat_value(st, "ls-sampler-score-hits");
+    ls_pb_checks += stat_value(st, "ls-sampler-pb-engine") > 0;
+    ls_idl_checks += stat_value(st, "ls-sampler-idl-engine") > 0;
+    ls_build_time += stat_value(st, "ls-sampler-build-time");
+    ls_instance_mb_peak = std::max(ls_instance_mb_peak, stat_value(st, "ls-sampler-instance-mb"));
+    read_bit_coverage(ls_solver);
     if (z3::sat != check_res) {
-        std::cout << "Unsat or unknown case!\n";
+        log_stream << "Unsat or unknown case!\n";
         return;
     }
     z3::model m = ls_solver.get_model();
     m = subgoal.convert_model(m);
+    load_model(m);
+}
 
-    for (size_t j = 0; j < m.size(); ++j) {
-        if (m[j].is_const()) {
-            curr_sample[m[j].name().str()] = processNegNumber(m.get_const_interp(m[j]).to_string());
-            // samplesFile << m[j].name().str() << ":" << processNegNumber(m.get_const_interp(m[j]).to_string()) << ";";
-        }
+// parameters of the CCSS solver shared by every mode that runs LS; --ls-timeout, else default_timeout seconds, else z3's default
+z3::params LiaSampler::mk_ls_params(unsigned default_timeout) {
+    z3::params smt_p(c);
+    smt_p.set("ls_sampling", true);
+    smt_p.set("auto_config", false);
+    smt_p.set("ls_bit_guided", bit_guided);
+    smt_p.set("ls_candidate_clauses", candidate_clauses);
+    smt_p.set("ls_score_cache", score_cache);
+    smt_p.set("ls_warm_restart", warm_restart_pct);
+    smt_p.set("ls_eliminate_equalities", eliminate_equalities);
+    smt_p.set("ls_pb_fast_path", pb_fast_path);
+    smt_p.set("ls_idl_fast_path", idl_fast_path);
+    smt_p.set("ls_trace", ls_trace.c_str());
+    unsigned timeout = ls_timeout > 0 ? ls_timeout : default_timeout;
+    if (timeout > 0) {
+        smt_p.set("ls_timeout", timeout);
     }
+    return smt_p;
 }
 
 #ifdef LS_MODE
-void LiaSampler::ls_sampling(std::ofstream& samplesFile) {
-    std::cout << "-----------------------LS-SAMPLING MODE-----------------------\n";
+void LiaSampler::ls_sampling(SampleSink& sink) {
+    log_stream << "-----------------------LS-SAMPLING MODE-----------------------\n";
 
     z3::goal g(c);
     g.add(original_formula);
@@ -164,47 +262,46 @@ void LiaSampler::ls_sampling(std::ofstream& samplesFile) {
 
     // z3::solver ls_solver(c);
 
-    z3::params smt_p(c);
-    smt_p.set("ls_sampling", true);
-    smt_p.set("auto_config", false);  // 关键
+    z3::params smt_p = mk_ls_params(0);
     z3::solver ls_solver = z3::with(z3::tactic(c, "smt"), smt_p).mk_solver();
 
     for (unsigned i = 0; i < subgoal.size(); i++) {
         ls_solver.add(subgoal[i]);
     }
 
-    while (num_samples < maxNumSamples) {
+    while (num_samples < maxNumSamples && !stop_requested) {
         ls_sampling_core(ls_solver, subgoal);
 
-        print_unique_sample(samplesFile);
+        print_unique_sample(sink);
 
-        if (TimeElapsed() > maxTimeLimit) {
+        if (TimeElapsed() > maxTimeLimit || stop_requested) {
             break;
         }
 #ifdef VERBOSE
-        std::cout << " ============================== \n";
+        log_stream << " ============================== \n";
 #endif
     }
 }
 #endif
 
 #ifdef CDCL_MODE
-void LiaSampler::cdcl_sampling(std::ofstream& samplesFile) {
-    std::cout << "-----------------------CDCL-SAMPLING MODE-----------------------\n";
+void LiaSampler::cdcl_sampling(SampleSink& sink) {
+    log_stream << "-----------------------CDCL-SAMPLING MODE-----------------------\n";
     z3::solver cdcl_solver(c);
 
     cdcl_solver.add(original_formula);
     cdcl_solver.set("logic", "QF_LIA");
-    z3::check_result check_res = cdcl_solver.check();
+    cdcl_solver.set("cdcl_diversify", cdcl_diversify);
+    set_cdcl_threads(cdcl_solver);
+    enumerator = std::make_unique<ProjectionEnumerator>(c, cdcl_solver, original_formula, mt, block_gc_interval);
 
-    while (num_samples < maxNumSamples) {
-        // cdcl_solver.push();
-        z3::check_result check_res = cdcl_solver.check();
+    z3::model m(c);
+    while (num_samples < maxNumSamples && !stop_requested) {
+        z3::check_result check_res = enumerator->next(m);
         if (z3::sat != check_res) {
-            std::cout << "Unsat or unknown case!\b";
+            log_stream << (z3::unsat == check_res && num_samples > 0 ? "All models enumerated!\n" : "Unsat or unknown case!\n");
             return;
         }
-        z3::model m = cdcl_solver.get_model();
         for (size_t j = 0; j < m.size(); ++j) {
             if (m[j].is_const()) {
                 curr_sample[m[j].name().str()] = processNegNumber(m.get_const_interp(m[j]).to_string());
@@ -212,11 +309,12 @@ void LiaSampler::cdcl_sampling(std::ofstream& samplesFile) {
             }
         }
 
-        print_unique_sample(samplesFile);
-
-        // cdcl_solver.pop();
+        cdcl_checks++;
+        cdcl_unique_models += print_unique_sample(sink);
+        cdcl_unique_models += take_parallel_models(cdcl_solver, sink);
+        expand_cdcl_model(m, sink);
 
-        if (TimeElapsed() > maxTimeLimit) {
+        if (TimeElapsed() > maxTimeLimit || stop_requested) {
             break;
         }
     }
@@ -224,8 +322,8 @@ void LiaSampler::cdcl_sampling(std::ofstream& samplesFile) {
 #endif
 
 #ifdef HYBRID_MODE
-void LiaSampler::hybrid_sampling(std::ofstream& samplesFile) {
-    std::cout << "-----------------------HYBRID-SAMPLING MODE-----------------------\n";
+void LiaSampler::hybrid_sampling(SampleSink& sink) {
+    log_stream << "-----------------------HYBRID-SAMPLING MODE-----------------------\n";
 
     std::uniform_real_distribution<double> dist(0.0, 1.0);
 
@@ -238,11 +336,8 @@ void LiaSampler::hybrid_sampling(std::ofstream& samplesFile) {
     z3::goal subgoal = simp_ar[0];
 
     /* LS solver */
-    z3::params smt_p(c);
-    smt_p.set("ls_sampling", true);
-    smt_p.set("auto_config", false);
+    z3::params smt_p = mk_ls_params(60);  // 60 seconds by default
     smt_p.set("logic", "QF_LIA");
-    smt_p.set("ls_timeout", 60U);                                              // 60 seconds
     z3::solver ls_solver = z3::with(z3::tactic(c, "smt"), smt_p).mk_solver();  // test
 
     for (unsigned i = 0; i < subgoal.size(); i++) {  // test
@@ -253,26 +348,19 @@ void LiaSampler::hybrid_sampling(std::ofstream& samplesFile) {
     /* CDCL(T) solver */
     z3::solver cdcl_solver(c);
     cdcl_solver.set("timeout", 50000U);  // 50 seconds
+    cdcl_solver.set("cdcl_diversify", cdcl_diversify);
+    set_cdcl_threads(cdcl_solver);
     cdcl_solver.add(original_formula);
 
-    z3::model m_ls(c);
+    z3::model m_ls = guide_model();
     z3::check_result res;
-    while (num_samples < maxNumSamples) {
+    while (num_samples < maxNumSamples && !stop_requested) {
         // cdcl sampling
         for (size_t k = 0; k < cdcl_epoch; ++k) {
             // cdcl_solver.push();
             z3::expr_vector assertions_vector(c);
             if (num_samples != 0) {  // 用 LS 的解固定CDCL(T)中的变量
-                for (size_t j = 0; j < m_ls.size(); ++j) {
-                    if (m_ls[j].is_const() && m_ls[j].decl_kind() != Z3_OP_TRUE && m_ls[j].decl_kind() != Z3_OP_FALSE && dist(mt) < fixed_var_pct) {
-                        std::string var_name = m_ls[j].name().str();
-                        std::string var_value = processNegNumber(m_ls.get_const_interp(m_ls[j]).to_string());
-                        z3::expr val = c.int_val(var_value.c_str());
-                        z3::symbol var_symbol = c.str_symbol(var_name.c_str());
-                        z3::expr var = c.constant(var_symbol, c.int_sort());
-                        assertions_vector.push_back(var == val);
-                    }
-                }
+                fix_vars_from_model(m_ls, fixed_var_pct, dist, assertions_vector);
                 res = cdcl_solver.check(assertions_vector);
             } else {  // 第一次CDCL(T)
                 res = cdcl_solver.check();
@@ -287,12 +375,15 @@ void LiaSampler::hybrid_sampling(std::ofstream& samplesFile) {
                         curr_sample[var_name] = var_value;
                     }
                 }
-                print_unique_sample(samplesFile);
+                cdcl_checks++;
+                cdcl_unique_models += print_unique_sample(sink);
+                cdcl_unique_models += take_parallel_models(cdcl_solver, sink);
+                expand_cdcl_model(cdcl_m, sink);
 #ifdef VERBOSE
-                std::cout << "============Sample from stochastic CDCL(T)============\n";
+                log_stream << "============Sample from stochastic CDCL(T)============\n";
 #endif
             } else {
-                std::cout << "Stochastic CDCL(T) timeout!\n";  // or UNSAT/UNKNOWN ?
+                log_stream << "Stochastic CDCL(T) timeout!\n";  // or UNSAT/UNKNOWN ?
             }
             // cdcl_solver.pop();
         }
@@ -301,12 +392,14 @@ void LiaSampler::hybrid_sampling(std::ofstream& samplesFile) {
             // ls sampling
             ls_solver.set("random_seed", gen_random_seed());
             z3::check_result check_res = ls_solver.check();
+            read_bit_coverage(ls_solver);
             if (z3::sat != check_res) {
-                std::cout << "Unsat or unknown case form LS!\n";
+                log_stream << "Unsat or unknown case form LS!\n";
                 continue;
             }
             m_ls = ls_solver.get_model();
             m_ls = subgoal.convert_model(m_ls);  // test
+            remember_guide(m_ls);
 
             for (size_t j = 0; j < m_ls.size(); ++j) {
                 if (m_ls[j].is_const()) {
@@ -316,21 +409,22 @@ void LiaSampler::hybrid_sampling(std::ofstream& samplesFile) {
                 }
             }
 
-            print_unique_sample(samplesFile);
+            print_unique_sample(sink);
 #ifdef VERBOSE
-            std::cout << "============Sample from stochastic Local Search============\n";
+            log_stream << "============Sample from stochastic Local Search============\n";
 #endif
         }
 
-        if (TimeElapsed() > maxTimeLimit || num_samples >= maxNumSamples) {
+        if (TimeElapsed() > maxTimeLimit || num_samples >= maxNumSamples || stop_requested) {
             break;
         }
     }
 }
 #endif
 
-void LiaSampler::ls_iterative_sampling(std::ofstream& samplesFile) {
-    std::cout << "-----------------------ls_iterative_sampling-----------------------\n";
+#ifdef ADAPTIVE_MODE
+void LiaSampler::adaptive_sampling(SampleSink& sink) {
+    log_stream << "-----------------------ADAPTIVE-SAMPLING MODE-----------------------\n";
 
     std::uniform_real_distribution<double> dist(0.0, 1.0);
 
@@ -343,11 +437,249 @@ void LiaSampler::ls_iterative_sampling(std::ofstream& samplesFile) {
     z3::goal subgoal = simp_ar[0];
 
     /* LS solver */
-    z3::params smt_p(c);
-    smt_p.set("ls_sampling", true);
-    smt_p.set("auto_config", false);
+    z3::params smt_p = mk_ls_params(0);  // the scheduler bounds every check
+    smt_p.set("logic", "QF_LIA");
+    z3::solver ls_solver = z3::with(z3::tactic(c, "smt"), smt_p).mk_solver();
+    for (unsigned i = 0; i < subgoal.size(); i++) {
+        ls_solver.add(subgoal[i]);
+    }
+
+    /* CDCL(T) solver */
+    z3::solver cdcl_solver(c);
+    cdcl_solver.set("cdcl_diversify", cdcl_diversify);
+    set_cdcl_threads(cdcl_solver);
+    cdcl_solver.add(original_formula);
+
+    // same initial timeouts as hybrid mode: 50s for CDCL(T), 60s for LS
+    scheduler = std::make_unique<AdaptiveScheduler>(50000U, 60000U);
+    for (double pct : {0.0, 0.25, 0.5, 0.75}) {
+        scheduler->add_arm(CDCL_SOURCE, pct);
+    }
+    scheduler->add_arm(LS_SOURCE);
+
+    z3::model m_ls = guide_model();
+    bool has_ls_model = !guide_sample.empty();
+    while (num_samples < maxNumSamples && TimeElapsed() < maxTimeLimit && !stop_requested) {
+        size_t idx = scheduler->select();
+        const SchedulerArm& arm = scheduler->get_arm(idx);
+
+        // never let a single call run past the global time limit
+        double remaining_ms = (maxTimeLimit - TimeElapsed()) * 1000.0;
+        unsigned timeout_ms = (unsigned)std::max(1.0, std::min((double)scheduler->get_timeout_ms(arm.source), remaining_ms));
+
+        std::chrono::steady_clock::time_point call_start = std::chrono::steady_clock::now();
+        z3::check_result res;
+        z3::model m(c);
+        if (arm.source == CDCL_SOURCE) {
+            cdcl_solver.set("timeout", timeout_ms);
+            z3::expr_vector assertions_vector(c);
+            if (has_ls_model && arm.fixed_var_pct > 0) {
+                fix_vars_from_model(m_ls, arm.fixed_var_pct, dist, assertions_vector);
+            }
+            res = cdcl_solver.check(assertions_vector);
+            if (z3::sat == res) {
+                m = cdcl_solver.get_model();
+            }
+        } else {
+            ls_solver.set("random_seed", gen_random_seed());
+            ls_solver.set("ls_timeout", std::max(1U, timeout_ms / 1000));
+            res = ls_solver.check();
+            read_bit_coverage(ls_solver);
+            if (z3::sat == res) {
+                m = subgoal.convert_model(ls_solver.get_model());
+                m_ls = m;
+                has_ls_model = true;
+                remember_guide(m_ls);
+            }
+        }
+
+        size_t unique = 0, duplicates = 0;
+        if (z3::sat == res) {
+            load_model(m);
+            if (print_unique_sample(sink)) {
+                unique++;
+            } else {
+                duplicates++;
+            }
+            if (arm.source == CDCL_SOURCE) {
+                cdcl_checks++;
+                unique += take_parallel_models(cdcl_solver, sink);
+                cdcl_unique_models += unique;
+                unique += expand_cdcl_model(m, sink);
+            }
+            (arm.source == CDCL_SOURCE ? num_cdcl_samples : num_ls_samples) += unique;
+        }
+        std::chrono::duration<double> call_time = std::chrono::steady_clock::now() - call_start;
+        // unsat under fixed variables is a cheap miss, only unknown counts as a timeout
+        scheduler->update(idx, call_time.count(), unique, duplicates, z3::unknown == res);
+    }
+}
+#endif
+
+#ifdef SLS_MODE
+// samples through z3's own sls engine (sls-smt tactic) instead of CCSS
+void LiaSampler::sls_sampling(SampleSink& sink) {
+    log_stream << "-----------------------SLS-SAMPLING MODE-----------------------\n";
+
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    z3::goal g(c);
+    g.add(original_formula);
+    z3::tactic preamble_tactic = mk_preamble_tactic(c);
+    z3::apply_result simp_ar = preamble_tactic(g);
+
+    assert(simp_ar.size() == 1);
+    z3::goal subgoal = simp_ar[0];
+
+    /* sls solver, every check bounded by ls_timeout like the CCSS checks */
+    unsigned timeout = ls_timeout > 0 ? ls_timeout : 60;
+    z3::solver sls_solver = z3::try_for(z3::tactic(c, "sls-smt"), timeout * 1000U).mk_solver();
+    for (unsigned i = 0; i < subgoal.size(); i++) {
+        sls_solver.add(subgoal[i]);
+    }
+
+    /* CDCL(T) solver, its model seeds the sls engine */
+    z3::solver cdcl_solver(c);
+    cdcl_solver.set("timeout", 50000U);  // 50 seconds
+    cdcl_solver.add(original_formula);
+    z3::model m_cdcl(c);
+    bool has_cdcl_model = z3::sat == cdcl_solver.check();
+    if (has_cdcl_model) {
+        m_cdcl = cdcl_solver.get_model();
+    }
+
+    while (num_samples < maxNumSamples && !stop_requested) {
+        sls_solver.set("random_seed", gen_random_seed());
+        if (has_cdcl_model) {  // 用 CDCL(T) 的解作为部分变量的初值
+            for (size_t j = 0; j < m_cdcl.size(); ++j) {
+                if (m_cdcl[j].is_const() && m_cdcl[j].range().is_int() && dist(mt) < fixed_var_pct) {
+                    sls_solver.set_initial_value(m_cdcl[j](), m_cdcl.get_const_interp(m_cdcl[j]));
+                }
+            }
+        }
+
+        std::chrono::steady_clock::time_point call_start = std::chrono::steady_clock::now();
+        z3::check_result check_res = sls_solver.check();
+        std::chrono::duration<double> call_time = std::chrono::steady_clock::now() - call_start;
+        ls_time += call_time.count();
+        ls_steps += stat_value(sls_solver.statistics(), "sls-ddfw-flips");
+
+        if (z3::sat == check_res) {
+            load_model(subgoal.convert_model(sls_solver.get_model()));
+            print_unique_sample(sink);
+        } else {
+            log_stream << "Unsat or unknown case form SLS!\n";
+        }
+
+        if (TimeElapsed() > maxTimeLimit || stop_requested) {
+            break;
+        }
+    }
+}
+#endif
+
+#ifdef HASH_MODE
+// near-uniform sampling: every batch comes from a random hash cell, see hashcell.h
+void LiaSampler::hash_sampling(SampleSink& sink) {
+    log_stream << "-----------------------HASH-SAMPLING MODE-----------------------\n";
+
+    z3::goal g(c);
+    g.add(original_formula);
+    z3::tactic preamble_tactic = mk_preamble_tactic(c);
+    z3::apply_result simp_ar = preamble_tactic(g);
+
+    assert(simp_ar.size() == 1);
+    z3::goal subgoal = simp_ar[0];
+
+    /* LS solver, the cells are pushed on top of the simplified goal */
+    z3::params smt_p = mk_ls_params(10);  // 10 seconds by default, a cell is much smaller than the formula
+    smt_p.set("logic", "QF_LIA");
+    z3::solver ls_solver = z3::with(z3::tactic(c, "smt"), smt_p).mk_solver();
+    for (unsigned i = 0; i < subgoal.size(); i++) {
+        ls_solver.add(subgoal[i]);
+    }
+
+    /* CDCL(T) solver, enumerates a cell with blocking clauses inside a push scope */
+    z3::solver cdcl_solver(c);
+    cdcl_solver.set("logic", "QF_LIA");
+    cdcl_solver.set("cdcl_diversify", cdcl_diversify);
+    cdcl_solver.add(original_formula);
+
+    cells = std::make_unique<HashCellGenerator>(c, subgoal, original_formula, hash_batch);
+    if (cells->empty()) {
+        log_stream << "No Int variable to hash, the cells are the whole space\n";
+    }
+    std::vector<z3::func_decl> consts;
+    collect_formula_consts(consts);
+
+    unsigned ls_misses = 0;  // consecutive cells LS did not solve
+    while (num_samples < maxNumSamples && TimeElapsed() < maxTimeLimit && !stop_requested) {
+        z3::expr cell = cells->draw_cell(mt);
+
+        size_t found = 0;
+        z3::check_result res = z3::sat;
+        cdcl_solver.push();
+        cdcl_solver.add(cell);
+        while (found < cells->get_batch() && num_samples < maxNumSamples && !stop_requested) {
+            double remaining_ms = (maxTimeLimit - TimeElapsed()) * 1000.0;
+            cdcl_solver.set("timeout", (unsigned)std::max(1.0, std::min(50000.0, remaining_ms)));
+            res = cdcl_solver.check();
+            if (z3::sat != res) {
+                break;
+            }
+            z3::model m = cdcl_solver.get_model();
+            found++;
+            load_model(m);
+            cdcl_checks++;
+            size_t unique = print_unique_sample(sink);
+            cdcl_unique_models += unique;
+            num_cdcl_samples += unique;
+
+            z3::expr_vector diff(c);
+            for (auto& d : consts) {
+                diff.push_back(d() != m.eval(d(), true));
+            }
+            cdcl_solver.add(z3::mk_or(diff));
+        }
+        cdcl_solver.pop();
+        // a cell cut short by a timeout or a limit says nothing about its size
+        if (z3::unsat == res || found == cells->get_batch()) {
+            cells->update(found, z3::unsat == res);
+        }
+
+        // LS walks the same cell from a random start, until it keeps failing
+        if (found > 0 && ls_misses < 3 && num_samples < maxNumSamples && TimeElapsed() < maxTimeLimit && !stop_requested) {
+            ls_solver.push();
+            ls_solver.add(cell);
+            ls_sampling_core(ls_solver, subgoal);
+            ls_solver.pop();
+            if (curr_sample.empty()) {
+                ls_misses++;
+            } else {
+                ls_misses = 0;
+                num_ls_samples += print_unique_sample(sink);
+            }
+        }
+    }
+}
+#endif
+
+void LiaSampler::ls_iterative_sampling(SampleSink& sink) {
+    log_stream << "-----------------------ls_iterative_sampling-----------------------\n";
+
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+    z3::goal g(c);
+    g.add(original_formula);
+    z3::tactic preamble_tactic = mk_preamble_tactic(c);
+    z3::apply_result simp_ar = preamble_tactic(g);
+
+    assert(simp_ar.size() == 1);
+    z3::goal subgoal = simp_ar[0];
+
+    /* LS solver */
+    z3::params smt_p = mk_ls_params(60);  // 60 seconds by default
     smt_p.set("logic", "QF_LIA");
-    smt_p.set("ls_timeout", 60U);                                              // 60 seconds
     z3::solver ls_solver = z3::with(z3::tactic(c, "smt"), smt_p).mk_solver();  // test
 
     for (unsigned i = 0; i < subgoal.size(); i++) {  // test
@@ -364,9 +696,9 @@ void LiaSampler::ls_iterative_sampling(std::ofstream& samplesFile) {
         ls_solver2.add(subgoal[i]);
     }
 
-    z3::model m_ls(c);
+    z3::model m_ls = guide_model();
     z3::check_result res;
-    while (num_samples < maxNumSamples) {
+    while (num_samples < maxNumSamples && !stop_requested) {
         z3::expr_vector assertions_vector(c);
         if (num_samples != 0) {
             for (size_t j = 0; j < m_ls.size(); ++j) {
@@ -383,6 +715,7 @@ void LiaSampler::ls_iterative_sampling(std::ofstream& samplesFile) {
         } else {
             res = ls_solver2.check();
         }
+        read_bit_coverage(ls_solver2);
 
         if (z3::sat == res) {
             z3::model ls2_m = ls_solver2.get_model();
@@ -394,12 +727,12 @@ void LiaSampler::ls_iterative_sampling(std::ofstream& samplesFile) {
                     curr_sample[var_name] = var_value;
                 }
             }
-            print_unique_sample(samplesFile);
+            print_unique_sample(sink);
 #ifdef VERBOSE
-            std::cout << "============Sample from stochastic LS1============\n";
+            log_stream << "============Sample from stochastic LS1============\n";
 #endif
         } else {
-            std::cout << "Stochastic LS1 timeout!\n";  // or UNSAT/UNKNOWN ?
+            log_stream << "Stochastic LS1 timeout!\n";  // or UNSAT/UNKNOWN ?
         }
         // cdcl_solver.pop();
 
@@ -407,12 +740,14 @@ void LiaSampler::ls_iterative_sampling(std::ofstream& samplesFile) {
             // ls sampling
             ls_solver.set("random_seed", gen_random_seed());
             z3::check_result check_res = ls_solver.check();
+            read_bit_coverage(ls_solver);
             if (z3::sat != check_res) {
-                std::cout << "Unsat or unknown case form LS!\n";
+                log_stream << "Unsat or unknown case form LS!\n";
                 continue;
             }
             m_ls = ls_solver.get_model();
             m_ls = subgoal.convert_model(m_ls);  // test
+            remember_guide(m_ls);
 
             for (size_t j = 0; j < m_ls.size(); ++j) {
                 if (m_ls[j].is_const()) {
@@ -422,46 +757,282 @@ void LiaSampler::ls_iterative_sampling(std::ofstream& samplesFile) {
                 }
             }
 
-            print_unique_sample(samplesFile);
+            print_unique_sample(sink);
 #ifdef VERBOSE
-            std::cout << "============Sample from stochastic Local Search============\n";
+            log_stream << "============Sample from stochastic Local Search============\n";
 #endif
         }
 
-        if (TimeElapsed() > maxTimeLimit || num_samples >= maxNumSamples) {
+        if (TimeElapsed() > maxTimeLimit || num_samples >= maxNumSamples || stop_requested) {
             break;
         }
     }
 }
 
-void LiaSampler::print_unique_sample(std::ofstream& samplesFile) {
+void LiaSampler::load_model(const z3::model& m) {
+    for (size_t j = 0; j < m.size(); ++j) {
+        if (m[j].is_const() && !(cells && HashCellGenerator::is_quotient(m[j].name().str()))) {
+            curr_sample[m[j].name().str()] = processNegNumber(m.get_const_interp(m[j]).to_string());
+        }
+    }
+}
+
+void LiaSampler::set_cdcl_threads(z3::solver& cdcl_solver) {
+    if (cdcl_threads > 1) {
+        cdcl_solver.set("threads", cdcl_threads);
+        cdcl_solver.set("threads.sample_models", cdcl_thread_models);
+    }
+}
+
+// writes the models the other workers of the last parallel check found, returns how many were unique
+size_t LiaSampler::take_parallel_models(const z3::solver& cdcl_solver, SampleSink& sink) {
+    if (cdcl_threads <= 1) {
+        return 0;
+    }
+    size_t unique = 0;
+    unsigned n = cdcl_solver.num_sampled_models();
+    parallel_models += n;
+    for (unsigned i = 0; i < n && num_samples < maxNumSamples; ++i) {
+        load_model(cdcl_solver.sampled_model(i));
+        unique += print_unique_sample(sink);
+    }
+    return unique;
+}
+
+// writes up to expand_k more samples around m, returns how many of them were unique
+size_t LiaSampler::expand_cdcl_model(const z3::model& m, SampleSink& sink) {
+    if (expand_k == 0 || num_samples >= maxNumSamples) {
+        return 0;
+    }
+    if (!model_expander) {
+        model_expander = std::make_unique<ModelExpander>(c, original_formula);
+    }
+    const std::vector<std::string>& names = model_expander->get_var_names();
+    size_t unique = 0;
+    size_t k = std::min(expand_k, maxNumSamples - num_samples);
+    model_expander->expand(m, k, mt, [&](const std::vector<__int128_t>& values) {
+        load_model(m);
+        for (size_t i = 0; i < names.size(); ++i) {
+            auto it = curr_sample.find(names[i]);
+            if (it != curr_sample.end()) {  // don't-care variables stay out of the sample
+                it->second = ModelExpander::to_string(values[i]);
+            }
+        }
+        unique += print_unique_sample(sink);
+    });
+    return unique;
+}
+
+// fix each Int variable of m with probability pct
+void LiaSampler::fix_vars_from_model(const z3::model& m, double pct, std::uniform_real_distribution<double>& dist, z3::expr_vector& assertions) {
+    for (size_t j = 0; j < m.size(); ++j) {
+        if (m[j].is_const() && m[j].decl_kind() != Z3_OP_TRUE && m[j].decl_kind() != Z3_OP_FALSE && dist(mt) < pct) {
+            std::string var_name = m[j].name().str();
+            std::string var_value = processNegNumber(m.get_const_interp(m[j]).to_string());
+            z3::expr val = c.int_val(var_value.c_str());
+            z3::symbol var_symbol = c.str_symbol(var_name.c_str());
+            z3::expr var = c.constant(var_symbol, c.int_sort());
+            assertions.push_back(var == val);
+        }
+    }
+}
+
+bool LiaSampler::print_unique_sample(SampleSink& sink) {
     curr_sample_val.resize(curr_sample.size());
     size_t val_idx = 0;
     for (auto p : curr_sample) {
         curr_sample_val[val_idx++] = string_to_int128(p.second);
     }
     __int128_t hash_val = polynomialHash(curr_sample_val);
+    if (partitioner && !partitioner->owns(hash_val)) {
+        partition_rejects++;
+        curr_sample_val.clear();
+        curr_sample.clear();
+        return false;
+    }
 
-    if (unique_samples_hash_set.find(hash_val) == unique_samples_hash_set.end()) {
-        samplesFile << num_samples << ": ";
-        for (auto p : curr_sample) {
-            samplesFile << p.first << ":" << p.second << ";";
-        }
-        samplesFile << "\n";
+    bool unique = unique_samples_hash_set.find(hash_val) == unique_samples_hash_set.end();
+    if (unique) {
+        sink.write_sample(num_samples, curr_sample, curr_sample_val);
         num_samples++;
+        if (time_first_sample < 0) {
+            time_first_sample = TimeElapsed();
+        }
         unique_samples_hash_set.insert(hash_val);
+        if (pool) {
+            pool->offer(curr_sample, curr_sample_val);
+            if (TimeElapsed() - last_pool_write >= pool_checkpoint_sec) {
+                write_pool();
+            }
+        }
+        z3_alloc_peak = std::max(z3_alloc_peak, (size_t)Z3_get_estimated_alloc_size());
+        if (track_coverage) {
+            update_coverage();
+        }
+        if (ls_coverable_bits > 0 && (num_samples & (num_samples - 1)) == 0) {
+            bit_coverage_timeline.push_back({num_samples, TimeElapsed(), 100.0 * ls_covered_bits / ls_coverable_bits});
+        }
+        if (checkpoint_sec > 0 && TimeElapsed() - last_checkpoint >= checkpoint_sec) {
+            write_checkpoint(sink);
+        }
 #ifdef VERBOSE
-        std::cout << "The " << num_samples << " sample is being generated ..." << std::endl;
+        log_stream << "The " << num_samples << " sample is being generated ..." << std::endl;
 #endif
     }
 #ifdef VERBOSE
     else {
-        std::cout << "duplicate samples\n";
+        log_stream << "duplicate samples\n";
     }
 #endif
 
     curr_sample_val.clear();
     curr_sample.clear();
+    return unique;
+}
+
+// the plateau ends sampling through maxNumSamples, which every mode checks
+void LiaSampler::update_coverage() {
+    if (!coverage) {
+        coverage = std::make_unique<CoverageTracker>(original_formula);
+    }
+    if (coverage->add(curr_sample) > 0) {
+        samples_since_coverage = 0;
+    } else {
+        samples_since_coverage++;
+    }
+    if ((num_samples & (num_samples - 1)) == 0) {
+        coverage_timeline.push_back({num_samples, TimeElapsed(), coverage->coverage()});
+    }
+    if (coverage_plateau > 0 && samples_since_coverage >= coverage_plateau) {
+        coverage_plateau_hit = true;
+        maxNumSamples = num_samples;
+    }
+}
+
+void LiaSampler::write_pool() {
+    if (!pool->write(pool_file_name)) {
+        std::cerr << "Unable to write the diverse pool to " << pool_file_name << std::endl;
+    }
+    last_pool_write = TimeElapsed();
+}
+
+// the column dictionary is taken from the formula, so samples whose model leaves out
+// a don't-care variable still fit the fixed column order (written as 0 / false)
+std::vector<SampleColumn> LiaSampler::sample_columns() {
+    std::vector<z3::func_decl> consts;
+    collect_formula_consts(consts);
+    std::vector<SampleColumn> columns;
+    for (auto& d : consts) {
+        columns.push_back({d.name().str(), d.range().is_bool() ? 'B' : 'I'});
+    }
+    std::sort(columns.begin(), columns.end(), [](const SampleColumn& a, const SampleColumn& b) {
+        return a.name < b.name;
+    });
+    return columns;
+}
+
+void LiaSampler::remember_guide(const z3::model& m) {
+    guide_sample.clear();
+    for (size_t j = 0; j < m.size(); ++j) {
+        if (m[j].is_const()) {
+            guide_sample[m[j].name().str()] = processNegNumber(m.get_const_interp(m[j]).to_string());
+        }
+    }
+}
+
+z3::model LiaSampler::guide_model() {
+    z3::model m(c);
+    if (guide_sample.empty()) {
+        return m;
+    }
+    std::vector<z3::func_decl> consts;
+    collect_formula_consts(consts);
+    for (auto& d : consts) {
+        auto it = guide_sample.find(d.name().str());
+        if (it == guide_sample.end()) {
+            continue;
+        }
+        z3::expr val = d.range().is_bool() ? c.bool_val(it->second == "true") : c.int_val(it->second.c_str());
+        m.add_const_interp(d, val);
+    }
+    return m;
+}
+
+void LiaSampler::write_checkpoint(SampleSink& sink) {
+    sink.flush();
+
+    SamplerCheckpoint ckpt;
+    ckpt.num_samples = num_samples;
+    ckpt.num_ls_samples = num_ls_samples;
+    ckpt.num_cdcl_samples = num_cdcl_samples;
+    std::error_code ec;
+    ckpt.output_offset = std::filesystem::file_size(samples_file_name, ec);
+    ckpt.elapsed = TimeElapsed();
+    ckpt.time_first_sample = time_first_sample;
+    ckpt.ls_steps = ls_steps;
+    ckpt.ls_time = ls_time;
+    ckpt.ls_score_lookups = ls_score_lookups;
+    ckpt.ls_score_hits = ls_score_hits;
+    std::ostringstream rng;
+    rng << mt;
+    ckpt.rng_state = rng.str();
+    ckpt.sample_hashes.assign(unique_samples_hash_set.begin(), unique_samples_hash_set.end());
+    ckpt.guide_sample = guide_sample;
+    if (ec || !ckpt.save(checkpoint_file_name)) {
+        std::cerr << "Unable to write the checkpoint " << checkpoint_file_name << std::endl;
+    }
+    last_checkpoint = ckpt.elapsed;
+}
+
+// the samples written after the checkpoint are cut off, they are not in the restored dedup set
+bool LiaSampler::restore_checkpoint() {
+    SamplerCheckpoint ckpt;
+    std::error_code ec;
+    if (!ckpt.load(checkpoint_file_name)) {
+        log_stream << "No usable checkpoint " << checkpoint_file_name << ", sampling from scratch\n";
+        return false;
+    }
+    std::filesystem::resize_file(samples_file_name, ckpt.output_offset, ec);
+    if (ec) {
+        log_stream << "Unable to truncate " << samples_file_name << " (" << ec.message() << "), sampling from scratch\n";
+        return false;
+    }
+
+    num_samples = ckpt.num_samples;
+    num_ls_samples = ckpt.num_ls_samples;
+    num_cdcl_samples = ckpt.num_cdcl_samples;
+    time_sampling_start -= std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(ckpt.elapsed));
+    last_checkpoint = ckpt.elapsed;
+    time_first_sample = ckpt.time_first_sample;
+    ls_steps = ckpt.ls_steps;
+    ls_time = ckpt.ls_time;
+    ls_score_lookups = ckpt.ls_score_lookups;
+    ls_score_hits = ckpt.ls_score_hits;
+    std::istringstream rng(ckpt.rng_state);
+    rng >> mt;
+    unique_samples_hash_set.insert(ckpt.sample_hashes.begin(), ckpt.sample_hashes.end());
+    guide_sample = ckpt.guide_sample;
+    log_stream << "Resumed from " << checkpoint_file_name << " at " << num_samples << " samples, " << ckpt.elapsed << " s\n";
+    return true;
+}
+
+// -m auto: the mode and parameters of the mode table row of the formula's class
+void LiaSampler::select_mode() {
+    static const std::map<std::string, SamplingMode> modes = {{"ls", LS}, {"cdcl", CDCL}, {"hybrid", HYBRID}, {"2ls", LS_ITER}};
+    const FormulaFeatures& f = formula_features();
+    ModeChoice choice = mode_selector.select(f);
+    mode = modes.at(choice.mode);
+    if (!keep_cdcl_epoch) {  // explicit -e, -p and --ls-timeout win over the table
+        cdcl_epoch = choice.cdcl_epoch;
+    }
+    if (!keep_fixed_var_pct) {
+        fixed_var_pct = choice.fixed_var_pct;
+    }
+    if (ls_timeout == 0) {
+        ls_timeout = choice.ls_timeout;
+    }
+    log_stream << "Auto mode: class " << f.class_name() << " -> " << choice.mode << ", cdcl epoch " << cdcl_epoch
+              << ", fixed var percentage " << fixed_var_pct << ", LS timeout " << ls_timeout << " s\n";
 }
 
 unsigned LiaSampler::gen_random_seed() {
@@ -473,31 +1044,77 @@ void LiaSampler::sampling() {
     time_sampling_start = std::chrono::steady_clock::now();
 
     parseSmtFile();
+    formula_features().print(log_stream);  // the class is read back by my_scripts/learn_mode_table.py
+    if (mode == AUTO) {
+        select_mode();
+    }
 
-    std::string samplesFileName = samplesFileDir + "/" + extract_filename(smtFilePath) + ".samples";
-    std::ofstream samplesFile(samplesFileName);  // 打开文件
-    if (!samplesFile) {
-        std::cerr << "Unable to open file " << samplesFileName << std::endl;
+    std::string samplesFileName = samplesFileDir + "/" + extract_filename(smtFilePath);
+    if (partitioner) {
+        original_formula = original_formula && partitioner->build_cube(original_formula);
+        samplesFileName += ".worker" + std::to_string(partitioner->get_worker());
+    }
+    if (pool_size > 0) {
+        std::vector<z3::func_decl> consts;
+        collect_formula_consts(consts);
+        std::vector<std::string> columns;
+        for (auto& d : consts) {
+            columns.push_back(d.name().str());
+        }
+        pool = std::make_unique<DiversePool>(pool_size, columns);
+        pool_file_name = samplesFileName + ".pool.samples";
+    }
+    samplesFileName += ".samples";
+    samples_file_name = samplesFileName;
+    checkpoint_file_name = samplesFileName + ".ckpt";
+    bool resumed = resume && restore_checkpoint();
+    FileSampleSink samplesFile(samplesFileName, out_format, compress_blocks, resumed);
+    SampleSinkList sink;
+    if (write_samples_file) {
+        sink.add(&samplesFile);
+    }
+    for (auto& extra : extra_sinks) {
+        sink.add(extra.get());
+    }
+    if (!sink.open(sample_columns())) {
         return;
     }
 
     if (mode == LS) {
 #ifdef LS_MODE
-        ls_sampling(samplesFile);
+        ls_sampling(sink);
 #endif
     } else if (mode == CDCL) {
 #ifdef CDCL_MODE
-        cdcl_sampling(samplesFile);
+        cdcl_sampling(sink);
 #endif
     } else if (mode == HYBRID) {
 #ifdef HYBRID_MODE
-        hybrid_sampling(samplesFile);
+        hybrid_sampling(sink);
+#endif
+    } else if (mode == SLS) {
+#ifdef SLS_MODE
+        sls_sampling(sink);
+#endif
+    } else if (mode == ADAPTIVE) {
+#ifdef ADAPTIVE_MODE
+        adaptive_sampling(sink);
+#endif
+    } else if (mode == HASH) {
+#ifdef HASH_MODE
+        hash_sampling(sink);
 #endif
     } else {
-        ls_iterative_sampling(samplesFile);
+        ls_iterative_sampling(sink);
     }
 
-    samplesFile.close();
+    if (checkpoint_sec > 0) {
+        write_checkpoint(sink);
+    }
+    sink.close();
+    if (pool) {
+        write_pool();
+    }
 
     print_statistic();
 }
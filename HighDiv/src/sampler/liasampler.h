@@ -1,14 +1,31 @@
 #pragma once
 
+#include <atomic>
+#include <limits>
 #include <map>
+#include <memory>
 #include <random>
 #include <string>
 #include <unordered_set>
+#include "checkpoint.h"
+#include "coverage.h"
+#include "diversepool.h"
+#include "enumerator.h"
+#include "hashcell.h"
+#include "modelexpander.h"
+#include "modeselect.h"
+#include "partition.h"
+#include "sampleformat.h"
+#include "samplesink.h"
 #include "sampler.h"
+#include "scheduler.h"
 
 #define LS_MODE
 #define CDCL_MODE
 #define HYBRID_MODE
+#define ADAPTIVE_MODE
+#define SLS_MODE
+#define HASH_MODE
 #define VERBOSE
 #define DEBUG
 
@@ -18,7 +35,11 @@ typedef enum {
     LS,
     CDCL,
     HYBRID,
-    LS_ITER
+    LS_ITER,
+    ADAPTIVE,
+    SLS,
+    HASH,
+    AUTO  // one of LS, CDCL, HYBRID, LS_ITER, chosen by the mode table
 } SamplingMode;
 
 struct Hash {
@@ -32,6 +53,37 @@ class LiaSampler : public Sampler {
     size_t num_samples = 0;
     size_t num_ls_samples = 0;
     size_t num_cdcl_samples = 0;
+    double time_first_sample = -1;  // seconds until the first unique sample
+    double ls_steps = 0;            // LS engine steps (CCSS steps / sls flips)
+    double ls_time = 0;             // seconds spent in LS checks
+    double ls_score_lookups = 0;    // CCSS move score cache lookups / hits
+    double ls_score_hits = 0;
+    size_t ls_pb_checks = 0;        // LS checks that ran the pseudo-Boolean flip search
+    size_t ls_idl_checks = 0;       // LS checks that scored moves on the difference logic edge list
+    double ls_build_time = 0;       // seconds spent building CCSS instances, and the largest instance (MB)
+    double ls_instance_mb_peak = 0;
+    size_t cdcl_checks = 0;         // satisfiable CDCL(T) checks and the new samples among their models,
+    size_t cdcl_unique_models = 0;  // the models of the other parallel workers included
+    size_t z3_alloc_peak = 0;       // bytes, polled on every unique sample
+    size_t partition_rejects = 0;   // samples outside this worker's hash bucket
+    bool track_coverage = false;
+    size_t coverage_plateau = 0;    // stop after this many unique samples without new coverage, 0: never
+    size_t samples_since_coverage = 0;
+    bool coverage_plateau_hit = false;
+    std::vector<CoveragePoint> coverage_timeline;  // at every power of two samples and at the end
+    double ls_covered_bits = 0;    // bit guided: bits of the LS variables seen both as 0 and as 1, of all their bits
+    double ls_coverable_bits = 0;
+    std::vector<CoveragePoint> bit_coverage_timeline;  // likewise, of the bit coverage
+    size_t pool_size = 0;              // 0: no diverse pool
+    double pool_checkpoint_sec = 60;   // the pool file is rewritten at this interval
+    double last_pool_write = 0;
+    std::string pool_file_name;
+    double checkpoint_sec = 0;  // 0: no checkpoints
+    bool resume = false;
+    double last_checkpoint = 0;
+    std::string samples_file_name;
+    std::string checkpoint_file_name;
+    std::map<std::string, std::string> guide_sample;  // last LS model, saved with the checkpoints
     SamplingMode mode = HYBRID;
     std::mt19937 mt;
     std::random_device rd;
@@ -40,6 +92,37 @@ class LiaSampler : public Sampler {
     std::unordered_set<__int128_t, Hash> unique_samples_hash_set;
     size_t cdcl_epoch = 1;
     double fixed_var_pct = 0.5;
+    bool keep_cdcl_epoch = false;  // set explicitly, kept by -m auto
+    bool keep_fixed_var_pct = false;
+    unsigned ls_timeout = 0;  // seconds per LS check, 0: the mode's default
+    ModeSelector mode_selector;
+    SampleFormat out_format = TEXT_FORMAT;
+    bool compress_blocks = false;
+    bool bit_guided = false;
+    unsigned candidate_clauses = 0;  // unsat clauses sampled per LS step, 0 scans all
+    bool score_cache = false;
+    unsigned warm_restart_pct = 0;  // lia vars re-drawn on an LS restart, 0: cold restarts
+    bool eliminate_equalities = false;
+    bool pb_fast_path = true;
+    bool idl_fast_path = true;
+    std::string ls_trace;  // file of the move trace of the first LS search, empty for none
+    bool cdcl_diversify = false;
+    size_t block_gc_interval = 1000;  // blocking clauses kept by the CDCL(T) enumerator before a collection
+    unsigned cdcl_threads = 1;        // > 1: parallel CDCL(T) checks returning the models of all workers
+    unsigned cdcl_thread_models = 0;  // models collected per parallel check
+    size_t parallel_models = 0;
+    size_t expand_k = 0;  // extra samples per CDCL(T) model
+    size_t hash_batch = 16;  // solutions per hash cell in the hash mode
+    std::unique_ptr<ModelExpander> model_expander;
+    std::unique_ptr<AdaptiveScheduler> scheduler;
+    std::unique_ptr<SolutionPartitioner> partitioner;
+    std::unique_ptr<DiversePool> pool;
+    std::unique_ptr<ProjectionEnumerator> enumerator;
+    std::unique_ptr<HashCellGenerator> cells;
+    std::unique_ptr<CoverageTracker> coverage;
+    std::vector<std::unique_ptr<SampleSink>> extra_sinks;  // fed next to the samples file
+    bool write_samples_file = true;
+    std::atomic<bool> stop_requested{false};
 
     double TimeElapsed();
     void print_statistic();
@@ -51,15 +134,106 @@ class LiaSampler : public Sampler {
     }
 
 
+    void set_output_format(SampleFormat _format, bool _compress) {
+        out_format = _format;
+        compress_blocks = _compress;
+    }
+
+    /* LS prefers moves covering value bits unseen in earlier samples */
+    void set_bit_guided(bool _bitGuided) { bit_guided = _bitGuided; }
+    /* every CDCL(T) model is expanded into up to k more samples with the same Boolean skeleton */
+    void set_model_expansion(size_t _k) { expand_k = _k; }
+    /* LS builds its move candidates from this many sampled unsat clauses per step, 0 scans all of them */
+    void set_candidate_clauses(unsigned _numClauses) { candidate_clauses = _numClauses; }
+    /* LS reuses a move score until a clause around the moved variable changes */
+    void set_score_cache(bool _scoreCache) { score_cache = _scoreCache; }
+    /* an LS restart re-draws only this percentage of the Int variables and keeps the clause weights */
+    void set_warm_restart(unsigned _pct) { warm_restart_pct = _pct; }
+    /* LS solves the unit Int equalities for unit-coefficient variables and searches over the rest */
+    void set_eliminate_equalities(bool _eliminate) { eliminate_equalities = _eliminate; }
+    /* LS runs the bit-packed flip search when every Int variable is 0/1 */
+    void set_pb_fast_path(bool _pbFastPath) { pb_fast_path = _pbFastPath; }
+    /* LS scores moves on an edge list when every Int literal is a difference x - y <= k */
+    void set_idl_fast_path(bool _idlFastPath) { idl_fast_path = _idlFastPath; }
+    /* bounds every LS check of the ls, sls, hybrid, 2ls and hash modes */
+    void set_ls_timeout(unsigned _seconds) { ls_timeout = _seconds; }
+    /* -m auto keeps the cdcl epoch and fixed var percentage given to the constructor instead of the table's */
+    void keep_mode_params(bool _cdclEpoch, bool _fixedVarPct) {
+        keep_cdcl_epoch = _cdclEpoch;
+        keep_fixed_var_pct = _fixedVarPct;
+    }
+    /* the mode table of -m auto, see modeselect.h; false if the file is missing or malformed */
+    bool set_mode_table(const std::string& _path) { return mode_selector.load(_path); }
+    /* smt.ls_trace: replay with test-z3 ls_sampler_replay <file> */
+    void set_ls_trace(const std::string& _path) { ls_trace = _path; }
+    /* the hash mode samples this many solutions from each random cell, which it sizes to hold about that many */
+    void set_hash_batch(size_t _batch) { hash_batch = _batch; }
+    /* the CDCL(T) solver redraws phases, activities and arithmetic values between consecutive checks */
+    void set_cdcl_diversify(bool _diversify) { cdcl_diversify = _diversify; }
+    /* the cdcl mode drops its blocking clauses and draws a new projection after this many */
+    void set_block_gc_interval(size_t _interval) { block_gc_interval = _interval; }
+    /* CDCL(T) checks run on this many threads and collect up to _models models from all of them */
+    void set_parallel_cdcl(unsigned _threads, unsigned _models) {
+        cdcl_threads = _threads;
+        cdcl_thread_models = _models;
+    }
+    /* every unique sample is also written to this sink, opened when sampling starts */
+    void add_sink(std::unique_ptr<SampleSink> _sink) { extra_sinks.push_back(std::move(_sink)); }
+    /* without the samples file, the samples only go to the added sinks */
+    void set_samples_file(bool _write) { write_samples_file = _write; }
+    /* ends sampling after the current sample, from any thread; a running check is interrupted */
+    void request_stop() {
+        stop_requested = true;
+        c.interrupt();
+    }
+    /* tracks the wire coverage of the samples; with a plateau, stops after that many samples without new coverage */
+    void set_coverage(bool _track, size_t _plateau) {
+        track_coverage = _track || _plateau > 0;
+        coverage_plateau = _plateau;
+    }
+    /* samples until the time limit and keeps the k most mutually distant ones, written every checkpoint_sec seconds and at the end */
+    void set_diverse_pool(size_t _k, double _checkpointSec) {
+        pool_size = _k;
+        pool_checkpoint_sec = _checkpointSec;
+        maxNumSamples = std::numeric_limits<unsigned>::max();
+    }
+    /* saves the sampling state every checkpoint_sec seconds; with resume, continues from the last checkpoint if there is one */
+    void set_checkpoint(double _checkpointSec, bool _resume) {
+        checkpoint_sec = _checkpointSec;
+        resume = _resume;
+    }
+    /* restricts sampling to this worker's part of the solution space, shared by all workers with the same num_workers */
+    void set_partition(PartitionMode _mode, unsigned _numWorkers, unsigned _worker) {
+        partitioner = std::make_unique<SolutionPartitioner>(c, _mode, _numWorkers, _worker);
+    }
+
     z3::tactic mk_preamble_tactic(z3::context& ctx);
+    z3::params mk_ls_params(unsigned default_timeout);
 
     void sampling() override;
-    void print_unique_sample(std::ofstream& samplesFile);
-    void ls_sampling(std::ofstream& samplesFile);
-    void cdcl_sampling(std::ofstream& samplesFile);
-    void hybrid_sampling(std::ofstream& samplesFile);
-    void ls_iterative_sampling(std::ofstream& samplesFile);
+    void select_mode();
+    bool print_unique_sample(SampleSink& sink);
+    void load_model(const z3::model& m);
+    size_t expand_cdcl_model(const z3::model& m, SampleSink& sink);
+    void set_cdcl_threads(z3::solver& cdcl_solver);
+    size_t take_parallel_models(const z3::solver& cdcl_solver, SampleSink& sink);
+    void fix_vars_from_model(const z3::model& m, double pct, std::uniform_real_distribution<double>& dist, z3::expr_vector& assertions);
+    std::vector<SampleColumn> sample_columns();
+    void update_coverage();
+    void write_pool();
+    void write_checkpoint(SampleSink& sink);
+    bool restore_checkpoint();
+    void remember_guide(const z3::model& m);
+    z3::model guide_model();
+    void ls_sampling(SampleSink& sink);
+    void cdcl_sampling(SampleSink& sink);
+    void hybrid_sampling(SampleSink& sink);
+    void ls_iterative_sampling(SampleSink& sink);
+    void adaptive_sampling(SampleSink& sink);
+    void sls_sampling(SampleSink& sink);
+    void hash_sampling(SampleSink& sink);
     unsigned gen_random_seed();
     void ls_sampling_core(z3::solver& ls_solver, const z3::goal& subgoal);
+    void read_bit_coverage(const z3::solver& ls_solver);
 };
 };  // namespace sampler
\ No newline at end of file
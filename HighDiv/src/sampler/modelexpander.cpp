@@ -0,0 +1,375 @@
+#include "modelexpander.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include "sampleformat.h"
+
+namespace sampler {
+
+// keeps every step small enough for a 64-bit uniform draw
+const __int128_t MAX_STEP = (__int128_t)1 << 40;
+
+static __int128_t floor_div(__int128_t a, __int128_t b) {
+    __int128_t q = a / b;
+    if (a % b != 0 && ((a < 0) != (b < 0)))
+        q--;
+    return q;
+}
+
+static __int128_t ceil_div(__int128_t a, __int128_t b) {
+    __int128_t q = a / b;
+    if (a % b != 0 && ((a < 0) == (b < 0)))
+        q++;
+    return q;
+}
+
+static __int128_t abs_128(__int128_t v) {
+    return v < 0 ? -v : v;
+}
+
+static __int128_t gcd_128(__int128_t a, __int128_t b) {
+    while (b != 0) {
+        __int128_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+std::string ModelExpander::to_string(__int128_t v) {
+    if (v == 0)
+        return "0";
+    bool neg = v < 0;
+    __uint128_t u = neg ? -(__uint128_t)v : (__uint128_t)v;
+    std::string s;
+    while (u > 0) {
+        s.push_back((char)('0' + (int)(u % 10)));
+        u /= 10;
+    }
+    if (neg)
+        s.push_back('-');
+    std::reverse(s.begin(), s.end());
+    return s;
+}
+
+ModelExpander::ModelExpander(z3::context& _c, const z3::expr& formula)
+    : c(_c) {
+    collect_atoms(formula);
+}
+
+int ModelExpander::var_index(const z3::expr& e) {
+    std::string name = e.decl().name().str();
+    auto it = name2var.find(name);
+    if (it != name2var.end())
+        return it->second;
+    int idx = (int)var_names.size();
+    name2var[name] = idx;
+    var_names.push_back(name);
+    var_exprs.push_back(e);
+    frozen.push_back(false);
+    return idx;
+}
+
+// numerals are also written as (- k)
+bool ModelExpander::get_numeral(const z3::expr& e, __int128_t& v) {
+    if (e.is_numeral()) {
+        v = string_to_int128(Z3_get_numeral_string(c, e));
+        return true;
+    }
+    if (e.is_app() && e.decl().decl_kind() == Z3_OP_UMINUS && get_numeral(e.arg(0), v)) {
+        v = -v;
+        return true;
+    }
+    return false;
+}
+
+bool ModelExpander::linearize(const z3::expr& root, __int128_t root_coeff, LinearAtom& a) {
+    std::vector<std::pair<z3::expr, __int128_t>> todo;
+    todo.push_back({root, root_coeff});
+    while (!todo.empty()) {
+        z3::expr e = todo.back().first;
+        __int128_t coeff = todo.back().second;
+        todo.pop_back();
+        if (!e.is_int())
+            return false;
+        __int128_t num;
+        if (get_numeral(e, num)) {
+            a.constant += coeff * num;
+            continue;
+        }
+        if (!e.is_app())
+            return false;
+        switch (e.decl().decl_kind()) {
+            case Z3_OP_UNINTERPRETED:
+                if (e.num_args() != 0)
+                    return false;
+                a.terms.push_back({var_index(e), coeff});
+                break;
+            case Z3_OP_ADD:
+                for (unsigned i = 0; i < e.num_args(); ++i)
+                    todo.push_back({e.arg(i), coeff});
+                break;
+            case Z3_OP_SUB:
+                for (unsigned i = 0; i < e.num_args(); ++i)
+                    todo.push_back({e.arg(i), i == 0 ? coeff : -coeff});
+                break;
+            case Z3_OP_UMINUS:
+                todo.push_back({e.arg(0), -coeff});
+                break;
+            case Z3_OP_MUL: {
+                __int128_t prod = coeff;
+                int non_num = -1;
+                for (unsigned i = 0; i < e.num_args(); ++i) {
+                    if (get_numeral(e.arg(i), num)) {
+                        prod *= num;
+                    } else if (non_num == -1) {
+                        non_num = (int)i;
+                    } else {
+                        return false;  // non-linear
+                    }
+                }
+                if (non_num == -1)
+                    a.constant += prod;
+                else
+                    todo.push_back({e.arg(non_num), prod});
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    // merge repeated variables
+    std::sort(a.terms.begin(), a.terms.end());
+    size_t j = 0;
+    for (size_t i = 0; i < a.terms.size(); ++i) {
+        if (j > 0 && a.terms[j - 1].first == a.terms[i].first)
+            a.terms[j - 1].second += a.terms[i].second;
+        else
+            a.terms[j++] = a.terms[i];
+    }
+    a.terms.resize(j);
+    a.terms.erase(std::remove_if(a.terms.begin(), a.terms.end(), [](const std::pair<int, __int128_t>& t) { return t.second == 0; }), a.terms.end());
+    return true;
+}
+
+void ModelExpander::freeze_vars(const z3::expr& root) {
+    std::unordered_set<unsigned> visited;
+    std::vector<z3::expr> todo;
+    todo.push_back(root);
+    while (!todo.empty()) {
+        z3::expr e = todo.back();
+        todo.pop_back();
+        if (!visited.insert(e.id()).second || !e.is_app())
+            continue;
+        if (e.is_const() && e.decl().decl_kind() == Z3_OP_UNINTERPRETED) {
+            if (e.is_int())
+                frozen[var_index(e)] = true;
+            continue;
+        }
+        for (unsigned i = 0; i < e.num_args(); ++i)
+            todo.push_back(e.arg(i));
+    }
+}
+
+void ModelExpander::collect_atoms(const z3::expr& formula) {
+    std::unordered_set<unsigned> visited;
+    std::vector<z3::expr> todo;
+    todo.push_back(formula);
+    while (!todo.empty()) {
+        z3::expr e = todo.back();
+        todo.pop_back();
+        if (!visited.insert(e.id()).second || !e.is_app())
+            continue;
+        Z3_decl_kind k = e.decl().decl_kind();
+        bool is_cmp = k == Z3_OP_LE || k == Z3_OP_GE || k == Z3_OP_LT || k == Z3_OP_GT || k == Z3_OP_EQ;
+        if (is_cmp && e.num_args() == 2 && e.arg(0).is_arith()) {
+            LinearAtom a{e, {}, 0, k};
+            if (linearize(e.arg(0), 1, a) && linearize(e.arg(1), -1, a)) {
+                atoms.push_back(a);
+            } else {
+                freeze_vars(e);
+            }
+        } else if (k == Z3_OP_DISTINCT && e.num_args() > 0 && e.arg(0).is_arith()) {
+            freeze_vars(e);
+        }
+        // Boolean atoms may still hide below (ite conditions)
+        for (unsigned i = 0; i < e.num_args(); ++i)
+            todo.push_back(e.arg(i));
+    }
+}
+
+size_t ModelExpander::num_movable_vars() const {
+    return std::count(frozen.begin(), frozen.end(), false);
+}
+
+// atom is "terms + constant (op) 0", turned into terms (kind) bound over integers
+void ModelExpander::add_constraint(const LinearAtom& a, bool positive) {
+    LinearConstraint lc;
+    lc.terms = a.terms;
+    lc.kind = LE_CONSTRAINT;
+    bool flip = false;  // use -terms <= bound
+    switch (a.op) {
+        case Z3_OP_LE:
+            lc.bound = positive ? -a.constant : a.constant - 1;
+            flip = !positive;
+            break;
+        case Z3_OP_LT:
+            lc.bound = positive ? -a.constant - 1 : a.constant;
+            flip = !positive;
+            break;
+        case Z3_OP_GE:
+            lc.bound = positive ? a.constant : -a.constant - 1;
+            flip = positive;
+            break;
+        case Z3_OP_GT:
+            lc.bound = positive ? a.constant - 1 : -a.constant;
+            flip = positive;
+            break;
+        default:  // Z3_OP_EQ
+            lc.bound = -a.constant;
+            lc.kind = positive ? EQ_CONSTRAINT : NE_CONSTRAINT;
+            break;
+    }
+    if (flip) {
+        for (auto& t : lc.terms)
+            t.second = -t.second;
+    }
+    lc.lhs = 0;
+    for (auto& t : lc.terms)
+        lc.lhs += t.second * values[t.first];
+
+    int idx = (int)constraints.size();
+    constraints.push_back(lc);
+    for (auto& t : lc.terms)
+        occs[t.first].push_back(idx);
+    if (lc.kind == EQ_CONSTRAINT && lc.terms.size() >= 2)
+        equalities.push_back(idx);
+}
+
+bool ModelExpander::line_move(const std::vector<std::pair<int, __int128_t>>& dir, std::mt19937& mt) {
+    __int128_t width = 16;
+    for (auto& d : dir) {
+        if (frozen[d.first])
+            return false;
+        width = std::max(width, 16 + abs_128(values[d.first]));
+    }
+    width = std::min(width, MAX_STEP);
+    __int128_t lo = -width, hi = width;
+
+    // slope of every touched constraint along dir
+    std::vector<std::pair<int, __int128_t>> touched;
+    curr_stamp++;
+    for (auto& d : dir) {
+        for (int ci : occs[d.first]) {
+            if (stamp[ci] == curr_stamp)
+                continue;
+            stamp[ci] = curr_stamp;
+            const LinearConstraint& lc = constraints[ci];
+            __int128_t s = 0;
+            for (auto& dd : dir)
+                for (auto& t : lc.terms)
+                    if (t.first == dd.first)
+                        s += t.second * dd.second;
+            if (s == 0)
+                continue;
+            __int128_t r = lc.bound - lc.lhs;
+            if (lc.kind == EQ_CONSTRAINT)
+                return false;
+            if (lc.kind == LE_CONSTRAINT) {
+                if (s > 0)
+                    hi = std::min(hi, floor_div(r, s));
+                else
+                    lo = std::max(lo, ceil_div(r, s));
+            }
+            touched.push_back({ci, s});
+        }
+    }
+    if (lo > hi)
+        return false;
+
+    std::uniform_int_distribution<int64_t> dist((int64_t)lo, (int64_t)hi);
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        __int128_t step = dist(mt);
+        if (step == 0)
+            continue;
+        bool excluded = false;
+        for (auto& p : touched) {
+            const LinearConstraint& lc = constraints[p.first];
+            if (lc.kind == NE_CONSTRAINT && lc.lhs + p.second * step == lc.bound) {
+                excluded = true;
+                break;
+            }
+        }
+        if (excluded)
+            continue;
+        for (auto& d : dir)
+            values[d.first] += d.second * step;
+        for (auto& p : touched)
+            constraints[p.first].lhs += p.second * step;
+        return true;
+    }
+    return false;
+}
+
+size_t ModelExpander::expand(const z3::model& m, size_t k, std::mt19937& mt, const std::function<void(const std::vector<__int128_t>&)>& emit) {
+    size_t num_vars = var_names.size();
+    values.assign(num_vars, 0);
+    for (size_t v = 0; v < num_vars; ++v) {
+        z3::expr val = m.eval(var_exprs[v], true);
+        if (!val.is_numeral())
+            return 0;
+        values[v] = string_to_int128(Z3_get_numeral_string(c, val));
+    }
+
+    constraints.clear();
+    equalities.clear();
+    occs.assign(num_vars, {});
+    for (const LinearAtom& a : atoms) {
+        add_constraint(a, m.eval(a.atom, true).is_true());
+    }
+    // the model must lie inside the polyhedron it defines, otherwise give up
+    for (const LinearConstraint& lc : constraints) {
+        if ((lc.kind == LE_CONSTRAINT && lc.lhs > lc.bound) || (lc.kind == EQ_CONSTRAINT && lc.lhs != lc.bound) || (lc.kind == NE_CONSTRAINT && lc.lhs == lc.bound))
+            return 0;
+    }
+    stamp.assign(constraints.size(), 0);
+    curr_stamp = 0;
+
+    std::vector<int> movable;
+    for (size_t v = 0; v < num_vars; ++v)
+        if (!frozen[v] && !occs[v].empty())
+            movable.push_back((int)v);
+    if (movable.empty())
+        return 0;
+
+    size_t emitted = 0;
+    std::vector<std::pair<int, __int128_t>> dir;
+    for (size_t s = 0; s < k; ++s) {
+        bool moved = false;
+        for (size_t step = 0; step < movable.size(); ++step) {
+            dir.clear();
+            if (!equalities.empty() && mt() % 2 == 0) {
+                // move two variables of an equality along its kernel
+                const LinearConstraint& eq = constraints[equalities[mt() % equalities.size()]];
+                size_t i = mt() % eq.terms.size();
+                size_t j = mt() % (eq.terms.size() - 1);
+                if (j >= i)
+                    j++;
+                __int128_t ai = eq.terms[i].second, aj = eq.terms[j].second;
+                __int128_t g = gcd_128(abs_128(ai), abs_128(aj));
+                dir.push_back({eq.terms[i].first, aj / g});
+                dir.push_back({eq.terms[j].first, -ai / g});
+            } else {
+                dir.push_back({movable[mt() % movable.size()], 1});
+            }
+            moved = line_move(dir, mt) || moved;
+        }
+        if (!moved)
+            break;
+        emit(values);
+        emitted++;
+    }
+    return emitted;
+}
+
+}  // namespace sampler
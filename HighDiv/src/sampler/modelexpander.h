@@ -0,0 +1,83 @@
+#pragma once
+
+#include <z3++.h>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+    Expands one CDCL(T) model into many samples.
+
+    The truth value of every arithmetic atom is taken from the model and kept
+    fixed, so the Boolean skeleton, and with it the formula, stays satisfied.
+    What remains is a polyhedron of integer points: sum a_i x_i <= b, = b and
+    != b constraints.  The expander walks it with integer line moves (a single
+    variable, or a pair of variables of an equality moved along its kernel),
+    choosing the step inside the range allowed by every touched constraint, so
+    each visited point is feasible and no repair is needed.
+
+    Atoms that are not linear over Int constants (ite, div, mod, non-linear
+    products, distinct, ...) freeze all variables they contain.
+*/
+
+namespace sampler {
+
+class ModelExpander {
+    typedef enum {
+        LE_CONSTRAINT,
+        EQ_CONSTRAINT,
+        NE_CONSTRAINT
+    } ConstraintKind;
+
+    struct LinearAtom {
+        z3::expr atom;
+        std::vector<std::pair<int, __int128_t>> terms;  // var index, coefficient
+        __int128_t constant = 0;                        // terms + constant (op) 0
+        Z3_decl_kind op;
+    };
+
+    struct LinearConstraint {
+        std::vector<std::pair<int, __int128_t>> terms;
+        __int128_t bound;  // terms (kind) bound
+        ConstraintKind kind;
+        __int128_t lhs;  // current value of terms
+    };
+
+    z3::context& c;
+    std::vector<std::string> var_names;
+    std::vector<z3::expr> var_exprs;
+    std::map<std::string, int> name2var;
+    std::vector<bool> frozen;
+    std::vector<LinearAtom> atoms;
+
+    // rebuilt for every model
+    std::vector<LinearConstraint> constraints;
+    std::vector<std::vector<int>> occs;  // var -> constraints
+    std::vector<int> equalities;
+    std::vector<__int128_t> values;
+    std::vector<unsigned> stamp;
+    unsigned curr_stamp = 0;
+
+    int var_index(const z3::expr& e);
+    bool get_numeral(const z3::expr& e, __int128_t& v);
+    bool linearize(const z3::expr& e, __int128_t coeff, LinearAtom& a);
+    void freeze_vars(const z3::expr& e);
+    void collect_atoms(const z3::expr& formula);
+    void add_constraint(const LinearAtom& a, bool positive);
+    bool line_move(const std::vector<std::pair<int, __int128_t>>& dir, std::mt19937& mt);
+
+   public:
+    ModelExpander(z3::context& _c, const z3::expr& formula);
+
+    const std::vector<std::string>& get_var_names() const { return var_names; }
+    size_t num_movable_vars() const;
+
+    /* calls emit with the values of get_var_names() for up to k points reached from m */
+    size_t expand(const z3::model& m, size_t k, std::mt19937& mt, const std::function<void(const std::vector<__int128_t>&)>& emit);
+
+    static std::string to_string(__int128_t v);
+};
+
+}  // namespace sampler
@@ -0,0 +1,85 @@
+#include "modeselect.h"
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace sampler {
+
+// learned by my_scripts/learn_mode_table.py from 30 s runs (seed 1) of ls, cdcl, 2ls and hybrid with
+// -e 1 / 4 and -p 0.2 / 0.5 / 0.8 on the LIA_bench instances, by unique samples per minute
+ModeSelector::ModeSelector() {
+    table.push_back({"idl-m-small-flat", ModeChoice{"ls", 1, 0.5, 50}});    // bofill
+    table.push_back({"lia-m-big-skewed", ModeChoice{"cdcl", 1, 0.5, 60}});  // convert
+    table.push_back({"lia-m-small-flat", ModeChoice{"ls", 1, 0.5, 50}});    // slacks
+    table.push_back({"lia-s-big-flat", ModeChoice{"hybrid", 4, 0.5, 60}});  // prime-cone
+    table.push_back({"lia-s-small-flat", ModeChoice{"ls", 1, 0.5, 50}});    // Bromberger, dillig
+    table.push_back({"pb-l-small-skewed", ModeChoice{"ls", 1, 0.5, 50}});   // pb2010
+    table.push_back({"*", ModeChoice{"ls", 1, 0.5, 50}});
+}
+
+bool ModeSelector::matches(const std::string& pattern, const std::string& cls, unsigned& wildcards) {
+    std::istringstream p(pattern), c(cls);
+    std::string pp, cp;
+    wildcards = 0;
+    if (pattern == "*") {
+        wildcards = std::numeric_limits<unsigned>::max();  // below any partial pattern
+        return true;
+    }
+    while (std::getline(p, pp, '-')) {
+        if (!std::getline(c, cp, '-')) {
+            return false;
+        }
+        if (pp == "*") {
+            wildcards++;
+        } else if (pp != cp) {
+            return false;
+        }
+    }
+    return !std::getline(c, cp, '-');
+}
+
+bool ModeSelector::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::vector<std::pair<std::string, ModeChoice>> rows;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string cls;
+        if (!(fields >> cls)) {
+            continue;  // blank or comment line
+        }
+        ModeChoice choice;
+        if (!(fields >> choice.mode >> choice.cdcl_epoch >> choice.fixed_var_pct >> choice.ls_timeout) ||
+            (choice.mode != "ls" && choice.mode != "cdcl" && choice.mode != "hybrid" && choice.mode != "2ls") ||
+            choice.cdcl_epoch == 0 || choice.fixed_var_pct < 0 || choice.fixed_var_pct > 1 || choice.ls_timeout == 0) {
+            std::cerr << "Malformed mode table row in " << path << ": " << line << std::endl;
+            return false;
+        }
+        rows.push_back({cls, choice});
+    }
+    if (rows.empty()) {
+        return false;
+    }
+    table.swap(rows);
+    return true;
+}
+
+ModeChoice ModeSelector::select(const FormulaFeatures& f) const {
+    std::string cls = f.class_name();
+    const ModeChoice* best = nullptr;
+    unsigned best_wildcards = 0;
+    for (auto& [pattern, choice] : table) {
+        unsigned wildcards;
+        if (matches(pattern, cls, wildcards) && (!best || wildcards < best_wildcards)) {
+            best = &choice;
+            best_wildcards = wildcards;
+        }
+    }
+    return best ? *best : ModeChoice{"hybrid", 1, 0.5, 60};
+}
+
+}  // namespace sampler
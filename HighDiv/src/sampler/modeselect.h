@@ -0,0 +1,47 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "formulafeatures.h"
+
+/*
+    Automatic choice of the sampling mode and its parameters (-m auto).
+
+    A mode table maps formula classes (FormulaFeatures::class_name) to the
+    configuration that gave the most unique samples per second on the
+    benchmarks of that class.  my_scripts/learn_mode_table.py builds it from
+    benchmark runs of the candidate configurations.  One row per line:
+
+        <class> <mode> <cdcl_epoch> <fixed_var_pct> <ls_timeout>
+
+    where every '-'-separated part of <class> may be '*'.  A formula takes
+    the matching row with the fewest wildcards, the first one on a tie.
+    Without a table file, the built-in table learned from the LIA_bench
+    instances is used (see modeselect.cpp); other classes run ls.  Explicit
+    -e, -p and --ls-timeout values win over the table.
+*/
+
+namespace sampler {
+
+struct ModeChoice {
+    std::string mode;  // ls, cdcl, hybrid or 2ls
+    size_t cdcl_epoch = 1;
+    double fixed_var_pct = 0.5;
+    unsigned ls_timeout = 60;  // seconds
+};
+
+class ModeSelector {
+    std::vector<std::pair<std::string, ModeChoice>> table;
+
+    static bool matches(const std::string& pattern, const std::string& cls, unsigned& wildcards);
+
+   public:
+    ModeSelector();
+
+    /* replaces the table with the rows of this file; false, with the table unchanged, if a row is malformed */
+    bool load(const std::string& path);
+    ModeChoice select(const FormulaFeatures& f) const;
+};
+
+}  // namespace sampler
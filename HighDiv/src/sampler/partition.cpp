@@ -0,0 +1,146 @@
+#include "partition.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_set>
+
+namespace sampler {
+
+SolutionPartitioner::SolutionPartitioner(z3::context& _c, PartitionMode _mode, unsigned _numWorkers, unsigned _worker)
+    : c(_c), mode(_mode), num_workers(std::max(_numWorkers, 1U)), worker(_worker % std::max(_numWorkers, 1U)) {
+    hash_buckets = num_workers;
+    hash_bucket = worker;
+}
+
+// Int constants by the number of distinct terms they are a direct argument of, ties by name
+void SolutionPartitioner::order_candidates(const z3::expr& formula, std::vector<z3::expr>& candidates) {
+    std::map<std::string, std::pair<unsigned, unsigned>> occs;  // name -> (count, index in candidates)
+    std::unordered_set<unsigned> visited;
+    std::vector<z3::expr> todo;
+    todo.push_back(formula);
+    while (!todo.empty()) {
+        z3::expr e = todo.back();
+        todo.pop_back();
+        if (!visited.insert(e.id()).second || !e.is_app() || e.is_const())
+            continue;
+        for (unsigned i = 0; i < e.num_args(); ++i) {
+            z3::expr a = e.arg(i);
+            if (a.is_const() && a.decl().decl_kind() == Z3_OP_UNINTERPRETED && a.is_int()) {
+                auto it = occs.find(a.decl().name().str());
+                if (it == occs.end()) {
+                    occs[a.decl().name().str()] = {1, (unsigned)candidates.size()};
+                    candidates.push_back(a);
+                } else {
+                    it->second.first++;
+                }
+            } else {
+                todo.push_back(a);
+            }
+        }
+    }
+    std::vector<std::pair<std::pair<unsigned, std::string>, unsigned>> order;
+    for (auto& [name, occ] : occs) {
+        order.push_back({{occ.first, name}, occ.second});
+    }
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        return a.first.first != b.first.first ? a.first.first > b.first.first : a.first.second < b.first.second;
+    });
+    std::vector<z3::expr> sorted;
+    for (auto& o : order) {
+        sorted.push_back(candidates[o.second]);
+    }
+    candidates.swap(sorted);
+}
+
+bool SolutionPartitioner::var_range(const z3::expr& formula, const z3::expr& x, bool& has_lo, int64_t& lo, bool& has_hi, int64_t& hi) {
+    z3::optimize opt(c);
+    z3::params p(c);
+    p.set("priority", c.str_symbol("box"));
+    p.set("rlimit", range_rlimit);
+    opt.set(p);
+    opt.add(formula);
+    z3::optimize::handle h_lo = opt.minimize(x);
+    z3::optimize::handle h_hi = opt.maximize(x);
+    if (opt.check() != z3::sat) {
+        return false;
+    }
+    has_lo = opt.lower(h_lo).is_numeral_i64(lo);
+    has_hi = opt.upper(h_hi).is_numeral_i64(hi);
+    return true;
+}
+
+z3::expr SolutionPartitioner::build_cube(const z3::expr& formula) {
+    z3::expr cube = c.bool_val(true);
+    if (mode == HASH_PARTITION) {
+        return cube;
+    }
+
+    std::vector<z3::expr> candidates;
+    order_candidates(formula, candidates);
+    std::vector<bool> used(candidates.size(), false);
+
+    unsigned n = num_workers, idx = worker;
+    while (n > 1) {
+        unsigned n_left = n / 2;
+        bool split = false;
+        unsigned tried = 0;
+        for (size_t i = 0; i < candidates.size() && tried < max_candidates && !split; ++i) {
+            if (used[i]) {
+                continue;
+            }
+            tried++;
+            bool has_lo, has_hi;
+            int64_t lo = 0, hi = 0;
+            if (!var_range(formula && cube, candidates[i], has_lo, lo, has_hi, hi) || (has_lo && has_hi && lo == hi)) {
+                used[i] = true;  // out of budget or fixed inside the cube
+                continue;
+            }
+            // both sides of the pivot stay non-empty: bounds are attained and an unbounded side is never empty
+            int64_t pivot;
+            if (has_lo && has_hi) {
+                pivot = (int64_t)(lo + ((__int128_t)hi - lo) * n_left / n);
+            } else if (has_lo) {
+                pivot = lo;
+            } else if (has_hi) {
+                pivot = hi - 1;
+            } else {
+                pivot = 0;
+            }
+            used[i] = true;
+            split = true;
+            z3::expr x = candidates[i];
+            if (idx < n_left) {
+                cube = cube && x <= c.int_val(pivot);
+                cube_lits.push_back(x.to_string() + " <= " + std::to_string(pivot));
+                n = n_left;
+            } else {
+                cube = cube && x > c.int_val(pivot);
+                cube_lits.push_back(x.to_string() + " > " + std::to_string(pivot));
+                idx -= n_left;
+                n -= n_left;
+            }
+        }
+        if (!split) {
+            break;
+        }
+    }
+    hash_buckets = n;
+    hash_bucket = idx;
+    return cube;
+}
+
+void SolutionPartitioner::print_statistic(std::ostream& os) const {
+    os << "Partition worker " << worker << " of " << num_workers << (mode == CUBE_PARTITION ? ", cube:" : ", hash buckets only");
+    for (const std::string& l : cube_lits) {
+        os << " (" << l << ")";
+    }
+    if (mode == CUBE_PARTITION && cube_lits.empty()) {
+        os << " true";
+    }
+    os << "\n";
+    if (hash_buckets > 1) {
+        os << "Partition hash bucket: " << hash_bucket << " of " << hash_buckets << "\n";
+    }
+}
+
+}  // namespace sampler
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <z3++.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+    Splits the solution space between workers sampling the same formula.
+
+    In cube mode the workers are halved recursively: the range [lo, hi] of an
+    Int variable is computed under the cube built so far, and the variable is
+    split at a pivot proportional to the sizes of the two worker groups, so
+    every cube stays satisfiable.  Candidates are the Int variables with the
+    most distinct parent terms in the formula, tried in that order.  Ranges
+    are computed with a resource limit instead of a timeout, so sibling workers
+    on different machines agree on every pivot and their cubes are disjoint.
+
+    Workers the cube cannot separate (no splittable candidate left), and all
+    workers in hash mode, keep only the samples whose hash falls in their
+    bucket.  The cube is conjoined to the formula, so CDCL(T), LS and the
+    model expander all stay inside it.
+*/
+
+namespace sampler {
+
+typedef enum {
+    CUBE_PARTITION,
+    HASH_PARTITION
+} PartitionMode;
+
+class SolutionPartitioner {
+    z3::context& c;
+    PartitionMode mode;
+    unsigned num_workers;
+    unsigned worker;
+    unsigned hash_buckets;  // workers sharing this worker's cube
+    unsigned hash_bucket;
+    std::vector<std::string> cube_lits;
+
+    static const unsigned max_candidates = 8;   // per split
+    static const unsigned range_rlimit = 5000000;
+
+    void order_candidates(const z3::expr& formula, std::vector<z3::expr>& candidates);
+    bool var_range(const z3::expr& formula, const z3::expr& x, bool& has_lo, int64_t& lo, bool& has_hi, int64_t& hi);
+
+   public:
+    SolutionPartitioner(z3::context& _c, PartitionMode _mode, unsigned _numWorkers, unsigned _worker);
+
+    /* the constraint restricting formula to this worker's region, true in hash mode */
+    z3::expr build_cube(const z3::expr& formula);
+    /* whether a sample with this hash belongs to this worker */
+    bool owns(__int128_t hash) const { return hash_buckets <= 1 || (unsigned)((__uint128_t)hash % hash_buckets) == hash_bucket; }
+
+    unsigned get_worker() const { return worker; }
+    void print_statistic(std::ostream& os) const;
+};
+
+}  // namespace sampler
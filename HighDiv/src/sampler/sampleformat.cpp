@@ -0,0 +1,301 @@
+#include "sampleformat.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace sampler {
+
+__int128_t string_to_int128(const std::string& str) {
+    if (str == "false") return 0;
+    if (str == "true") return 1;
+    __int128_t result = 0;
+    bool is_negative = false;
+    size_t start_idx = 0;
+
+    if (str[0] == '-') {
+        is_negative = true;
+        start_idx = 1;
+    }
+
+    // 逐字符处理字符串并转换为数字
+    for (size_t i = start_idx; i < str.size(); ++i) {
+        char c = str[i];
+        if (c < '0' || c > '9') {
+            throw std::invalid_argument("Invalid character in the string");
+        }
+        result = result * 10 + (c - '0');
+    }
+
+    if (is_negative) {
+        result = -result;
+    }
+
+    return result;
+}
+
+void put_varint(std::string& out, __uint128_t v) {
+    while (v >= 0x80) {
+        out.push_back((char)((uint8_t)v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)(uint8_t)v);
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, __uint128_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 128; shift += 7) {
+        uint8_t b = *p++;
+        v |= (__uint128_t)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void put_columns(std::string& out, const std::vector<SampleColumn>& columns) {
+    put_varint(out, columns.size());
+    for (const SampleColumn& col : columns) {
+        out.push_back(col.sort);
+        put_varint(out, col.name.size());
+        out += col.name;
+    }
+}
+
+bool get_columns(const uint8_t*& p, const uint8_t* end, std::vector<SampleColumn>& columns) {
+    __uint128_t ncols;
+    if (!get_varint(p, end, ncols)) {
+        return false;
+    }
+    columns.resize((size_t)ncols);
+    for (SampleColumn& col : columns) {
+        __uint128_t len;
+        if (p >= end) {
+            return false;
+        }
+        col.sort = (char)*p++;
+        if (!get_varint(p, end, len) || (size_t)(end - p) < len) {
+            return false;
+        }
+        col.name.assign((const char*)p, (size_t)len);
+        p += len;
+    }
+    return true;
+}
+
+// a zero byte is followed by the varint length of the zero run it stands for
+void zero_run_compress(const std::string& in, std::string& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < in.size()) {
+        if (in[i] != 0) {
+            out.push_back(in[i++]);
+            continue;
+        }
+        size_t run = 0;
+        while (i < in.size() && in[i] == 0) {
+            run++;
+            i++;
+        }
+        out.push_back(0);
+        put_varint(out, run);
+    }
+}
+
+bool zero_run_decompress(const uint8_t* p, const uint8_t* end, std::string& out) {
+    out.clear();
+    while (p < end) {
+        if (*p != 0) {
+            out.push_back((char)*p++);
+            continue;
+        }
+        p++;
+        __uint128_t run;
+        if (!get_varint(p, end, run)) {
+            return false;
+        }
+        out.append((size_t)run, '\0');
+    }
+    return true;
+}
+
+BinarySampleWriter::BinarySampleWriter(std::ofstream& _out, const std::vector<SampleColumn>& _columns, bool _compress, size_t _blockCapacity)
+    : out(_out), columns(_columns), block_capacity(_blockCapacity), compress(_compress) {
+    prev.resize(columns.size(), 0);
+}
+
+BinarySampleWriter::~BinarySampleWriter() {
+    close();
+}
+
+void BinarySampleWriter::write_header() {
+    std::string header(SAMPLE_FORMAT_MAGIC, sizeof(SAMPLE_FORMAT_MAGIC));
+    header.push_back((char)SAMPLE_FORMAT_VERSION);
+    header.push_back((char)(compress ? SAMPLE_FLAG_COMPRESSED : 0));
+    put_columns(header, columns);
+    out.write(header.data(), header.size());
+}
+
+void BinarySampleWriter::write_sample(const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) {
+    // columns and the sample map are both sorted by name, walk them together
+    auto it = sample.begin();
+    size_t val_idx = 0;
+    for (size_t c = 0; c < columns.size(); ++c) {
+        while (it != sample.end() && it->first < columns[c].name) {
+            ++it;
+            ++val_idx;
+        }
+        __int128_t v = 0;
+        if (it != sample.end() && it->first == columns[c].name) {
+            v = values[val_idx];
+        }
+        // wrap-around difference, decoded with the same modular arithmetic
+        __int128_t diff = (__int128_t)((__uint128_t)v - (__uint128_t)prev[c]);
+        put_varint(block, zigzag_encode(diff));
+        prev[c] = v;
+    }
+    if (++block_samples >= block_capacity) {
+        flush_block();
+    }
+}
+
+void BinarySampleWriter::flush_block() {
+    if (block_samples == 0) {
+        return;
+    }
+    std::string head;
+    put_varint(head, block_samples);
+    const std::string* payload = &block;
+    if (compress) {
+        zero_run_compress(block, packed);
+        payload = &packed;
+        head.push_back((char)SAMPLE_CODEC_ZERO_RUN);
+    } else {
+        head.push_back((char)SAMPLE_CODEC_RAW);
+    }
+    put_varint(head, payload->size());
+    out.write(head.data(), head.size());
+    out.write(payload->data(), payload->size());
+    out.flush();
+
+    block.clear();
+    block_samples = 0;
+    std::fill(prev.begin(), prev.end(), 0);
+}
+
+void BinarySampleWriter::close() {
+    flush_block();
+}
+
+bool BinarySampleReader::open(const std::string& path) {
+    in.open(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    char magic[4];
+    in.read(magic, sizeof(magic));
+    if (!in || memcmp(magic, SAMPLE_FORMAT_MAGIC, sizeof(magic)) != 0) {
+        return false;
+    }
+    int version = in.get();
+    int flags = in.get();
+    if (version != SAMPLE_FORMAT_VERSION || flags == EOF) {
+        return false;
+    }
+
+    // the header is small, read it byte-wise through a varint buffer
+    auto read_varint = [&](__uint128_t& v) {
+        std::string buf;
+        int b;
+        do {
+            b = in.get();
+            if (b == EOF) {
+                return false;
+            }
+            buf.push_back((char)b);
+        } while (b & 0x80);
+        const uint8_t* p = (const uint8_t*)buf.data();
+        return get_varint(p, p + buf.size(), v);
+    };
+
+    __uint128_t ncols;
+    if (!read_varint(ncols)) {
+        return false;
+    }
+    columns.resize((size_t)ncols);
+    for (SampleColumn& col : columns) {
+        __uint128_t len;
+        col.sort = (char)in.get();
+        if (!read_varint(len)) {
+            return false;
+        }
+        col.name.resize((size_t)len);
+        in.read(&col.name[0], (std::streamsize)len);
+    }
+    prev.resize(columns.size(), 0);
+    return (bool)in;
+}
+
+bool BinarySampleReader::load_block() {
+    std::string head;
+    int b;
+    __uint128_t nsamples, payload_len;
+    auto read_varint = [&](__uint128_t& v) {
+        head.clear();
+        do {
+            b = in.get();
+            if (b == EOF) {
+                return false;
+            }
+            head.push_back((char)b);
+        } while (b & 0x80);
+        const uint8_t* p = (const uint8_t*)head.data();
+        return get_varint(p, p + head.size(), v);
+    };
+    if (!read_varint(nsamples)) {
+        return false;
+    }
+    int codec = in.get();
+    if (codec == EOF || !read_varint(payload_len)) {
+        return false;
+    }
+    std::string payload((size_t)payload_len, '\0');
+    in.read(&payload[0], (std::streamsize)payload_len);
+    if (!in) {
+        return false;
+    }
+    if (codec == SAMPLE_CODEC_ZERO_RUN) {
+        const uint8_t* p = (const uint8_t*)payload.data();
+        if (!zero_run_decompress(p, p + payload.size(), block)) {
+            return false;
+        }
+    } else {
+        block.swap(payload);
+    }
+    cursor = (const uint8_t*)block.data();
+    block_end = cursor + block.size();
+    block_left = (size_t)nsamples;
+    std::fill(prev.begin(), prev.end(), 0);
+    return true;
+}
+
+bool BinarySampleReader::next(std::vector<__int128_t>& values) {
+    while (block_left == 0) {
+        if (!load_block()) {
+            return false;
+        }
+    }
+    values.resize(columns.size());
+    for (size_t c = 0; c < columns.size(); ++c) {
+        __uint128_t zz;
+        if (!get_varint(cursor, block_end, zz)) {
+            return false;
+        }
+        prev[c] = (__int128_t)((__uint128_t)prev[c] + (__uint128_t)zigzag_decode(zz));
+        values[c] = prev[c];
+    }
+    block_left--;
+    return true;
+}
+
+}  // namespace sampler
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+    Columnar binary sample format ("HDSB").
+
+    magic    : 4 bytes "HDSB"
+    version  : 1 byte
+    flags    : 1 byte, bit 0 = zero-run block compression
+    ncols    : varint
+    columns  : ncols x { sort: 1 byte ('I' int, 'B' bool), name_len: varint, name }
+    blocks   : { nsamples: varint, codec: 1 byte, payload_len: varint, payload }*
+
+    Inside a block every sample stores one zigzag varint per column, holding the
+    difference to the same column of the previous sample in the block (the first
+    sample of a block is stored against zero), so blocks decode independently.
+*/
+
+namespace sampler {
+
+typedef enum {
+    TEXT_FORMAT,
+    BINARY_FORMAT
+} SampleFormat;
+
+struct SampleColumn {
+    std::string name;
+    char sort;  // 'I' int, 'B' bool
+};
+
+const char SAMPLE_FORMAT_MAGIC[4] = {'H', 'D', 'S', 'B'};
+const uint8_t SAMPLE_FORMAT_VERSION = 1;
+const uint8_t SAMPLE_FLAG_COMPRESSED = 1;
+const uint8_t SAMPLE_CODEC_RAW = 0;
+const uint8_t SAMPLE_CODEC_ZERO_RUN = 1;
+
+/* value of a model string: a decimal integer, true (1) or false (0) */
+__int128_t string_to_int128(const std::string& str);
+
+/* varint / zigzag helpers */
+void put_varint(std::string& out, __uint128_t v);
+bool get_varint(const uint8_t*& p, const uint8_t* end, __uint128_t& v);
+inline __uint128_t zigzag_encode(__int128_t v) {
+    return ((__uint128_t)v << 1) ^ (__uint128_t)(v >> 127);
+}
+inline __int128_t zigzag_decode(__uint128_t v) {
+    return (__int128_t)(v >> 1) ^ -(__int128_t)(v & 1);
+}
+/* column table of the header: ncols, then sort, name_len, name per column */
+void put_columns(std::string& out, const std::vector<SampleColumn>& columns);
+bool get_columns(const uint8_t*& p, const uint8_t* end, std::vector<SampleColumn>& columns);
+void zero_run_compress(const std::string& in, std::string& out);
+bool zero_run_decompress(const uint8_t* p, const uint8_t* end, std::string& out);
+
+class BinarySampleWriter {
+    std::ofstream& out;
+    std::vector<SampleColumn> columns;
+    std::vector<__int128_t> prev;
+    std::string block;
+    std::string packed;
+    size_t block_samples = 0;
+    size_t block_capacity;
+    bool compress;
+
+    void flush_block();
+
+   public:
+    BinarySampleWriter(std::ofstream& _out, const std::vector<SampleColumn>& _columns, bool _compress, size_t _blockCapacity = 256);
+    ~BinarySampleWriter();
+
+    void write_header();
+    /* sample: name -> value, sorted by name like the columns; missing columns are written as 0 */
+    void write_sample(const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values);
+    void close();
+};
+
+class BinarySampleReader {
+    std::ifstream in;
+    std::vector<SampleColumn> columns;
+    std::vector<__int128_t> prev;
+    std::string block;
+    const uint8_t* cursor = nullptr;
+    const uint8_t* block_end = nullptr;
+    size_t block_left = 0;
+
+    bool load_block();
+
+   public:
+    bool open(const std::string& path);
+    const std::vector<SampleColumn>& get_columns() const { return columns; }
+    /* read the next sample into values (one entry per column); false at end of file */
+    bool next(std::vector<__int128_t>& values);
+};
+
+}  // namespace sampler
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <iostream>
 #include <unordered_set>
+#include "formulafeatures.h"
 
 // #define PRINT_PROGRESS
 // #define SHOW_PROGRESS_BAR
@@ -20,20 +21,15 @@ class Sampler {
 
     z3::context& c;
     z3::expr original_formula;
+    bool formula_given = false;  // set_formula was called, parseSmtFile keeps it
+    std::ostream log_stream{std::cout.rdbuf()};  // progress and statistics
+
+    /* uninterpreted Int/Bool constants of the formula, collected without recursion */
+    void collect_formula_consts(std::vector<z3::func_decl>& consts);
 
    private:
-    // formula statistic
-    int num_arrays = 0, num_bv = 0, num_bools = 0, num_bits = 0, num_uf = 0,
-        num_ints = 0, num_reals = 0;
-    std::vector<z3::func_decl> variables;          // function declarations in formulas
-    std::vector<std::string> variable_names;       // used for model Record the names of the variables in the model (excluding uninterpreted functions)
-    std::unordered_set<std::string> var_names = {  // variable names in formulas
-        "bv", "Int", "true",
-        "false"};       // initialize with constant names so that
-                        // constants are not mistaken for variables
-    int max_depth = 0;  // AST max depth
-    bool has_arrays = false;         // whether the formula contains an array
-    std::unordered_set<Z3_ast> sup;  // bat: nodes (=leaves?) independent Support Set?
+    FormulaFeatures features;
+    bool has_features = false;
     std::string result = "unknown";  // success/failure
 
 public:
@@ -47,9 +43,16 @@ public:
 
     virtual void sampling() = 0;
     void parseSmtFile();
+    /* samples this formula of the sampler's context instead of the smt file */
+    void set_formula(const z3::expr& formula) {
+        original_formula = formula;
+        formula_given = true;
+    }
+    /* sends the progress and statistics output to this buffer, nullptr discards it */
+    void set_log(std::streambuf* buf) { log_stream.rdbuf(buf); }
     
-    /* formula statistic */
-    void _compute_formula_stats_aux(z3::expr e, int depth = 0);
+    /* formula statistic, extracted on the first call */
+    const FormulaFeatures& formula_features();
     void safe_exit(int exitcode);
 
     /* util */
@@ -0,0 +1,312 @@
+#include "samplesink.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace sampler {
+
+bool SampleSinkList::open(const std::vector<SampleColumn>& columns) {
+    for (SampleSink* sink : sinks) {
+        if (!sink->open(columns)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SampleSinkList::write_sample(size_t idx, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) {
+    for (SampleSink* sink : sinks) {
+        sink->write_sample(idx, sample, values);
+    }
+}
+
+void SampleSinkList::flush() {
+    for (SampleSink* sink : sinks) {
+        sink->flush();
+    }
+}
+
+void SampleSinkList::close() {
+    for (SampleSink* sink : sinks) {
+        sink->close();
+    }
+}
+
+bool FileSampleSink::open(const std::vector<SampleColumn>& columns) {
+    std::ios::openmode open_mode = format == BINARY_FORMAT ? std::ios::out | std::ios::binary : std::ios::out;
+    if (append) {
+        open_mode |= std::ios::app;
+    }
+    out.open(path, open_mode);
+    if (!out) {
+        std::cerr << "Unable to open file " << path << std::endl;
+        return false;
+    }
+    if (format == BINARY_FORMAT) {
+        bin_writer = std::make_unique<BinarySampleWriter>(out, columns, compress);
+        if (!append) {
+            bin_writer->write_header();
+        }
+    }
+    return true;
+}
+
+void FileSampleSink::write_sample(size_t idx, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) {
+    if (bin_writer) {
+        bin_writer->write_sample(sample, values);
+        return;
+    }
+    out << idx << ": ";
+    for (auto& p : sample) {
+        out << p.first << ":" << p.second << ";";
+    }
+    out << "\n";
+}
+
+void FileSampleSink::flush() {
+    if (bin_writer) {
+        bin_writer->close();  // ends the current block, the writer stays usable
+    }
+    out.flush();
+}
+
+void FileSampleSink::close() {
+    flush();
+    bin_writer.reset();
+    out.close();
+}
+
+bool StreamSampleSink::open(const std::vector<SampleColumn>& columns) {
+    std::string target = path;
+    if (path == "-") {
+        int fd = dup(STDOUT_FILENO);
+        if (fd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+            std::cerr << "Unable to move the log off stdout" << std::endl;
+            return false;
+        }
+        target = "/dev/fd/" + std::to_string(fd);
+    }
+    signal(SIGPIPE, SIG_IGN);  // a consumer leaving ends the stream, not the sampler
+    out.open(target, std::ios::out | std::ios::binary);
+    if (!out) {
+        std::cerr << "Unable to open the sample stream " << path << std::endl;
+        return false;
+    }
+    bin_writer = std::make_unique<BinarySampleWriter>(out, columns, false, 1);
+    bin_writer->write_header();
+    return true;
+}
+
+void StreamSampleSink::write_sample(size_t /*idx*/, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) {
+    if (bin_writer && out) {
+        bin_writer->write_sample(sample, values);
+    }
+}
+
+void StreamSampleSink::close() {
+    bin_writer.reset();
+    out.close();
+}
+
+// a zigzag varint of 128 bits takes at most 19 bytes
+static const size_t MAX_VARINT_BYTES = 19;
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+ShmRingSampleSink::~ShmRingSampleSink() {
+    close();
+}
+
+bool ShmRingSampleSink::open(const std::vector<SampleColumn>& _columns) {
+    columns = _columns;
+    std::string table;
+    put_columns(table, columns);
+    size_t slot_stride = align8(sizeof(ShmRingSlot) + std::max(columns.size(), (size_t)1) * MAX_VARINT_BYTES);
+    size_t slots_offset = align8(sizeof(ShmRingHeader) + table.size());
+    size = slots_offset + slot_stride * num_slots;
+
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, (off_t)size) != 0) {
+        std::cerr << "Unable to create the shared memory ring " << name << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "Unable to map the shared memory ring " << name << std::endl;
+        return false;
+    }
+    base = (uint8_t*)p;
+    header = new (base) ShmRingHeader;
+    header->num_written.store(0, std::memory_order_relaxed);
+    header->closed.store(0, std::memory_order_relaxed);
+    memcpy(base + sizeof(ShmRingHeader), table.data(), table.size());
+    slots = base + slots_offset;
+    for (uint32_t i = 0; i < num_slots; ++i) {
+        ShmRingSlot* slot = new (slots + (size_t)i * slot_stride) ShmRingSlot;
+        slot->seq.store(0, std::memory_order_relaxed);
+        slot->len = 0;
+    }
+    header->version = SHM_RING_VERSION;
+    header->num_slots = num_slots;
+    header->slot_stride = (uint32_t)slot_stride;
+    header->columns_bytes = (uint32_t)table.size();
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(header->magic, SHM_RING_MAGIC, sizeof(SHM_RING_MAGIC));  // readers check the magic last
+    return true;
+}
+
+void ShmRingSampleSink::write_sample(size_t /*idx*/, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) {
+    if (!header) {
+        return;
+    }
+    // same walk as BinarySampleWriter::write_sample, without the delta to the previous sample
+    payload.clear();
+    auto it = sample.begin();
+    size_t val_idx = 0;
+    for (const SampleColumn& col : columns) {
+        while (it != sample.end() && it->first < col.name) {
+            ++it;
+            ++val_idx;
+        }
+        __int128_t v = it != sample.end() && it->first == col.name ? values[val_idx] : 0;
+        put_varint(payload, zigzag_encode(v));
+    }
+
+    uint64_t n = header->num_written.load(std::memory_order_relaxed);
+    ShmRingSlot* slot = (ShmRingSlot*)(slots + (size_t)(n % header->num_slots) * header->slot_stride);
+    slot->seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->len = (uint32_t)payload.size();
+    memcpy((uint8_t*)slot + sizeof(ShmRingSlot), payload.data(), payload.size());
+    slot->seq.store(2 * n + 2, std::memory_order_release);
+    header->num_written.store(n + 1, std::memory_order_release);
+}
+
+void ShmRingSampleSink::close() {
+    if (!base) {
+        return;
+    }
+    header->closed.store(1, std::memory_order_release);
+    munmap(base, size);
+    base = nullptr;
+    header = nullptr;
+}
+
+ShmRingReader::~ShmRingReader() {
+    if (base) {
+        munmap((void*)base, size);
+    }
+}
+
+bool ShmRingReader::open(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmRingHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size = (size_t)st.st_size;
+    void* p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    base = (const uint8_t*)p;
+    header = (const ShmRingHeader*)base;
+    if (memcmp(header->magic, SHM_RING_MAGIC, sizeof(SHM_RING_MAGIC)) != 0 || header->version != SHM_RING_VERSION) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint8_t* q = base + sizeof(ShmRingHeader);
+    if (!sampler::get_columns(q, q + header->columns_bytes, columns)) {
+        return false;
+    }
+    slots = base + align8(sizeof(ShmRingHeader) + header->columns_bytes);
+    cursor = 0;
+    return true;
+}
+
+ShmRingStatus ShmRingReader::next(std::vector<__int128_t>& values) {
+    while (true) {
+        bool closed = header->closed.load(std::memory_order_acquire);
+        uint64_t written = header->num_written.load(std::memory_order_acquire);
+        if (cursor >= written) {
+            return closed ? SHM_RING_CLOSED : SHM_RING_EMPTY;
+        }
+        if (written - cursor > header->num_slots) {  // overwritten before we got there
+            num_lost += written - header->num_slots - cursor;
+            cursor = written - header->num_slots;
+        }
+        const ShmRingSlot* slot = (const ShmRingSlot*)(slots + (size_t)(cursor % header->num_slots) * header->slot_stride);
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        if (seq == 2 * cursor + 2) {
+            uint32_t len = std::min(slot->len, header->slot_stride - (uint32_t)sizeof(ShmRingSlot));
+            payload.assign((const char*)slot + sizeof(ShmRingSlot), len);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->seq.load(std::memory_order_relaxed) == seq) {
+                const uint8_t* p = (const uint8_t*)payload.data();
+                const uint8_t* end = p + payload.size();
+                values.resize(columns.size());
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    __uint128_t zz = 0;
+                    get_varint(p, end, zz);
+                    values[c] = zigzag_decode(zz);
+                }
+                cursor++;
+                return SHM_RING_SAMPLE;
+            }
+        }
+        num_lost++;  // the slot is being reused by a later sample
+        cursor++;
+    }
+}
+
+void ShmRingReader::remove(const std::string& name) {
+    shm_unlink(name.c_str());
+}
+
+std::unique_ptr<SampleSink> make_sample_sink(const std::string& spec) {
+    if (spec == "stdout") {
+        return std::make_unique<StreamSampleSink>("-");
+    }
+    if (spec.rfind("fifo:", 0) == 0 && spec.size() > 5) {
+        return std::make_unique<StreamSampleSink>(spec.substr(5));
+    }
+    if (spec.rfind("shm:", 0) == 0 && spec.size() > 4) {
+        std::string name = spec.substr(4);
+        uint32_t num_slots = 4096;
+        size_t colon = name.find(':');
+        if (colon != std::string::npos) {
+            int n = atoi(name.c_str() + colon + 1);
+            if (n <= 0) {
+                return nullptr;
+            }
+            num_slots = (uint32_t)n;
+            name = name.substr(0, colon);
+        }
+        if (name.empty() || name[0] != '/') {
+            name = "/" + name;  // shm_open names start with a slash
+        }
+        return std::make_unique<ShmRingSampleSink>(name, num_slots);
+    }
+    return nullptr;
+}
+
+}  // namespace sampler
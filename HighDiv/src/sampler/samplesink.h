@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sampleformat.h"
+
+/*
+    Destinations of the unique samples.
+
+    print_unique_sample hands every unique sample to a SampleSink; sampling()
+    passes a SampleSinkList of the samples file and of the sinks added to the
+    sampler, so test executors can consume samples while they are generated:
+
+    - FileSampleSink: the samples file, in the text or the HDSB format;
+    - CallbackSampleSink: a C++ function, called on the sampling thread;
+    - StreamSampleSink: the HDSB format on stdout or a FIFO, one block per
+      sample so that BinarySampleReader decodes each one as it is written;
+    - ShmRingSampleSink: a shared-memory ring of fixed-size slots with one
+      producer and any number of consumers (ShmRingReader), each with its
+      own cursor.  The producer never waits: a consumer that falls more than
+      a ring behind loses the overwritten samples and is told how many.
+
+    Every sink gets the column dictionary of the formula before the first
+    sample; a sample is its name -> value map together with the values of
+    the map in the same order (see BinarySampleWriter::write_sample).
+*/
+
+namespace sampler {
+
+class SampleSink {
+   public:
+    virtual ~SampleSink() {}
+    /* columns sorted by name; false if the sink cannot be used */
+    virtual bool open(const std::vector<SampleColumn>& /*columns*/) { return true; }
+    /* idx: number of unique samples before this one */
+    virtual void write_sample(size_t idx, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) = 0;
+    /* makes every sample written so far visible to the consumer */
+    virtual void flush() {}
+    virtual void close() { flush(); }
+};
+
+class SampleSinkList : public SampleSink {
+    std::vector<SampleSink*> sinks;
+
+   public:
+    void add(SampleSink* sink) { sinks.push_back(sink); }
+    bool open(const std::vector<SampleColumn>& columns) override;
+    void write_sample(size_t idx, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) override;
+    void flush() override;
+    void close() override;
+};
+
+class FileSampleSink : public SampleSink {
+    std::string path;
+    SampleFormat format;
+    bool compress;
+    bool append;  // continue the file of a checkpoint
+    std::ofstream out;
+    std::unique_ptr<BinarySampleWriter> bin_writer;
+
+   public:
+    FileSampleSink(const std::string& _path, SampleFormat _format, bool _compress, bool _append)
+        : path(_path), format(_format), compress(_compress), append(_append) {}
+
+    bool open(const std::vector<SampleColumn>& columns) override;
+    void write_sample(size_t idx, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) override;
+    void flush() override;
+    void close() override;
+};
+
+class CallbackSampleSink : public SampleSink {
+    std::function<void(size_t, const std::map<std::string, std::string>&)> callback;
+
+   public:
+    CallbackSampleSink(std::function<void(size_t, const std::map<std::string, std::string>&)> _callback) : callback(std::move(_callback)) {}
+
+    void write_sample(size_t idx, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& /*values*/) override {
+        callback(idx, sample);
+    }
+};
+
+class StreamSampleSink : public SampleSink {
+    std::string path;  // "-" for stdout
+    std::ofstream out;
+    std::unique_ptr<BinarySampleWriter> bin_writer;
+
+   public:
+    StreamSampleSink(const std::string& _path) : path(_path) {}
+
+    /* opening a FIFO waits for its reader; on stdout, the log of the sampler moves to stderr */
+    bool open(const std::vector<SampleColumn>& columns) override;
+    void write_sample(size_t idx, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) override;
+    void close() override;
+};
+
+/*
+    Shared memory object layout: ShmRingHeader, the column table (put_columns),
+    then num_slots slots of slot_stride bytes, each a ShmRingSlot followed by
+    the sample as one zigzag varint per column.  Sample n goes to slot
+    n % num_slots, whose seq is 2n + 1 while it is written and 2n + 2 after.
+*/
+const char SHM_RING_MAGIC[4] = {'H', 'D', 'S', 'R'};
+const uint32_t SHM_RING_VERSION = 1;
+
+struct ShmRingHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t num_slots;
+    uint32_t slot_stride;
+    uint32_t columns_bytes;
+    std::atomic<uint64_t> num_written;
+    std::atomic<uint32_t> closed;
+};
+
+struct ShmRingSlot {
+    std::atomic<uint64_t> seq;
+    uint32_t len;
+};
+
+class ShmRingSampleSink : public SampleSink {
+    std::string name;
+    uint32_t num_slots;
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    ShmRingHeader* header = nullptr;
+    uint8_t* slots = nullptr;
+    std::vector<SampleColumn> columns;
+    std::string payload;
+
+   public:
+    ShmRingSampleSink(const std::string& _name, uint32_t _numSlots) : name(_name), num_slots(_numSlots) {}
+    ~ShmRingSampleSink();
+
+    /* (re)creates the shared memory object, which stays after close for late consumers */
+    bool open(const std::vector<SampleColumn>& columns) override;
+    void write_sample(size_t idx, const std::map<std::string, std::string>& sample, const std::vector<__int128_t>& values) override;
+    void close() override;
+};
+
+typedef enum {
+    SHM_RING_SAMPLE,
+    SHM_RING_EMPTY,  // nothing new yet
+    SHM_RING_CLOSED  // nothing new and the producer has finished
+} ShmRingStatus;
+
+class ShmRingReader {
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    const ShmRingHeader* header = nullptr;
+    const uint8_t* slots = nullptr;
+    std::vector<SampleColumn> columns;
+    std::string payload;
+    uint64_t cursor = 0;
+    uint64_t num_lost = 0;
+
+   public:
+    ~ShmRingReader();
+
+    bool open(const std::string& name);
+    const std::vector<SampleColumn>& get_columns() const { return columns; }
+    /* the next sample not yet read by this reader, one value per column */
+    ShmRingStatus next(std::vector<__int128_t>& values);
+    /* samples overwritten before this reader got to them */
+    uint64_t lost() const { return num_lost; }
+
+    static void remove(const std::string& name);
+};
+
+/* stdout, fifo:<path> or shm:<name>[:<slots>]; nullptr for an unknown spec */
+std::unique_ptr<SampleSink> make_sample_sink(const std::string& spec);
+
+}  // namespace sampler
@@ -0,0 +1,66 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sampler {
+
+AdaptiveScheduler::AdaptiveScheduler(unsigned _cdclTimeoutMs, unsigned _lsTimeoutMs, double _exploration)
+    : exploration(_exploration) {
+    init_timeout_ms[CDCL_SOURCE] = timeout_ms[CDCL_SOURCE] = _cdclTimeoutMs;
+    init_timeout_ms[LS_SOURCE] = timeout_ms[LS_SOURCE] = _lsTimeoutMs;
+    // ls_timeout is given to the solver in whole seconds
+    min_timeout_ms[CDCL_SOURCE] = std::min(_cdclTimeoutMs, 500U);
+    min_timeout_ms[LS_SOURCE] = std::min(_lsTimeoutMs, 1000U);
+}
+
+size_t AdaptiveScheduler::select() {
+    double best_rate = 0.0;
+    for (size_t i = 0; i < arms.size(); ++i) {
+        if (arms[i].pulls == 0) {
+            return i;
+        }
+        best_rate = std::max(best_rate, arms[i].rate());
+    }
+
+    size_t best = 0;
+    double best_score = -1.0;
+    double log_pulls = std::log((double)total_pulls);
+    for (size_t i = 0; i < arms.size(); ++i) {
+        double mean = best_rate > 0 ? arms[i].rate() / best_rate : 0.0;
+        double score = mean + exploration * std::sqrt(2.0 * log_pulls / arms[i].pulls);
+        if (score > best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+void AdaptiveScheduler::update(size_t idx, double seconds, size_t unique, size_t duplicates, bool timeout) {
+    SchedulerArm& arm = arms[idx];
+    arm.pulls++;
+    arm.time += seconds;
+    arm.unique += unique;
+    arm.duplicates += duplicates;
+    total_pulls++;
+
+    unsigned& t = timeout_ms[arm.source];
+    if (timeout) {
+        arm.timeouts++;
+        t = std::max(t / 2, min_timeout_ms[arm.source]);
+    } else if (unique + duplicates > 0) {
+        t = std::min(t + t / 2, init_timeout_ms[arm.source]);
+    }
+}
+
+void AdaptiveScheduler::print_statistic(std::ostream& os) const {
+    os << "Scheduler arms (source, fixed pct, pulls, unique, duplicates, timeouts, time, unique/s):\n";
+    for (const SchedulerArm& arm : arms) {
+        os << "  " << (arm.source == CDCL_SOURCE ? "CDCL" : "LS  ") << " "
+           << arm.fixed_var_pct << " " << arm.pulls << " " << arm.unique << " "
+           << arm.duplicates << " " << arm.timeouts << " " << arm.time << " " << arm.rate() << "\n";
+    }
+}
+
+}  // namespace sampler
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+/*
+    Adaptive time allocation for the hybrid sampler.
+
+    Every arm is a sample source (stochastic CDCL(T) with a given percentage of
+    variables fixed from the last LS model, or local search).  An arm is chosen
+    with UCB1 on its unique samples per second, normalised by the best observed
+    rate.  Each source keeps its own per-call timeout, halved on every timeout
+    and grown back towards the initial value once the source succeeds again.
+*/
+
+namespace sampler {
+
+typedef enum {
+    CDCL_SOURCE,
+    LS_SOURCE
+} SampleSource;
+
+struct SchedulerArm {
+    SampleSource source;
+    double fixed_var_pct;  // only used by CDCL_SOURCE
+    size_t pulls = 0;
+    size_t unique = 0;
+    size_t duplicates = 0;
+    size_t timeouts = 0;
+    double time = 0.0;  // seconds spent in this arm
+
+    SchedulerArm(SampleSource _source, double _fixedVarPct)
+        : source(_source), fixed_var_pct(_fixedVarPct) {}
+
+    double rate() const { return time > 0 ? unique / time : 0.0; }
+};
+
+class AdaptiveScheduler {
+    std::vector<SchedulerArm> arms;
+    size_t total_pulls = 0;
+    double exploration;
+    unsigned init_timeout_ms[2];
+    unsigned timeout_ms[2];
+    unsigned min_timeout_ms[2];
+
+   public:
+    AdaptiveScheduler(unsigned _cdclTimeoutMs, unsigned _lsTimeoutMs, double _exploration = 0.5);
+
+    void add_arm(SampleSource source, double fixed_var_pct = 0.0) { arms.emplace_back(source, fixed_var_pct); }
+    const std::vector<SchedulerArm>& get_arms() const { return arms; }
+    const SchedulerArm& get_arm(size_t idx) const { return arms[idx]; }
+
+    /* index of the arm to run next, untried arms first */
+    size_t select();
+    /* account one call: elapsed seconds, unique/duplicate samples it produced, whether it timed out */
+    void update(size_t idx, double seconds, size_t unique, size_t duplicates, bool timeout);
+
+    unsigned get_timeout_ms(SampleSource source) const { return timeout_ms[source]; }
+
+    void print_statistic(std::ostream& os) const;
+};
+
+}  // namespace sampler
@@ -718,6 +718,38 @@ extern "C" {
         Z3_CATCH_RETURN(nullptr);
     }
 
+    unsigned Z3_API Z3_solver_get_num_sampled_models(Z3_context c, Z3_solver s) {
+        Z3_TRY;
+        LOG_Z3_solver_get_num_sampled_models(c, s);
+        RESET_ERROR_CODE();
+        init_solver(c, s);
+        vector<model_ref> models;
+        to_solver_ref(s)->get_sampled_models(models);
+        return models.size();
+        Z3_CATCH_RETURN(0);
+    }
+
+    Z3_model Z3_API Z3_solver_get_sampled_model(Z3_context c, Z3_solver s, unsigned i) {
+        Z3_TRY;
+        LOG_Z3_solver_get_sampled_model(c, s, i);
+        RESET_ERROR_CODE();
+        init_solver(c, s);
+        vector<model_ref> models;
+        to_solver_ref(s)->get_sampled_models(models);
+        if (i >= models.size()) {
+            SET_ERROR_CODE(Z3_IOB, nullptr);
+            RETURN_Z3(nullptr);
+        }
+        model_ref _m = models[i];
+        model_params mp(to_solver_ref(s)->get_params());
+        if (mp.compact()) _m->compress();
+        Z3_model_ref * m_ref = alloc(Z3_model_ref, *mk_c(c));
+        m_ref->m_model = _m;
+        mk_c(c)->save_object(m_ref);
+        RETURN_Z3(of_model(m_ref));
+        Z3_CATCH_RETURN(nullptr);
+    }
+
     Z3_ast Z3_API Z3_solver_get_proof(Z3_context c, Z3_solver s) {
         Z3_TRY;
         LOG_Z3_solver_get_proof(c, s);
@@ -2843,6 +2843,9 @@ namespace z3 {
             return to_check_result(r);
         }
         model get_model() const { Z3_model m = Z3_solver_get_model(ctx(), m_solver); check_error(); return model(ctx(), m); }
+        /* models of the workers of the last parallel check besides get_model(), see smt.threads.sample_models */
+        unsigned num_sampled_models() const { unsigned r = Z3_solver_get_num_sampled_models(ctx(), m_solver); check_error(); return r; }
+        model sampled_model(unsigned i) const { Z3_model m = Z3_solver_get_sampled_model(ctx(), m_solver, i); check_error(); return model(ctx(), m); }
         check_result consequences(expr_vector& assumptions, expr_vector& vars, expr_vector& conseq) {
             Z3_lbool r = Z3_solver_get_consequences(ctx(), m_solver, assumptions, vars, conseq);
             check_error();
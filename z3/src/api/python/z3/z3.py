@@ -7255,6 +7255,14 @@ class Solver(Z3PPObject):
         except Z3Exception:
             raise Z3Exception("model is not available")
 
+    def sampled_models(self):
+        """Return the models the workers of the last parallel `check()` found besides `model()`.
+
+        Models are collected when `threads` is greater than 1 and `threads.sample_models` is set.
+        """
+        n = Z3_solver_get_num_sampled_models(self.ctx.ref(), self.solver)
+        return [ModelRef(Z3_solver_get_sampled_model(self.ctx.ref(), self.solver, i), self.ctx) for i in range(n)]
+
     def import_model_converter(self, other):
         """Import model converter from other into the current solver"""
         Z3_solver_import_model_converter(self.ctx.ref(), other.solver, self.solver)
@@ -7384,6 +7384,29 @@ extern "C" {
     */
     Z3_model Z3_API Z3_solver_get_model(Z3_context c, Z3_solver s);
 
+    /**
+       \brief Return the number of models collected by the last #Z3_solver_check or #Z3_solver_check_assumptions
+       besides the one of #Z3_solver_get_model.
+
+       Models are collected by a parallel check (parameter \c smt.threads greater than 1) when the parameter
+       \c smt.threads.sample_models is set: the workers keep searching after a model until that many models
+       were found or \c smt.threads.sample_timeout milliseconds passed.
+
+       \sa Z3_solver_get_sampled_model
+
+       def_API('Z3_solver_get_num_sampled_models', UINT, (_in(CONTEXT), _in(SOLVER)))
+    */
+    unsigned Z3_API Z3_solver_get_num_sampled_models(Z3_context c, Z3_solver s);
+
+    /**
+       \brief Retrieve the \c i-th model collected by the last check, see #Z3_solver_get_num_sampled_models.
+
+       \pre i < Z3_solver_get_num_sampled_models(c, s)
+
+       def_API('Z3_solver_get_sampled_model', MODEL, (_in(CONTEXT), _in(SOLVER), _in(UINT)))
+    */
+    Z3_model Z3_API Z3_solver_get_sampled_model(Z3_context c, Z3_solver s, unsigned i);
+
     /**
        \brief Retrieve the proof for the last #Z3_solver_check or #Z3_solver_check_assumptions
 
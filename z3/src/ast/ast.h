@@ -1456,6 +1456,7 @@ enum proof_gen_mode {
 class ast_manager {
 public:
     std::unordered_map<std::string, std::string> last_CDCL_model;
+    std::unordered_map<std::string, std::pair<__uint128_t, __uint128_t>> ls_seen_bits;  // bit coverage of ls samples, see sampler::seen_bits_map
 
     friend class basic_decl_plugin;
 protected:
@@ -42,6 +42,8 @@ namespace sls {
         m_repair_down(m.get_num_asts(), m_gd),
         m_repair_up(m.get_num_asts(), m_ld),
         m_constraint_trail(m),
+        m_initial_vars(m),
+        m_initial_values(m),
         m_todo(m) {
     }
 
@@ -609,6 +611,8 @@ namespace sls {
         for (auto p : m_plugins)
             if (p)
                 p->initialize();
+        for (unsigned i = 0; i < m_initial_vars.size(); ++i)
+            set_value(m_initial_vars.get(i), m_initial_values.get(i));
     }
 
     void context::register_terms(expr* e) {
@@ -135,6 +135,7 @@ namespace sls {
         heap<less_depth> m_repair_up;  
         uint_set m_constraint_ids;
         expr_ref_vector m_constraint_trail;
+        expr_ref_vector m_initial_vars, m_initial_values;
         stats m_stats;
 
         void register_plugin(plugin* p);
@@ -174,6 +175,8 @@ namespace sls {
         void on_restart();
         void updt_params(params_ref const& p);
         params_ref const& get_params() const { return m_params;  }
+        // values assigned once the plugins are initialized, e.g. taken from a CDCL model
+        void set_initial_value(expr* e, expr* v) { m_initial_vars.push_back(e); m_initial_values.push_back(v); }
 
         // expose sat_solver to plugins
         vector<sat::clause_info> const& clauses() const { return s.clauses(); }
@@ -19,6 +19,7 @@ Author:
 #include "ast/sls/sat_ddfw.h"
 #include "ast/sls/sls_smt_solver.h"
 #include "ast/ast_ll_pp.h"
+#include "params/sls_params.hpp"
 
 
 namespace sls {
@@ -129,8 +130,11 @@ namespace sls {
 
         void updt_params(params_ref const& p) {
             m_ddfw.updt_params(p);
+            m_ddfw.set_seed(sls_params(p).random_seed());
             m_context.updt_params(p);
         }
+
+        void set_initial_value(expr* var, expr* value) { m_context.set_initial_value(var, value); }
     };
 
     smt_solver::smt_solver(ast_manager& m, params_ref const& p):
@@ -143,6 +147,14 @@ namespace sls {
     
     smt_solver::~smt_solver() {        
     }
+
+    void smt_solver::updt_params(params_ref const& p) {
+        m_solver_ctx->updt_params(p);
+    }
+
+    void smt_solver::set_initial_value(expr* var, expr* value) {
+        m_solver_ctx->set_initial_value(var, value);
+    }
     
     void smt_solver::assert_expr(expr* e) {
         if (m.is_and(e)) {
@@ -1,113 +1,133 @@
 #ifndef _SAMPLE_BIT_SET_H
 #define _SAMPLE_BIT_SET_H
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <vector>
 #include "util/debug.h"
 
+namespace sampler {
+
 const size_t bit_width = 128;
 
+// one var takes 128 bits, stored as two 64-bit words so the bulk kernels are word-wide popcounts over a flat array
 class SampleBitSet {
    private:
-    __int128_t* arr;  // one var take 128 bit
-    size_t siz;
-
-    int countOnes(__uint128_t num) {
-        int count = 0;
-        while (num != 0) {
-            count += num & 1;
-            num >>= 1;  // Use logical right shift
-        }
-        return count;
-    }
+    std::vector<uint64_t> words;
+    size_t siz = 0;
 
    public:
-    SampleBitSet()
-        : siz(0) {
-        arr = nullptr;
+    static inline int popcount128(__uint128_t num) {
+        return __builtin_popcountll((uint64_t)num) + __builtin_popcountll((uint64_t)(num >> 64));
     }
-    SampleBitSet(const std::vector<__int128_t>& _arr, size_t _siz)
-        : siz(_siz) {
-        arr = new __int128_t[siz];
-        for (size_t i = 0; i < siz; ++i) {
-            arr[i] = _arr[i];
-        }
+
+    SampleBitSet() {}
+    SampleBitSet(const std::vector<__int128_t>& _arr, size_t _siz) {
+        update_arr(_arr, _siz);
     }
-    SampleBitSet(size_t _siz)
-        : siz(_siz) {
-        arr = new __int128_t[siz]{0};
+    SampleBitSet(size_t _siz) {
+        resize(_siz);
     }
-    SampleBitSet(size_t _siz, __int128_t val)
-        : siz(_siz) {
-        arr = new __int128_t[siz];
+    SampleBitSet(size_t _siz, __int128_t val) {
+        resize(_siz);
         for (size_t i = 0; i < siz; ++i) {
-            arr[i] = val;
+            set_var(i, (__uint128_t)val);
         }
     }
-    SampleBitSet(const SampleBitSet& bs)
-        : siz(bs.siz) {
-        arr = new __int128_t[bs.siz]{0};
-        memcpy(arr, bs.arr, sizeof(__int128_t) * siz);
-    }
-    ~SampleBitSet() {
-        delete[] arr;
-    }
-    SampleBitSet& operator=(const SampleBitSet& bs) {
-        if (this == &bs)
-            return *this;
-        delete[] arr;
-        siz = bs.siz;
-        arr = new __int128_t[siz]{0};
-        memcpy(arr, bs.arr, sizeof(__int128_t) * siz);
-        return *this;
+
+    size_t size() const { return siz; }
+
+    // clears all bits, the storage is only reallocated when it has to grow
+    void resize(size_t _siz) {
+        siz = _siz;
+        words.assign(2 * siz, 0);
     }
+
     SampleBitSet operator^(const SampleBitSet& bs) const {
         SASSERT(this->siz == bs.siz);
         SampleBitSet res(this->siz);
-        for (size_t i = 0; i < this->siz; ++i) {
-            res.arr[i] = this->arr[i] ^ bs.arr[i];
+        for (size_t i = 0; i < words.size(); ++i) {
+            res.words[i] = words[i] ^ bs.words[i];
         }
         return res;
     }
     bool update_arr(const std::vector<__int128_t>& _arr, size_t _siz) {
-        delete[] arr;
-        arr = new __int128_t[siz];
+        if (_arr.size() < _siz) {
+            return false;
+        }
+        siz = _siz;
+        words.resize(2 * siz);
         for (size_t i = 0; i < siz; ++i) {
-            arr[i] = _arr[i];
+            set_var(i, (__uint128_t)_arr[i]);
         }
+        return true;
     }
     bool set(size_t var_idx, size_t bit_idx) {
-        __int128_t& t1 = arr[var_idx];
-        __int128_t cg = (__int128_t(1) << bit_idx);
-        if ((t1 & cg) == __int128_t(0)) {
-            t1 |= cg;
+        uint64_t& w = words[2 * var_idx + bit_idx / 64];
+        uint64_t cg = uint64_t(1) << (bit_idx % 64);
+        if ((w & cg) == 0) {
+            w |= cg;
             return true;
         }
         return false;
     }
     bool unset(size_t var_idx, size_t bit_idx) {
-        __int128_t& t1 = arr[var_idx];
-        __int128_t cg = (__int128_t(1) << bit_idx);
-        if ((t1 & cg) != 0u) {
-            t1 ^= cg;
+        uint64_t& w = words[2 * var_idx + bit_idx / 64];
+        uint64_t cg = uint64_t(1) << (bit_idx % 64);
+        if ((w & cg) != 0) {
+            w ^= cg;
             return true;
         }
         return false;
     }
-    bool get(size_t var_idx, size_t bit_idx) {
-        return (arr[var_idx] & (__int128_t(1) << bit_idx)) != __int128_t(0);
+    bool get(size_t var_idx, size_t bit_idx) const {
+        return (words[2 * var_idx + bit_idx / 64] >> (bit_idx % 64)) & 1;
+    }
+    void set_var(size_t var_idx, __uint128_t val) {
+        words[2 * var_idx] = (uint64_t)val;
+        words[2 * var_idx + 1] = (uint64_t)(val >> 64);
     }
-    __int128_t get_var(size_t var_idx) const {
-        return arr[var_idx];
+    __uint128_t get_var(size_t var_idx) const {
+        return ((__uint128_t)words[2 * var_idx + 1] << 64) | words[2 * var_idx];
+    }
+
+    size_t count_ones() const {
+        size_t total = 0;
+        for (size_t i = 0; i < words.size(); ++i) {
+            total += __builtin_popcountll(words[i]);
+        }
+        return total;
+    }
+    // popcount(this & bs)
+    size_t count_and(const SampleBitSet& bs) const {
+        SASSERT(siz == bs.siz);
+        size_t total = 0;
+        for (size_t i = 0; i < words.size(); ++i) {
+            total += __builtin_popcountll(words[i] & bs.words[i]);
+        }
+        return total;
+    }
+    // this |= bs, returns the number of bits that were newly set
+    size_t merge(const SampleBitSet& bs) {
+        SASSERT(siz == bs.siz);
+        size_t gained = 0;
+        for (size_t i = 0; i < words.size(); ++i) {
+            gained += __builtin_popcountll(bs.words[i] & ~words[i]);
+            words[i] |= bs.words[i];
+        }
+        return gained;
     }
     int update_bit_change(const std::vector<__int128_t>& curr_solution, const SampleBitSet& last_sample, const SampleBitSet& mask, const int& num_vars) {
-        SASSERT(siz == last_sample.siz && siz == mask.siz && siz == num_vars);
+        SASSERT(siz == last_sample.siz && siz == mask.siz && siz == (size_t)num_vars);
         int total_changed_bit = 0;
         for (size_t i = 0; i < siz; ++i) {
-            arr[i] = (curr_solution[i] ^ last_sample.arr[i]) & mask.arr[i];
-            total_changed_bit += countOnes(arr[i]);
+            __uint128_t changed = ((__uint128_t)curr_solution[i] ^ last_sample.get_var(i)) & mask.get_var(i);
+            set_var(i, changed);
+            total_changed_bit += popcount128(changed);
         }
         return total_changed_bit;
     }
 };
-#endif
\ No newline at end of file
+
+}  // namespace sampler
+#endif
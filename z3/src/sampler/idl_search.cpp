@@ -0,0 +1,262 @@
+/*
+    Difference-logic fast path of the CCSS sampler.
+
+    When every lia literal is x - y + k <= 0 (or == 0), the generic search
+    still walks the coefficient vectors of the literals, multiplies every
+    coefficient by the move with __int128 overflow checks and finds critical
+    values through devide.  This path keeps each literal as an edge (x, y)
+    whose constant is folded into lit::delta, and each var's occurrences as
+    one contiguous list of (literal, clause, +1/-1): a move of the var by d
+    changes the side of an occurrence by +d or -d, and the critical value of
+    an edge is a plain difference of its side.
+
+    The search loop, restarts, interval moves and the score cache are those
+    of the generic path; only the scoring, the update of a lia move and the
+    collection of critical moves are replaced.
+*/
+#include "sampler/sampler.h"
+
+namespace sampler {
+
+// every used lia literal is a unit-coefficient difference of two vars
+bool ls_sampler::idl_applicable() {
+    if (!idl_fast_path || !is_idl || _use_pb_engine) {
+        return false;
+    }
+    for (uint64_t i = 0; i < _num_lits; i++) {
+        if (_lits[i].lits_index != 0 && _lits[i].is_lia_lit) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// edge list (x, y) per literal and var -> (signed literal, clause, sign) in the order of variable::literals
+void ls_sampler::build_idl_structures() {
+    _idl_edge_x.assign(_num_lits, -1);
+    _idl_edge_y.assign(_num_lits, -1);
+    for (uint64_t i = 0; i < _num_lits; i++) {
+        lit* l = &(_lits[i]);
+        if (l->lits_index == 0 || !l->is_lia_lit) {
+            continue;
+        }
+        _idl_edge_x[i] = l->pos_coff_var_idx[0];
+        _idl_edge_y[i] = l->neg_coff_var_idx[0];
+    }
+    _idl_occ_start.assign(_num_vars + 1, 0);
+    _idl_occ.clear();
+    for (uint64_t v = 0; v < _num_vars; v++) {
+        variable* var = &(_vars[v]);
+        if (var->is_lia) {
+            for (size_t i = 0; i < var->literals.size(); i++) {
+                _idl_occ.push_back({var->literals[i], var->literal_clause[i], var->literal_coff[i] > 0 ? 1 : -1});
+            }
+        }
+        _idl_occ_start[v + 1] = _idl_occ.size();
+    }
+}
+
+// side of the occurrence after moving its var by change_value
+inline __int128_t ls_sampler::idl_moved_delta(const idl_occurrence& o, lit* l, __int128_t change_value) {
+    __int128_t delta_new;
+    if (o.sign > 0) {
+        is_overflow = __builtin_add_overflow(l->delta, change_value, &delta_new) || is_overflow;
+    } else {
+        is_overflow = __builtin_sub_overflow(l->delta, change_value, &delta_new) || is_overflow;
+    }
+    if (is_overflow && !update_sampling_interval) {
+        shrinkSampleInterval(l);
+    }
+    return delta_new;
+}
+
+// critical_score on the edge list
+__int128_t ls_sampler::idl_critical_score(uint64_t var_idx, __int128_t change_value) {
+    __int128_t critical_score = 0;
+    int make_break_in_clause = 0;
+    _score_makes = 0;
+    const idl_occurrence* begin = _idl_occ.data() + _idl_occ_start[var_idx];
+    const idl_occurrence* end = _idl_occ.data() + _idl_occ_start[var_idx + 1];
+    for (const idl_occurrence* o = begin; o != end; o++) {
+        lit* l = &(_lits[std::abs(o->lit)]);
+        __int128_t delta_old = l->delta;
+        __int128_t delta_new = idl_moved_delta(*o, l, change_value);
+        bool was_true = l->is_equal ? delta_old == 0 : delta_old <= 0;
+        bool is_true = l->is_equal ? delta_new == 0 : delta_new <= 0;
+        if (was_true != is_true) {
+            make_break_in_clause += ((o->lit > 0) == is_true) ? 1 : -1;
+        }
+        if (o + 1 == end || o->clause != (o + 1)->clause) {
+            clause* cp = &(_clauses[o->clause]);
+            if (cp->sat_count == 0 && make_break_in_clause > 0) {
+                critical_score += cp->weight;
+                _score_makes++;
+            } else if (cp->sat_count > 0 && cp->sat_count + make_break_in_clause == 0)
+                critical_score -= cp->weight;
+            make_break_in_clause = 0;
+        }
+    }
+    return critical_score;
+}
+
+// critical_score_subscore of a lia var on the edge list
+void ls_sampler::idl_critical_score_subscore(uint64_t var_idx, __int128_t change_value) {
+    std::vector<int>& lit_exist = _lit_exist;
+    __int128_t new_future_min_delta = max_int;
+    int min_delta_lit_idx = -1;
+    bool contained_in_min_delta_lit = false;
+    int make_break_in_clause = 0;
+    _lit_occur->clear();
+    const idl_occurrence* begin = _idl_occ.data() + _idl_occ_start[var_idx];
+    const idl_occurrence* end = _idl_occ.data() + _idl_occ_start[var_idx + 1];
+    for (const idl_occurrence* o = begin; o != end; o++) {
+        lit* l = &(_lits[std::abs(o->lit)]);
+        __int128_t delta_old = l->delta;
+        __int128_t delta_new = idl_moved_delta(*o, l, change_value);
+        __int128_t pos_delta = delta_new;
+        convert_to_pos_delta(pos_delta, o->lit);
+        if (pos_delta < new_future_min_delta) {
+            new_future_min_delta = pos_delta;
+            min_delta_lit_idx = o->lit;
+        }
+        _lit_occur->insert_element(std::abs(o->lit));
+        clause* cp = &(_clauses[o->clause]);
+        if (o->lit == cp->min_delta_lit_index) {
+            contained_in_min_delta_lit = true;
+        }
+        bool was_true = l->is_equal ? delta_old == 0 : delta_old <= 0;
+        bool is_true = l->is_equal ? delta_new == 0 : delta_new <= 0;
+        if (was_true != is_true) {
+            make_break_in_clause += ((o->lit > 0) == is_true) ? 1 : -1;
+        }
+        if (o + 1 != end && o->clause == (o + 1)->clause) {
+            continue;
+        }
+        // last occurrence in this clause
+        if (cp->sat_count > 0 && cp->sat_count + make_break_in_clause == 0) {
+            unsat_a_clause(o->clause);
+            _lit_in_unsat_clause_num += cp->literals.size();
+            _bool_lit_in_unsat_clause_num += cp->bool_literals.size();
+        } else if (cp->sat_count == 0 && make_break_in_clause > 0) {
+            sat_a_clause(o->clause);
+            _lit_in_unsat_clause_num -= cp->literals.size();
+            _bool_lit_in_unsat_clause_num -= cp->bool_literals.size();
+        }
+        int origin_sat_count = cp->sat_count;
+        int origin_watch_lit = cp->min_delta_lit_index;
+        cp->sat_count += make_break_in_clause;
+        if (cp->sat_count > 0 && cp->sat_count < cp->literals.size()) {
+            _sat_clause_with_false_literal->insert_element(o->clause);
+        } else {
+            _sat_clause_with_false_literal->delete_element(o->clause);
+        }
+        if (new_future_min_delta <= cp->min_delta) {
+            cp->min_delta = new_future_min_delta;
+            cp->min_delta_lit_index = min_delta_lit_idx;
+        } else if (contained_in_min_delta_lit) {
+            for (int cp_lit_idx : cp->literals) {
+                if (!_lit_occur->is_in_array(std::abs(cp_lit_idx))) {
+                    pos_delta = _lits[std::abs(cp_lit_idx)].delta;
+                    convert_to_pos_delta(pos_delta, cp_lit_idx);
+                    if (pos_delta < new_future_min_delta) {
+                        new_future_min_delta = pos_delta;
+                        min_delta_lit_idx = cp_lit_idx;
+                    }
+                }
+            }
+            cp->min_delta = new_future_min_delta;
+            cp->min_delta_lit_index = min_delta_lit_idx;
+        }
+        if (_num_bool_lits > 0) {
+            if (make_break_in_clause > 0) {
+                if (origin_sat_count == 0) {
+                    for (int l_sign_idx : cp->bool_literals) {
+                        _vars[_lits[std::abs(l_sign_idx)].delta].score -= cp->weight;
+                    }
+                } else if (origin_sat_count == 1) {
+                    lit* w = &(_lits[std::abs(origin_watch_lit)]);
+                    if (!w->is_lia_lit) {
+                        _vars[w->delta].score += cp->weight;
+                    }
+                }
+            } else if (make_break_in_clause < 0) {
+                if (cp->sat_count == 0) {
+                    for (int l_sign_idx : cp->bool_literals) {
+                        _vars[_lits[std::abs(l_sign_idx)].delta].score += cp->weight;
+                    }
+                } else if (cp->sat_count == 1) {
+                    lit* w = &(_lits[std::abs(cp->min_delta_lit_index)]);
+                    if (!w->is_lia_lit) {
+                        _vars[w->delta].score -= cp->weight;
+                    }
+                }
+            }
+        }
+        make_break_in_clause = 0;
+        new_future_min_delta = max_int;
+        contained_in_min_delta_lit = false;
+        _lit_occur->clear();
+    }
+    // a literal repeated in several clauses moves once
+    for (const idl_occurrence* o = begin; o != end; o++) {
+        int lit_idx = std::abs(o->lit);
+        if (lit_exist[lit_idx] == 0) {
+            lit* l = &(_lits[lit_idx]);
+            l->delta = idl_moved_delta(*o, l, change_value);
+            lit_exist[lit_idx] = 1;
+        }
+    }
+    for (const idl_occurrence* o = begin; o != end; o++) {
+        lit_exist[std::abs(o->lit)] = 0;
+    }
+}
+
+/*
+    \brief add_clause_operations on the edge list: for the edge x - y + k, a positive literal needs
+    delta <= 0 (x by -delta or y by +delta), a negative one delta >= 1 (x by 1 - delta or y by delta - 1)
+*/
+void ls_sampler::idl_add_clause_operations(clause* cl, int& operation_idx, bool defer_interval) {
+    for (int l_sign_idx : cl->lia_literals) {
+        int l_idx = std::abs(l_sign_idx);
+        lit* l = &(_lits[l_idx]);
+        int x = _idl_edge_x[l_idx];
+        int y = _idl_edge_y[l_idx];
+        if (l->is_equal) {
+            if (l_sign_idx < 0) {  // delta is 0 and should not be, step either var by 1
+                for (int var_idx : {x, y}) {
+                    if (_step > _tabulist[2 * var_idx]) {
+                        insert_operation(var_idx, 1, operation_idx, l_idx);
+                    }
+                    if (_step > _tabulist[2 * var_idx + 1]) {
+                        insert_operation(var_idx, -1, operation_idx, l_idx);
+                    }
+                }
+            } else {
+                if ((l->delta < 0 && _step > _tabulist[2 * x]) || (l->delta > 0 && _step > _tabulist[2 * x + 1])) {
+                    insert_operation(x, -l->delta, operation_idx, l_idx);
+                }
+                if ((l->delta > 0 && _step > _tabulist[2 * y]) || (l->delta < 0 && _step > _tabulist[2 * y + 1])) {
+                    insert_operation(y, l->delta, operation_idx, l_idx);
+                }
+            }
+            continue;
+        }
+        if (l_sign_idx > 0) {
+            if (x != _lia_var_idx_with_most_lits && _step > _tabulist[2 * x + 1]) {
+                add_lia_operation(x, -l->delta, operation_idx, l_idx, defer_interval);
+            }
+            if (y != _lia_var_idx_with_most_lits && _step > _tabulist[2 * y]) {
+                add_lia_operation(y, l->delta, operation_idx, l_idx, defer_interval);
+            }
+        } else {
+            if (x != _lia_var_idx_with_most_lits && _step > _tabulist[2 * x]) {
+                add_lia_operation(x, 1 - l->delta, operation_idx, l_idx, defer_interval);
+            }
+            if (y != _lia_var_idx_with_most_lits && _step > _tabulist[2 * y + 1]) {
+                add_lia_operation(y, l->delta - 1, operation_idx, l_idx, defer_interval);
+            }
+        }
+    }
+}
+
+}  // namespace sampler
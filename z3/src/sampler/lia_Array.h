@@ -63,6 +63,27 @@ public:
         array_size = 0;
     }
 
+    // empties the array for elements in [0, capacity], memory is only reallocated when it has to grow
+    void reset(int capacity)
+    {
+        if (capacity + 1 <= array_capacity)
+        {
+            clear();
+            return;
+        }
+        delete[] array;
+        delete[] index_in_array;
+        array_capacity = capacity + 1;
+        array = new int[array_capacity];
+        index_in_array = new int[array_capacity];
+        for (int i = 0; i < array_capacity; i++)
+        {
+            array[i] = -1;
+            index_in_array[i] = -1;
+        }
+        array_size = 0;
+    }
+
     bool copy(const Array &src)
     {
         if (array_capacity != src.array_capacity)
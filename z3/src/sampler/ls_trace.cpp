@@ -0,0 +1,346 @@
+/*
+    Recording and replay of CCSS move traces, see ls_trace.h.
+
+    The replay runs the recorded kernel calls against an instance rebuilt
+    from the trace; the choices of the search (picks, BMS sampling, random
+    walks, tabu) are not re-executed, so the measured time is that of the
+    kernels alone.  It only reproduces the search exactly with the build
+    options of the recorded run, which the trace carries.
+*/
+#include "sampler/sampler.h"
+
+namespace sampler {
+
+const char* ls_trace_kind_name(uint8_t kind) {
+    switch (kind) {
+        case LS_TRACE_INIT:
+            return "init";
+        case LS_TRACE_SHIFT:
+            return "shift";
+        case LS_TRACE_RESTART:
+            return "restart";
+        case LS_TRACE_SCORE:
+            return "score";
+        case LS_TRACE_SUBSCORE:
+            return "subscore";
+        case LS_TRACE_MOVE:
+            return "move";
+        case LS_TRACE_WEIGHT_UPDATE:
+            return "weight-update";
+        case LS_TRACE_WEIGHT_SMOOTH:
+            return "weight-smooth";
+        default:
+            return "end";
+    }
+}
+
+ls_trace_writer::ls_trace_writer(const std::string& path) : out(path, std::ios::out | std::ios::binary) {
+    buf.append(LS_TRACE_MAGIC, sizeof(LS_TRACE_MAGIC));
+    put_varint(LS_TRACE_VERSION);
+}
+
+void ls_trace_writer::put_varint(uint64_t v) {
+    while (v >= 0x80) {
+        buf.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    buf.push_back((char)v);
+}
+
+// zigzag, as two varints: the low and the high 64 bits
+void ls_trace_writer::put_int(__int128_t v) {
+    __uint128_t zz = ((__uint128_t)v << 1) ^ (__uint128_t)(v >> 127);
+    put_varint((uint64_t)zz);
+    put_varint((uint64_t)(zz >> 64));
+}
+
+void ls_trace_writer::put_string(const std::string& s) {
+    put_varint(s.size());
+    buf.append(s);
+}
+
+void ls_trace_writer::flush() {
+    out.write(buf.data(), buf.size());
+    buf.clear();
+}
+
+void ls_trace_writer::write_instance(const ls_trace_instance& instance) {
+    put_varint(instance.seed);
+    put_varint((instance.eliminate_equalities ? 1 : 0) | (instance.idl_fast_path ? 2 : 0) | (instance.score_cache ? 4 : 0));
+    put_varint(instance.num_lits);
+    put_varint(lits.size());
+    for (const std::string& s : lits) {
+        put_string(s);
+    }
+    put_varint(instance.clauses.size());
+    for (const std::vector<int>& cl : instance.clauses) {
+        put_varint(cl.size());
+        for (int l : cl) {
+            put_int(l);
+        }
+    }
+    put_varint(instance.model.size());
+    for (const auto& [name, value] : instance.model) {
+        put_string(name);
+        put_string(value);
+    }
+    lits.clear();
+    flush();
+}
+
+void ls_trace_writer::event(ls_trace_kind kind) {
+    if (!recording()) {
+        return;
+    }
+    num_events++;
+    buf.push_back((char)kind);
+    if (buf.size() >= (1 << 20)) {
+        flush();
+    }
+}
+
+void ls_trace_writer::event(ls_trace_kind kind, uint64_t var, __int128_t value) {
+    if (!recording()) {
+        return;
+    }
+    num_events++;
+    buf.push_back((char)kind);
+    put_varint(var);
+    put_int(value);
+    if (buf.size() >= (1 << 20)) {
+        flush();
+    }
+}
+
+void ls_trace_writer::init(const std::vector<__int128_t>& solution, uint64_t num_vars, bool use_interval_move) {
+    if (!recording()) {
+        return;
+    }
+    num_events++;
+    buf.push_back((char)LS_TRACE_INIT);
+    put_varint(num_vars);
+    for (uint64_t i = 0; i < num_vars; i++) {
+        put_int(solution[i]);
+    }
+    put_varint(use_interval_move ? 1 : 0);
+    if (buf.size() >= (1 << 20)) {
+        flush();
+    }
+}
+
+void ls_trace_writer::close() {
+    if (!out.is_open()) {
+        return;
+    }
+    buf.push_back((char)LS_TRACE_END);
+    flush();
+    out.close();
+}
+
+bool ls_trace_reader::get_varint(uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; pos < data.size() && shift < 64; shift += 7) {
+        uint8_t b = (uint8_t)data[pos++];
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ls_trace_reader::get_int(__int128_t& v) {
+    uint64_t lo, hi;
+    if (!get_varint(lo) || !get_varint(hi)) {
+        return false;
+    }
+    __uint128_t zz = ((__uint128_t)hi << 64) | lo;
+    v = (__int128_t)(zz >> 1) ^ -(__int128_t)(zz & 1);
+    return true;
+}
+
+bool ls_trace_reader::get_string(std::string& s) {
+    uint64_t n;
+    if (!get_varint(n) || n > data.size() - pos) {
+        return false;
+    }
+    s.assign(data, pos, n);
+    pos += n;
+    return true;
+}
+
+bool ls_trace_reader::open(const std::string& path, ls_trace_instance& instance) {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    pos = sizeof(LS_TRACE_MAGIC);
+    uint64_t version, seed, flags, n, m;
+    if (data.size() < pos || data.compare(0, pos, LS_TRACE_MAGIC, sizeof(LS_TRACE_MAGIC)) != 0 ||
+        !get_varint(version) || version != LS_TRACE_VERSION || !get_varint(seed) || !get_varint(flags) ||
+        !get_varint(instance.num_lits) || !get_varint(n)) {
+        return false;
+    }
+    instance.seed = (unsigned)seed;
+    instance.eliminate_equalities = flags & 1;
+    instance.idl_fast_path = flags & 2;
+    instance.score_cache = flags & 4;
+    instance.lits.resize(n);
+    for (std::string& s : instance.lits) {
+        if (!get_string(s)) {
+            return false;
+        }
+    }
+    if (!get_varint(n)) {
+        return false;
+    }
+    instance.clauses.resize(n);
+    for (std::vector<int>& cl : instance.clauses) {
+        if (!get_varint(m)) {
+            return false;
+        }
+        cl.resize(m);
+        for (int& l : cl) {
+            __int128_t v;
+            if (!get_int(v)) {
+                return false;
+            }
+            l = (int)v;
+        }
+    }
+    if (!get_varint(n)) {
+        return false;
+    }
+    instance.model.resize(n);
+    for (auto& [name, value] : instance.model) {
+        if (!get_string(name) || !get_string(value)) {
+            return false;
+        }
+    }
+    events_start = pos;
+    return true;
+}
+
+bool ls_trace_reader::next(ls_trace_event& ev) {
+    if (pos >= data.size()) {
+        return false;
+    }
+    ev.kind = (uint8_t)data[pos++];
+    switch (ev.kind) {
+        case LS_TRACE_INIT: {
+            uint64_t n, flag;
+            if (!get_varint(n) || n > data.size() - pos) {
+                return false;
+            }
+            ev.solution.resize(n);
+            for (__int128_t& v : ev.solution) {
+                if (!get_int(v)) {
+                    return false;
+                }
+            }
+            if (!get_varint(flag)) {
+                return false;
+            }
+            ev.use_interval_move = flag != 0;
+            return true;
+        }
+        case LS_TRACE_SHIFT:
+        case LS_TRACE_SCORE:
+        case LS_TRACE_SUBSCORE:
+        case LS_TRACE_MOVE:
+            return get_varint(ev.var) && get_int(ev.value);
+        case LS_TRACE_RESTART:
+        case LS_TRACE_WEIGHT_UPDATE:
+        case LS_TRACE_WEIGHT_SMOOTH:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// only the first ls_sampling of the sampler is recorded
+void ls_sampler::set_trace(const std::string& path) {
+    if (_trace_taken || path.empty()) {
+        return;
+    }
+    _trace_taken = true;
+    _trace = std::make_unique<ls_trace_writer>(path);
+    if (!_trace->ok()) {
+        std::cerr << "Unable to open the ls trace " << path << "\n";
+        _trace.reset();
+    }
+}
+
+void ls_sampler::trace_instance(const std::vector<std::vector<int>>& clause_vec, const std::unordered_map<std::string, std::string>& model) {
+    ls_trace_instance instance;
+    instance.seed = _random_seed;
+    instance.eliminate_equalities = eliminate_equalities;
+    instance.idl_fast_path = idl_fast_path;
+    instance.score_cache = score_cache;
+    instance.num_lits = _num_lits;
+    instance.clauses = clause_vec;
+    instance.model.assign(model.begin(), model.end());
+    _trace->write_instance(instance);
+}
+
+void ls_sampler::end_trace() {
+    _trace->close();
+    _trace.reset();
+}
+
+bool ls_sampler::replay_trace(ls_trace_reader& in, ls_replay_stats& st) {
+    _num_vars = _vars.size();
+    if (_use_pb_engine) {
+        return false;
+    }
+    _step = 1;
+    ls_trace_event ev;
+    while (in.next(ev)) {
+        bool has_var = ev.kind == LS_TRACE_SHIFT || ev.kind == LS_TRACE_SCORE || ev.kind == LS_TRACE_SUBSCORE || ev.kind == LS_TRACE_MOVE;
+        if ((ev.kind == LS_TRACE_INIT && ev.solution.size() != _num_vars) || (has_var && ev.var >= _num_vars)) {
+            return false;
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        switch (ev.kind) {
+            case LS_TRACE_INIT:
+                is_overflow = false;
+                _use_interval_move = ev.use_interval_move;
+                clear_prev_data();
+                std::copy(ev.solution.begin(), ev.solution.end(), _solution.begin());
+                initialize_lit_datas();
+                initialize_clause_datas();
+                initialize_variable_datas();
+                end_restart();
+                break;
+            case LS_TRACE_SHIFT:
+                critical_score_subscore(ev.var, ev.value);
+                _solution[ev.var] += ev.value;
+                break;
+            case LS_TRACE_RESTART:
+                end_restart();
+                break;
+            case LS_TRACE_SCORE:
+                cached_critical_score(ev.var, ev.value);
+                break;
+            case LS_TRACE_SUBSCORE:
+                critical_subscore(ev.var, ev.value);
+                break;
+            case LS_TRACE_MOVE:
+                critical_move(ev.var, ev.value);
+                _step++;
+                break;
+            case LS_TRACE_WEIGHT_UPDATE:
+                update_clause_weight();
+                break;
+            case LS_TRACE_WEIGHT_SMOOTH:
+                smooth_clause_weight();
+                break;
+        }
+        st.ns[ev.kind] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        st.count[ev.kind]++;
+    }
+    return ev.kind == LS_TRACE_END;
+}
+
+}  // namespace sampler
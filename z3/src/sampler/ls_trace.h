@@ -0,0 +1,111 @@
+/*
+    Move traces of the CCSS search.
+
+    With ls_trace set, the first ls_sampling of a context writes the instance
+    as it was handed to the sampler (the strings of build_lits, the clauses
+    and the CDCL(T) model of build_instance) followed by every call of the
+    search kernels: the scored candidates, the moves, the clause weight
+    updates and the (re)initialized assignments.  test-z3 ls_sampler_replay
+    rebuilds the instance and re-executes exactly those calls, which gives a
+    deterministic micro-benchmark of the kernels on a real search.
+
+    File layout: "LSTR", a version varint, the header and the instance, then
+    one record per event: its kind byte followed by varints (values zigzag
+    encoded), and LS_TRACE_END.
+*/
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sampler {
+
+const char LS_TRACE_MAGIC[4] = {'L', 'S', 'T', 'R'};
+const uint64_t LS_TRACE_VERSION = 1;
+const uint64_t LS_TRACE_MAX_EVENTS = 1ull << 24;  // later events are not recorded
+
+enum ls_trace_kind : uint8_t {
+    LS_TRACE_END = 0,
+    LS_TRACE_INIT,            // initialize: the values of all vars, then the interval move flag
+    LS_TRACE_SHIFT,           // warm_restart redraws a var: var, change value
+    LS_TRACE_RESTART,         // end of a warm_restart
+    LS_TRACE_SCORE,           // cached_critical_score: var, change value
+    LS_TRACE_SUBSCORE,        // critical_subscore of the random walk: var, change value
+    LS_TRACE_MOVE,            // critical_move: var, change value
+    LS_TRACE_WEIGHT_UPDATE,   // update_clause_weight
+    LS_TRACE_WEIGHT_SMOOTH,   // smooth_clause_weight
+    LS_TRACE_NUM_KINDS
+};
+
+const char* ls_trace_kind_name(uint8_t kind);
+
+struct ls_trace_instance {
+    unsigned seed = 0;
+    bool eliminate_equalities = false;
+    bool idl_fast_path = true;
+    bool score_cache = false;
+    uint64_t num_lits = 0;  // make_lits_space
+    std::vector<std::string> lits;
+    std::vector<std::vector<int>> clauses;
+    std::vector<std::pair<std::string, std::string>> model;  // in the iteration order of the recorded run
+};
+
+struct ls_trace_event {
+    uint8_t kind = LS_TRACE_END;
+    uint64_t var = 0;
+    __int128_t value = 0;
+    std::vector<__int128_t> solution;  // LS_TRACE_INIT
+    bool use_interval_move = true;     // LS_TRACE_INIT
+};
+
+class ls_trace_writer {
+    std::ofstream out;
+    std::string buf;
+    uint64_t num_events = 0;
+    std::vector<std::string> lits;
+
+    void put_varint(uint64_t v);
+    void put_int(__int128_t v);
+    void put_string(const std::string& s);
+    void flush();
+
+   public:
+    explicit ls_trace_writer(const std::string& path);
+    ~ls_trace_writer() { close(); }
+    bool ok() const { return (bool)out; }
+
+    void add_lit(const std::string& lit_string) { lits.push_back(lit_string); }
+    /* the literal strings written are those of add_lit, instance.lits is not used */
+    void write_instance(const ls_trace_instance& instance);
+    inline bool recording() const { return num_events < LS_TRACE_MAX_EVENTS; }
+    void event(ls_trace_kind kind);
+    void event(ls_trace_kind kind, uint64_t var, __int128_t value);
+    void init(const std::vector<__int128_t>& solution, uint64_t num_vars, bool use_interval_move);
+    void close();
+};
+
+class ls_trace_reader {
+    std::string data;
+    size_t pos = 0;
+    size_t events_start = 0;
+
+    bool get_varint(uint64_t& v);
+    bool get_int(__int128_t& v);
+    bool get_string(std::string& s);
+
+   public:
+    /* reads the whole file and its instance; false if it is not a trace */
+    bool open(const std::string& path, ls_trace_instance& instance);
+    /* false at LS_TRACE_END or on a truncated trace */
+    bool next(ls_trace_event& ev);
+    void rewind() { pos = events_start; }
+};
+
+struct ls_replay_stats {
+    uint64_t count[LS_TRACE_NUM_KINDS] = {};
+    double ns[LS_TRACE_NUM_KINDS] = {};  // clock time inside the replayed calls
+};
+
+}  // namespace sampler
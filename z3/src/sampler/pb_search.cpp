@@ -0,0 +1,411 @@
+/*
+    Pseudo-Boolean fast path of the CCSS sampler.
+
+    When every lia var is bounded to [0, 1] the critical moves of the generic
+    search degenerate to flips, but they are still found through __int128
+    deltas, critical values and interval moves.  This path keeps the 0/1
+    assignment bit-packed, the side of every literal in 64 bits, and searches
+    with flips only: a weighted unsat clause is picked, the best-scoring
+    untabued var of its literals is flipped, and otherwise the clause weights
+    are updated before the best var of the clause is flipped anyway
+    (sat/sat_local_search style).
+
+    Scores (weighted make - break) are computed on demand and cached per var;
+    a flip invalidates the vars of every literal whose side it changed and of
+    every clause whose sat count went to or from 0 or 1.
+*/
+#include "sampler/sampler.h"
+
+namespace sampler {
+
+// every lia var is 0/1 and no literal side can leave 62 bits
+bool ls_sampler::pb_applicable() {
+    if (!pb_fast_path || _trace) {  // the flip search is not traced
+        return false;
+    }
+    bool has_lia = false;
+    for (uint64_t i = 0; i < _num_vars; i++) {
+        if (!_vars[i].is_lia) {
+            continue;
+        }
+        has_lia = true;
+        if (_vars[i].low_bound < 0 || _vars[i].upper_bound > 1) {
+            return false;
+        }
+    }
+    if (!has_lia) {
+        return false;
+    }
+    const __int128_t limit = (__int128_t)1 << 62;
+    for (uint64_t i = 0; i < _num_lits; i++) {
+        if (_lits[i].lits_index == 0 || !_lits[i].is_lia_lit) {
+            continue;
+        }
+        __int128_t sum = abs_128(_lits[i].key);
+        for (uint64_t k = _lit_row_start[i]; k < _lit_row_start[i + 1] && sum < limit; k++) {
+            sum += abs_128(_lit_col_coff[k]);
+        }
+        if (sum >= limit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// CSR occurrence lists: var -> (lit, merged coff) and lit -> signed clause
+void ls_sampler::build_pb_structures() {
+    _pb_lit_clause_start.assign(_num_lits + 1, 0);
+    for (uint64_t c = 0; c < _num_clauses; c++) {
+        for (int l_sign_idx : _clauses[c].literals) {
+            _pb_lit_clause_start[std::abs(l_sign_idx) + 1]++;
+        }
+    }
+    for (uint64_t i = 0; i < _num_lits; i++) {
+        _pb_lit_clause_start[i + 1] += _pb_lit_clause_start[i];
+    }
+    _pb_lit_clause.resize(_pb_lit_clause_start[_num_lits]);
+    std::vector<uint64_t> cursor(_pb_lit_clause_start.begin(), _pb_lit_clause_start.end() - 1);
+    for (uint64_t c = 0; c < _num_clauses; c++) {
+        for (int l_sign_idx : _clauses[c].literals) {
+            _pb_lit_clause[cursor[std::abs(l_sign_idx)]++] = l_sign_idx > 0 ? (int)c + 1 : -((int)c + 1);
+        }
+    }
+
+    // a var may occur in both the pos and neg terms of one literal, merge them
+    std::vector<std::pair<int, std::pair<int, int64_t>>> occs;  // var, (lit, coff)
+    std::vector<int64_t> merged(_num_vars, 0);
+    std::vector<uint64_t> seen(_num_vars, 0);
+    for (uint64_t i = 0; i < _num_lits; i++) {
+        lit* l = &(_lits[i]);
+        if (l->lits_index == 0) {
+            continue;
+        }
+        if (!l->is_lia_lit) {
+            occs.push_back({(int)l->delta, {(int)i, 0}});
+            continue;
+        }
+        for (uint64_t k = _lit_row_start[i]; k < _lit_row_start[i + 1]; k++) {
+            int v = _lit_col_var[k];
+            if (seen[v] != i + 1) {
+                seen[v] = i + 1;
+                merged[v] = 0;
+            }
+            merged[v] += (int64_t)_lit_col_coff[k];
+        }
+        for (uint64_t k = _lit_row_start[i]; k < _lit_row_start[i + 1]; k++) {
+            int v = _lit_col_var[k];
+            if (seen[v] == i + 1) {
+                seen[v] = 0;  // emitted
+                if (merged[v] != 0) {
+                    occs.push_back({v, {(int)i, merged[v]}});
+                }
+            }
+        }
+    }
+    _pb_occ_start.assign(_num_vars + 1, 0);
+    for (auto& o : occs) {
+        _pb_occ_start[o.first + 1]++;
+    }
+    for (uint64_t v = 0; v < _num_vars; v++) {
+        _pb_occ_start[v + 1] += _pb_occ_start[v];
+    }
+    _pb_occ_lit.resize(occs.size());
+    _pb_occ_coff.resize(occs.size());
+    cursor.assign(_pb_occ_start.begin(), _pb_occ_start.end() - 1);
+    for (auto& o : occs) {
+        uint64_t k = cursor[o.first]++;
+        _pb_occ_lit[k] = o.second.first;
+        _pb_occ_coff[k] = o.second.second;
+    }
+
+    _pb_assign.assign((_num_vars + 63) / 64, 0);
+    _pb_lhs.assign(_num_lits, 0);
+    _pb_score.assign(_num_vars, 0);
+    _pb_score_valid.assign(_num_vars, 0);
+    _pb_fixed.assign(_num_vars, 0);
+    for (uint64_t v = 0; v < _num_vars; v++) {
+        _pb_fixed[v] = _vars[v].is_lia && _vars[v].low_bound == _vars[v].upper_bound;
+    }
+    _pb_clause_dsat.assign(_num_clauses, 0);
+    _pb_candidate_stamp.assign(_num_vars, 0);
+}
+
+bool ls_sampler::pb_lit_true(int l_idx) const {
+    const lit& l = _lits[l_idx];
+    if (!l.is_lia_lit) {
+        return pb_value((int)l.delta);
+    }
+    return l.is_equal ? _pb_lhs[l_idx] == 0 : _pb_lhs[l_idx] <= 0;
+}
+
+void ls_sampler::pb_invalidate_clause(int c_idx) {
+    for (uint64_t k = _clause_row_start[c_idx]; k < _clause_row_start[c_idx + 1]; k++) {
+        int l_idx = std::abs(_clause_flat_lits[k]);
+        if (!_lits[l_idx].is_lia_lit) {
+            _pb_score_valid[_lits[l_idx].delta] = 0;
+            continue;
+        }
+        for (uint64_t j = _lit_row_start[l_idx]; j < _lit_row_start[l_idx + 1]; j++) {
+            _pb_score_valid[_lit_col_var[j]] = 0;
+        }
+    }
+}
+
+void ls_sampler::pb_initialize() {
+    clear_prev_data();
+    std::fill(_pb_assign.begin(), _pb_assign.end(), 0);
+    for (uint64_t v = 0; v < _num_vars; v++) {
+        construct_var_value((int)v);
+        if (_solution[v] > 0) {
+            _pb_assign[v >> 6] |= (uint64_t)1 << (v & 63);
+        }
+        _tabulist[2 * v] = 0;
+        _last_move[2 * v] = 0;
+    }
+    for (uint64_t i = 0; i < _num_lits; i++) {
+        if (_lits[i].lits_index == 0 || !_lits[i].is_lia_lit) {
+            continue;
+        }
+        int64_t lhs = (int64_t)_lits[i].key;
+        for (uint64_t k = _lit_row_start[i]; k < _lit_row_start[i + 1]; k++) {
+            if (pb_value(_lit_col_var[k])) {
+                lhs += (int64_t)_lit_col_coff[k];
+            }
+        }
+        _pb_lhs[i] = lhs;
+    }
+    _unsat_clauses->clear();
+    _contain_bool_unsat_clauses->clear();
+    for (uint64_t c = 0; c < _num_clauses; c++) {
+        clause* cl = &(_clauses[c]);
+        int sat_count = 0;
+        for (uint64_t k = _clause_row_start[c]; k < _clause_row_start[c + 1]; k++) {
+            int l_sign_idx = _clause_flat_lits[k];
+            sat_count += pb_lit_true(std::abs(l_sign_idx)) == (l_sign_idx > 0);
+        }
+        cl->sat_count = sat_count;
+        cl->weight = 1;
+        if (sat_count == 0) {
+            unsat_a_clause(c);
+        }
+    }
+    _total_clause_weight = _num_clauses;
+    std::fill(_pb_score_valid.begin(), _pb_score_valid.end(), 0);
+    best_found_this_restart = _unsat_clauses->size();
+    update_best_solution();
+}
+
+int64_t ls_sampler::pb_score(int v) {
+    if (_pb_score_valid[v]) {
+        return _pb_score[v];
+    }
+    int64_t d = pb_value(v) ? -1 : 1;
+    for (uint64_t k = _pb_occ_start[v]; k < _pb_occ_start[v + 1]; k++) {
+        int l_idx = _pb_occ_lit[k];
+        const lit& l = _lits[l_idx];
+        bool before = pb_lit_true(l_idx), after;
+        if (!l.is_lia_lit) {
+            after = !before;
+        } else {
+            int64_t lhs = _pb_lhs[l_idx] + d * _pb_occ_coff[k];
+            after = l.is_equal ? lhs == 0 : lhs <= 0;
+        }
+        if (before == after) {
+            continue;
+        }
+        int change = after ? 1 : -1;
+        for (uint64_t j = _pb_lit_clause_start[l_idx]; j < _pb_lit_clause_start[l_idx + 1]; j++) {
+            int ref = _pb_lit_clause[j];
+            int c_idx = std::abs(ref) - 1;
+            if (_pb_clause_dsat[c_idx] == 0) {
+                _pb_touched.push_back(c_idx);
+            }
+            _pb_clause_dsat[c_idx] += ref > 0 ? change : -change;
+        }
+    }
+    int64_t score = 0;
+    for (int c_idx : _pb_touched) {
+        int before = _clauses[c_idx].sat_count;
+        int after = before + _pb_clause_dsat[c_idx];
+        if (before == 0 && after > 0) {
+            score += _clauses[c_idx].weight;
+        } else if (before > 0 && after == 0) {
+            score -= _clauses[c_idx].weight;
+        }
+        _pb_clause_dsat[c_idx] = 0;
+    }
+    _pb_touched.clear();
+    _pb_score[v] = score;
+    _pb_score_valid[v] = 1;
+    return score;
+}
+
+void ls_sampler::pb_flip(int v) {
+    int64_t d = pb_value(v) ? -1 : 1;
+    for (uint64_t k = _pb_occ_start[v]; k < _pb_occ_start[v + 1]; k++) {
+        int l_idx = _pb_occ_lit[k];
+        const lit& l = _lits[l_idx];
+        bool before = pb_lit_true(l_idx), after;
+        if (!l.is_lia_lit) {
+            after = !before;
+        } else {
+            _pb_lhs[l_idx] += d * _pb_occ_coff[k];
+            after = pb_lit_true(l_idx);
+            for (uint64_t j = _lit_row_start[l_idx]; j < _lit_row_start[l_idx + 1]; j++) {
+                _pb_score_valid[_lit_col_var[j]] = 0;
+            }
+        }
+        if (before == after) {
+            continue;
+        }
+        int change = after ? 1 : -1;
+        for (uint64_t j = _pb_lit_clause_start[l_idx]; j < _pb_lit_clause_start[l_idx + 1]; j++) {
+            int ref = _pb_lit_clause[j];
+            int c_idx = std::abs(ref) - 1;
+            int old_count = _clauses[c_idx].sat_count;
+            int new_count = old_count + (ref > 0 ? change : -change);
+            _clauses[c_idx].sat_count = new_count;
+            if (old_count == 0) {
+                sat_a_clause(c_idx);
+            } else if (new_count == 0) {
+                unsat_a_clause(c_idx);
+            }
+            if (std::min(old_count, new_count) <= 1) {
+                pb_invalidate_clause(c_idx);
+            }
+        }
+    }
+    _pb_assign[v >> 6] ^= (uint64_t)1 << (v & 63);
+    _pb_score_valid[v] = 0;
+}
+
+void ls_sampler::pb_update_weights() {
+    if (mt() % 10000 > smooth_probability) {
+        for (int i = 0; i < _unsat_clauses->size(); i++) {
+            int c_idx = _unsat_clauses->element_at(i);
+            _clauses[c_idx].weight++;
+            pb_invalidate_clause(c_idx);
+        }
+        total_clause_weight += _unsat_clauses->size();
+    } else {
+        for (uint64_t c = 0; c < _num_clauses; c++) {
+            if (_clauses[c].weight > 1 && _clauses[c].sat_count > 0) {
+                _clauses[c].weight--;
+                total_clause_weight--;
+            }
+        }
+        std::fill(_pb_score_valid.begin(), _pb_score_valid.end(), 0);
+    }
+}
+
+// the untabued var with the best score among the vars of a weighted unsat clause, BMS over 45 of them
+int ls_sampler::pb_pick_var() {
+    int c_idx = sample_unsat_clause();
+    _pb_candidates.clear();
+    for (uint64_t k = _clause_row_start[c_idx]; k < _clause_row_start[c_idx + 1]; k++) {
+        int l_idx = std::abs(_clause_flat_lits[k]);
+        if (!_lits[l_idx].is_lia_lit) {
+            int v = (int)_lits[l_idx].delta;
+            if (_pb_candidate_stamp[v] != _step) {
+                _pb_candidate_stamp[v] = _step;
+                _pb_candidates.push_back(v);
+            }
+            continue;
+        }
+        for (uint64_t j = _lit_row_start[l_idx]; j < _lit_row_start[l_idx + 1]; j++) {
+            int v = _lit_col_var[j];
+            if (!_pb_fixed[v] && _pb_candidate_stamp[v] != _step) {
+                _pb_candidate_stamp[v] = _step;
+                _pb_candidates.push_back(v);
+            }
+        }
+    }
+    if (_pb_candidates.empty()) {
+        return -1;
+    }
+
+    int n = (int)_pb_candidates.size();
+    int cnt = std::min(n, 45);
+    int best_var = -1;
+    int64_t best_score = 0;
+    for (int i = 0; i < cnt; i++) {
+        if (n > 45) {
+            std::swap(_pb_candidates[i], _pb_candidates[i + mt() % (n - i)]);
+        }
+        int v = _pb_candidates[i];
+        if (_step <= _tabulist[2 * v]) {
+            continue;
+        }
+        int64_t score = pb_score(v);
+        if (score > best_score || (score == best_score && best_var != -1 && _last_move[2 * v] < _last_move[2 * best_var])) {
+            best_score = score;
+            best_var = v;
+        }
+    }
+    if (best_var != -1 && best_score > 0) {
+        return best_var;
+    }
+
+    // no improving flip: update weights, then flip the best var of the clause regardless of tabu
+    pb_update_weights();
+    best_var = _pb_candidates[0];
+    best_score = pb_score(best_var);
+    for (int i = 1; i < cnt; i++) {
+        int v = _pb_candidates[i];
+        int64_t score = pb_score(v);
+        if (score > best_score || (score == best_score && _last_move[2 * v] < _last_move[2 * best_var])) {
+            best_score = score;
+            best_var = v;
+        }
+    }
+    return best_var;
+}
+
+// back to the generic representation, which up_bool_vars and the model construction read
+void ls_sampler::pb_store_solution() {
+    for (uint64_t v = 0; v < _num_vars; v++) {
+        bool b = pb_value((int)v);
+        _solution[v] = _vars[v].is_lia ? (b ? 1 : 0) : (b ? 1 : -1);
+    }
+    for (uint64_t i = 0; i < _num_lits; i++) {
+        if (_lits[i].lits_index != 0 && _lits[i].is_lia_lit) {
+            _lits[i].delta = _pb_lhs[i];
+        }
+    }
+}
+
+bool ls_sampler::pb_search() {
+    pb_initialize();
+    int no_improve_cnt = 0;
+    for (_step = 1; _step < _max_step; ++_step) {
+        if (0 == _unsat_clauses->size()) {
+            pb_store_solution();
+            choose_value_for_pair();
+            choose_value_for_eliminated();
+            up_bool_vars();
+            if (bit_guided) {
+                record_sample_bits();
+            }
+            return true;
+        }
+        if (_step % 1000 == 0 && (TimeElapsed_total() > _cutoff)) {
+            std::cout << "this round time out !\n";
+            break;
+        }
+        if (no_improve_cnt > 500000) {
+            pb_initialize();
+            no_improve_cnt = 0;
+        }
+        int v = pb_pick_var();
+        if (v != -1) {
+            pb_flip(v);
+            _last_move[2 * v] = _step;
+            _tabulist[2 * v] = _step + 3 + mt() % 10;
+        }
+        no_improve_cnt = (update_best_solution()) ? 0 : (no_improve_cnt + 1);
+    }
+    pb_store_solution();
+    return false;
+}
+
+}  // namespace sampler
@@ -135,18 +135,10 @@ void ls_sampler::split_string(std::string& in_string, std::vector<std::string>&
 uint64_t ls_sampler::transfer_name_to_resolution_var(std::string& name, bool is_lia, bool in_equal) {
     if (_name2resolution_var.find(name) == _name2resolution_var.end()) {
         _name2resolution_var[name] = _resolution_vars.size();  // name --> idx
-        variable var;
-        var.clause_idxs.reserve(64);
-        var.literals.reserve(64);
-        var.literal_clause.reserve(64);
-        var.literal_coff.reserve(64);
+        variable& var = _resolution_vars.emplace_back();     // occurrence arrays are sized by the counting pass of build_instance
         var.var_name = name;
-        if (var.is_in_equal == false) {
-            var.is_in_equal = in_equal;
-        }
         var.is_lia = is_lia;
         var.is_in_equal = in_equal;
-        _resolution_vars.push_back(var);
         if (is_lia) {
             _lia_var_vec.push_back((int)_resolution_vars.size() - 1);
         } else {
@@ -165,13 +157,10 @@ uint64_t ls_sampler::transfer_name_to_resolution_var(std::string& name, bool is_
 uint64_t ls_sampler::transfer_name_to_tmp_var(std::string& name, bool in_equal) {
     if (_name2tmp_var.find(name) == _name2tmp_var.end()) {
         _name2tmp_var[name] = _tmp_vars.size();
-        variable var;
+        variable& var = _tmp_vars.emplace_back();
         var.is_lia = true;
         var.var_name = name;
-        if (var.is_in_equal == false) {
-            var.is_in_equal = in_equal;
-        }
-        _tmp_vars.push_back(var);
+        var.is_in_equal = in_equal;
         return _tmp_vars.size() - 1;
     } else
         return _name2tmp_var[name];
@@ -193,6 +182,9 @@ void ls_sampler::invert_lit(lit& l) {
     \brief build lit to _lits[lit_index]; build var to _tmp_vars[]
 */
 void ls_sampler::build_lits(std::string& in_string) {
+    if (_trace) {
+        _trace->add_lit(in_string);
+    }
     std::vector<std::string> vec;
     split_string(in_string, vec);
     if (vec[0] == "0") {
@@ -283,6 +275,16 @@ void ls_sampler::free_space() {
     delete _contain_bool_unsat_clauses;
     delete pair_x;
     delete pair_y;
+    _unsat_clauses = _lit_occur = _sat_clause_with_false_literal = _contain_bool_unsat_clauses = nullptr;
+    pair_x = pair_y = nullptr;
+}
+
+// the arrays outlive a single check, later checks of the same context reuse them
+static void reset_array(Array*& arr, int capacity) {
+    if (arr)
+        arr->reset(capacity);
+    else
+        arr = new Array(capacity);
 }
 
 void ls_sampler::make_space() {
@@ -295,12 +297,15 @@ void ls_sampler::make_space() {
     _operation_var_idx_bool_vec.resize(_num_opt + _additional_len);
     _operation_lit_idx_vec.resize(_num_opt + _additional_len);
     _operation_change_value_vec.resize(_num_opt + _additional_len);
+    _operation_deferred_vec.resize(_num_opt + _additional_len);
+    _clause_pick_stamp_vec.resize(_num_clauses + _additional_len, 0);
     _last_move.resize(2 * _num_vars + _additional_len, 0);
-    _unsat_clauses = new Array((int)_num_clauses + (int)_additional_len);
-    _sat_clause_with_false_literal = new Array((int)_num_clauses + (int)_additional_len);
-    _lit_occur = new Array((int)_num_lits);
-    _contain_bool_unsat_clauses = new Array((int)_num_clauses);
+    reset_array(_unsat_clauses, (int)_num_clauses + (int)_additional_len);
+    reset_array(_sat_clause_with_false_literal, (int)_num_clauses + (int)_additional_len);
+    reset_array(_lit_occur, (int)_num_lits);
+    reset_array(_contain_bool_unsat_clauses, (int)_num_clauses);
     _is_chosen_bool_var.resize(_num_vars + _additional_len, false);
+    _lit_exist.assign(_num_lits + _additional_len, 0);
 }
 
 void ls_sampler::calc_var_intervals() {
@@ -404,18 +409,62 @@ void ls_sampler::calc_var_intervals() {
 void ls_sampler::initialize() {
     clear_prev_data();
     construct_solution_score();  // Initializing a variable to take a value
+    if (_trace) {
+        _trace->init(_solution, _num_vars, _use_interval_move);
+    }
     initialize_lit_datas();
     initialize_clause_datas();
     initialize_variable_datas();
+    end_restart();
+}
+
+// shared tail of initialize and warm_restart
+void ls_sampler::end_restart() {
+    if (score_cache) {
+        reset_score_cache();
+    }
     best_found_this_restart = _unsat_clauses->size();
     update_best_solution();
-#if !defined(BAM_V2) && !defined(BAM_V1) 
+#if !defined(BAM_V2) && !defined(BAM_V1)
     if (_use_interval_move) {
         update_literals_sat_steps_count();
     }
 #endif
 }
 
+/*
+    \brief Restart from the current assignment: only a _warm_restart_pct percent of the lia vars get a new
+    initial value, the literals, clauses and scores around them are updated incrementally and the clause
+    weights are kept
+*/
+void ls_sampler::warm_restart() {
+    std::uniform_int_distribution<unsigned> d(0, 99);
+    for (int i = 0; i < _num_vars; i++) {
+        if (!_vars[i].is_lia || d(mt) >= _warm_restart_pct) {
+            continue;
+        }
+        __int128_t old_value = _solution[i];
+        construct_var_value(i);
+        __int128_t change_value = _solution[i] - old_value;
+        _solution[i] = old_value;
+        if (change_value != 0) {
+            if (_trace) {
+                _trace->event(LS_TRACE_SHIFT, i, change_value);
+            }
+            critical_score_subscore(i, change_value);
+            _solution[i] += change_value;
+        }
+    }
+    if (_trace) {
+        _trace->event(LS_TRACE_RESTART);
+    }
+    _best_found_hard_cost_this_bool = INT32_MAX;
+    _best_found_hard_cost_this_lia = INT32_MAX;
+    _no_improve_cnt_bool = 0;
+    _no_improve_cnt_lia = 0;
+    end_restart();
+}
+
 void ls_sampler::clear_prev_data() {
     // equal_move_cnt = 0;
     for (int v : _bool_var_vec) {
@@ -480,73 +529,78 @@ int64_t ls_sampler::random_int64_in_range(int64_t left, int64_t right) {
 // construction
 void ls_sampler::construct_solution_score() {
     for (int i = 0; i < _num_vars; i++) {
-        if (!_vars[i].is_lia) {
-            if (mt() % 2 == 1) {
-                _solution[i] = 1;
-            } else {
-                _solution[i] = -1;
-            }
-            continue;
-        }
-        if (_vars[i].low_bound != -max_int) {
-            _vars[i].s_lower_bound = _vars[i].low_bound;
-        }
-        if (_vars[i].upper_bound != max_int) {
-            _vars[i].s_upper_bound = _vars[i].upper_bound;
+        construct_var_value(i);
+    }
+}
+
+// draw the initial value of var i
+void ls_sampler::construct_var_value(int i) {
+    if (!_vars[i].is_lia) {
+        if (mt() % 2 == 1) {
+            _solution[i] = 1;
+        } else {
+            _solution[i] = -1;
         }
+        return;
+    }
+    if (_vars[i].low_bound != -max_int) {
+        _vars[i].s_lower_bound = _vars[i].low_bound;
+    }
+    if (_vars[i].upper_bound != max_int) {
+        _vars[i].s_upper_bound = _vars[i].upper_bound;
+    }
 
-        __int64_t s_lower_bound = _vars[i].s_lower_bound;
-        __int64_t s_upper_bound = _vars[i].s_upper_bound;
+    __int64_t s_lower_bound = _vars[i].s_lower_bound;
+    __int64_t s_upper_bound = _vars[i].s_upper_bound;
 
 #if defined(INIT_VAR_V1) || defined(BAM_V2) || defined(BAM_V1)
+    if (_vars[i].low_bound > 0)
+        _solution[i] = _vars[i].low_bound;
+    else if (_vars[i].upper_bound < 0)
+        _solution[i] = _vars[i].upper_bound;
+    else
+        _solution[i] = 0;
+    return;
+#endif
+
+#if defined(INIT_VAR_V2) || defined(INIT_VAR_V3)
+    if (_vars_initialization_intervals[i].start > _vars_initialization_intervals[i].end) {
         if (_vars[i].low_bound > 0)
             _solution[i] = _vars[i].low_bound;
         else if (_vars[i].upper_bound < 0)
             _solution[i] = _vars[i].upper_bound;
         else
             _solution[i] = 0;
-        continue;
-#endif
-
-#if defined(INIT_VAR_V2) || defined(INIT_VAR_V3)
-        if (_vars_initialization_intervals[i].start > _vars_initialization_intervals[i].end) {
-            if (_vars[i].low_bound > 0)
-                _solution[i] = _vars[i].low_bound;
-            else if (_vars[i].upper_bound < 0)
-                _solution[i] = _vars[i].upper_bound;
-            else
-                _solution[i] = 0;
-        } else {
-            _solution[i] = random_int64_in_range(std::max(s_lower_bound, _vars_initialization_intervals[i].start), std::min(s_upper_bound, _vars_initialization_intervals[i].end));
-        }
+    } else {
+        _solution[i] = random_int64_in_range(std::max(s_lower_bound, _vars_initialization_intervals[i].start), std::min(s_upper_bound, _vars_initialization_intervals[i].end));
+    }
 #endif
 
 #ifdef INIT_VAR_V4
-        _solution[i] = random_int64_in_range(s_lower_bound, s_upper_bound);
+    _solution[i] = random_int64_in_range(s_lower_bound, s_upper_bound);
 #endif
 
 #if !defined(INIT_VAR_V1) && !defined(INIT_VAR_V2) && !defined(INIT_VAR_V3) && !defined(INIT_VAR_V4)
-        if (_vars[i].in_equal_closure) {  //  || _vars[i].in_occs_closure
-            if (_vars[i].low_bound > 0)
-                _solution[i] = _vars[i].low_bound;
-            else if (_vars[i].upper_bound < 0)
-                _solution[i] = _vars[i].upper_bound;
-            else
-                _solution[i] = 0;
-        } else if (is_pb){
-            std::uniform_int_distribution<int> d(0, 1);
-            _solution[i] = d(mt);
-        }else {
-            _solution[i] = random_int64_in_range(std::max(s_lower_bound, _vars_initialization_intervals[i].start), std::min(s_upper_bound, _vars_initialization_intervals[i].end));
-        }
-        TRACE("sampler",
-              tout << "is occs closure var: " << _vars[i].in_occs_closure << "\n";
-              tout << "is equal closure var: " << _vars[i].in_equal_closure << "\n";
-              tout << "initialization_intervals: [" << print_128(_vars_initialization_intervals[i].start) << ", " << print_128(_vars_initialization_intervals[i].end) << "]\n";
-              tout << "boundary intervals: [" << print_128(s_lower_bound) << ", " << print_128(s_upper_bound) << "]\n";
-              tout << _vars[i].var_name << " = " << print_128(_solution[i]) << "\n";);
+    if (_vars[i].in_equal_closure) {  //  || _vars[i].in_occs_closure
+        if (_vars[i].low_bound > 0)
+            _solution[i] = _vars[i].low_bound;
+        else if (_vars[i].upper_bound < 0)
+            _solution[i] = _vars[i].upper_bound;
+        else
+            _solution[i] = 0;
+    } else if (is_pb){
+        std::uniform_int_distribution<int> d(0, 1);
+        _solution[i] = d(mt);
+    }else {
+        _solution[i] = random_int64_in_range(std::max(s_lower_bound, _vars_initialization_intervals[i].start), std::min(s_upper_bound, _vars_initialization_intervals[i].end));
+    }
+    TRACE("sampler",
+          tout << "is occs closure var: " << _vars[i].in_occs_closure << "\n";
+          tout << "is equal closure var: " << _vars[i].in_equal_closure << "\n";
+          tout << "initialization_intervals: [" << print_128(_vars_initialization_intervals[i].start) << ", " << print_128(_vars_initialization_intervals[i].end) << "]\n";
+          tout << "boundary intervals: [" << print_128(s_lower_bound) << ", " << print_128(s_upper_bound) << "]\n";
+          tout << _vars[i].var_name << " = " << print_128(_solution[i]) << "\n";);
 #endif
-    }
 }
 
 double ls_sampler::TimeElapsed_total() {
@@ -572,12 +626,53 @@ bool ls_sampler::update_best_solution() {
 void ls_sampler::initialize_variable_datas() {
 }
 
-// initialize the delta of each literal by delta_lit operation
+// flatten the lia coefficients (a row per literal: pos coffs, then negated neg coffs) and the clause literals;
+// the literals of reduced away clauses keep empty rows, their vars are only mapped by up_bool_vars
+void ls_sampler::build_restart_matrix() {
+    _lit_row_start.assign(_num_lits + 1, 0);
+    _lit_col_var.clear();
+    _lit_col_coff.clear();
+    for (uint64_t i = 0; i < _num_lits; i++) {
+        lit* l = &(_lits[i]);
+        if (l->lits_index != 0 && l->is_lia_lit && _lit_appear[i]) {
+            for (size_t k = 0; k < l->pos_coff.size(); k++) {
+                _lit_col_var.push_back(l->pos_coff_var_idx[k]);
+                _lit_col_coff.push_back(l->pos_coff[k]);
+            }
+            for (size_t k = 0; k < l->neg_coff.size(); k++) {
+                _lit_col_var.push_back(l->neg_coff_var_idx[k]);
+                _lit_col_coff.push_back(-l->neg_coff[k]);
+            }
+        }
+        _lit_row_start[i + 1] = _lit_col_var.size();
+    }
+    _clause_row_start.assign(_num_clauses + 1, 0);
+    _clause_flat_lits.clear();
+    for (uint64_t c = 0; c < _num_clauses; c++) {
+        _clause_flat_lits.insert(_clause_flat_lits.end(), _clauses[c].literals.begin(), _clauses[c].literals.end());
+        _clause_row_start[c + 1] = _clause_flat_lits.size();
+    }
+    _lit_dtt.resize(2 * _num_lits);
+}
+
+// initialize the delta of each literal: one sparse matrix-vector product over the flattened coefficients
 void ls_sampler::initialize_lit_datas() {
+    __int128_t delta, tmp;
     for (uint64_t i = 0; i < _num_lits; i++) {
-        if (_lits[i].lits_index != 0 && _lits[i].is_lia_lit) {
-            _lits[i].delta = delta_lit(_lits[i]);
+        if (_lits[i].lits_index == 0 || !_lits[i].is_lia_lit) {
+            continue;
+        }
+        delta = _lits[i].key;
+        bool overflow = false;
+        for (uint64_t k = _lit_row_start[i]; k < _lit_row_start[i + 1]; k++) {
+            overflow |= __builtin_mul_overflow(_lit_col_coff[k], _solution[_lit_col_var[k]], &tmp);
+            overflow |= __builtin_add_overflow(delta, tmp, &delta);
+        }
+        is_overflow = is_overflow || overflow;
+        if (is_overflow && !update_sampling_interval) {
+            shrinkSampleInterval(&_lits[i]);
         }
+        _lits[i].delta = delta;
     }
 }
 
@@ -585,30 +680,41 @@ void ls_sampler::initialize_lit_datas() {
 void ls_sampler::initialize_clause_datas() {
     _lit_in_unsat_clause_num = 0;
     _bool_lit_in_unsat_clause_num = 0;
-    __int128_t pos_delta;
+    // distance to true of both polarities of every literal (see convert_to_pos_delta), 0 means sat
+    for (uint64_t i = 0; i < _num_lits; i++) {
+        lit* l = &(_lits[i]);
+        if (l->lits_index == 0) {  // unused slot, not in any clause
+            _lit_dtt[2 * i] = _lit_dtt[2 * i + 1] = 1;
+        } else if (!l->is_lia_lit) {
+            _lit_dtt[2 * i] = (_solution[l->delta] > 0) ? 0 : 1;
+            _lit_dtt[2 * i + 1] = (_solution[l->delta] < 0) ? 0 : 1;
+        } else if (l->is_equal) {
+            _lit_dtt[2 * i] = (l->delta == 0) ? 0 : 1;
+            _lit_dtt[2 * i + 1] = (l->delta != 0) ? 0 : 1;
+        } else {
+            _lit_dtt[2 * i] = std::max<__int128_t>(l->delta, 0);
+            _lit_dtt[2 * i + 1] = std::max<__int128_t>(1 - l->delta, 0);
+        }
+    }
+    // clause reduction over the flattened literals: sat count and the first literal with the min distance
     for (uint64_t c = 0; c < _num_clauses; c++) {
         clause* cl = &(_clauses[c]);
-        cl->sat_count = 0;                // 子句中已被满足的文字数
-        cl->weight = 1;                   // 子句权重
-        cl->min_delta = max_int;          // 子句中所有文字的最小 delta
-        for (int l_idx : cl->literals) {  // 遍历子句中的文字
-            __int128_t delta = _lits[std::abs(l_idx)].delta;
-            bool is_equal = _lits[std::abs(l_idx)].is_equal;
-            if (!_lits[std::abs(l_idx)].is_lia_lit) {
-                if ((_solution[delta] > 0 && l_idx > 0) || (_solution[delta] < 0 && l_idx < 0)) {
-                    cl->sat_count++;
-                }
-            }  // bool lit
-            else if ((!is_equal && ((delta <= 0 && l_idx > 0) || (delta > 0 && l_idx < 0))) || (is_equal && ((delta == 0 && l_idx > 0) || (delta != 0 && l_idx < 0)))) {
-                cl->sat_count++;
-            }  // lia lit
-            pos_delta = delta;
-            convert_to_pos_delta(pos_delta, l_idx);
-            if (pos_delta < cl->min_delta) {
-                cl->min_delta = pos_delta;
-                cl->min_delta_lit_index = l_idx;
-            }
-        }
+        int sat_count = 0;
+        __int128_t min_delta = max_int;
+        int min_delta_lit_index = cl->min_delta_lit_index;
+        for (uint64_t k = _clause_row_start[c]; k < _clause_row_start[c + 1]; k++) {
+            int l_idx = _clause_flat_lits[k];
+            __int128_t pos_delta = _lit_dtt[2 * std::abs(l_idx) + (l_idx < 0)];
+            sat_count += (pos_delta == 0);
+            if (pos_delta < min_delta) {
+                min_delta = pos_delta;
+                min_delta_lit_index = l_idx;
+            }
+        }
+        cl->sat_count = sat_count;  // 子句中已被满足的文字数
+        cl->weight = 1;             // 子句权重
+        cl->min_delta = min_delta;  // 子句中所有文字的最小 delta
+        cl->min_delta_lit_index = min_delta_lit_index;
         if (cl->sat_count == 0) {
             unsat_a_clause(c);
             _lit_in_unsat_clause_num += _clauses[c].literals.size();
@@ -982,7 +1088,10 @@ void ls_sampler::reduce_clause() {
     reduced_clause_num = 0;
     for (; i < _num_clauses; i++) {  // Remove already deleted clauses in _clause
         if (!_clauses[i].is_delete) {
-            _clauses[reduced_clause_num++] = _clauses[i];
+            if (reduced_clause_num != i) {
+                _clauses[reduced_clause_num] = std::move(_clauses[i]);
+            }
+            reduced_clause_num++;
         }
     }
     _clauses.resize(reduced_clause_num);
@@ -1006,48 +1115,100 @@ void ls_sampler::reduce_clause() {
     }  // transfer the _resolution_vars to _vars
     _num_clauses = reduced_clause_num;
     _lit_appear.resize(_num_lits + _additional_len, false);  // 去重
+    // counting pass: map the literals to reduced vars and count the occurrences and distinct clauses of every var
+    // the occurrence arrays stay per-var vectors reserved to these counts, a shared arena would only save their
+    // headers and allocation overhead (about 1 MB at 20k vars, of 100 MB held by the instance)
+    std::vector<uint32_t> num_occs;
+    std::vector<uint32_t> num_occ_clauses;
+    std::vector<int> last_clause;
+    auto count_occurrence = [&](uint64_t var_idx, int clause_idx) {
+        if (var_idx >= num_occs.size()) {
+            num_occs.resize(_vars.size(), 0);
+            num_occ_clauses.resize(_vars.size(), 0);
+            last_clause.resize(_vars.size(), -1);
+        }
+        num_occs[var_idx]++;
+        if (last_clause[var_idx] != clause_idx) {
+            last_clause[var_idx] = clause_idx;
+            num_occ_clauses[var_idx]++;
+        }
+    };
     for (int clause_idx = 0; clause_idx < reduced_clause_num; clause_idx++) {
-        _clauses[clause_idx].weight = 1;
-        for (int k = 0; k < _clauses[clause_idx].literals.size(); k++) {  // constructor variable set
-            int l_sign_idx = _clauses[clause_idx].literals[k];
+        clause& cl = _clauses[clause_idx];
+        cl.weight = 1;
+        uint32_t num_lia = 0, num_bool = 0;
+        for (int l_sign_idx : cl.literals) {  // constructor variable set
             lit* l = &(_lits[std::abs(l_sign_idx)]);
             if (l->is_lia_lit) {
-                variable* v;
                 for (int j = 0; j < l->neg_coff.size(); j++) {
                     if (!_lit_appear[l->lits_index]) {  // 标记哪些文字出现于约简后的子句中
                         l->neg_coff_var_idx[j] = (int)transfer_name_to_reduced_var(_resolution_vars[l->neg_coff_var_idx[j]].var_name, true, false);
                     }
+                    count_occurrence(l->neg_coff_var_idx[j], clause_idx);
+                }
+                for (int j = 0; j < l->pos_coff.size(); j++) {
+                    if (!_lit_appear[l->lits_index]) {
+                        l->pos_coff_var_idx[j] = (int)transfer_name_to_reduced_var(_resolution_vars[l->pos_coff_var_idx[j]].var_name, true, false);
+                    }
+                    count_occurrence(l->pos_coff_var_idx[j], clause_idx);
+                }
+                num_lia++;
+            } else {
+                if (l->lits_index == 0)
+                    continue;
+                if (!_lit_appear[l->lits_index]) {
+                    l->delta = transfer_name_to_reduced_var(_resolution_vars[l->delta].var_name, false, false);
+                }
+                count_occurrence(l->delta, clause_idx);
+                num_bool++;
+            }
+            if (!_lit_appear[l->lits_index]) {
+                _lit_appear[l->lits_index] = true;
+            }
+        }
+        cl.lia_literals.reserve(num_lia);
+        cl.bool_literals.reserve(num_bool);
+    }
+    num_occs.resize(_vars.size(), 0);
+    num_occ_clauses.resize(_vars.size(), 0);
+    for (uint64_t var_idx = 0; var_idx < _vars.size(); var_idx++) {
+        variable& v = _vars[var_idx];
+        v.literals.reserve(num_occs[var_idx]);
+        v.literal_clause.reserve(num_occs[var_idx]);
+        if (v.is_lia) {
+            v.literal_coff.reserve(num_occs[var_idx]);
+        }
+        v.clause_idxs.reserve(num_occ_clauses[var_idx]);
+    }
+    // fill pass: every push_back below stays within the counted capacity
+    for (int clause_idx = 0; clause_idx < reduced_clause_num; clause_idx++) {
+        clause& cl = _clauses[clause_idx];
+        for (int l_sign_idx : cl.literals) {
+            lit* l = &(_lits[std::abs(l_sign_idx)]);
+            if (l->is_lia_lit) {
+                variable* v;
+                for (int j = 0; j < l->neg_coff.size(); j++) {
                     v = &(_vars[l->neg_coff_var_idx[j]]);
                     v->literals.push_back(l_sign_idx);
                     v->literal_clause.push_back(clause_idx);
                     v->literal_coff.push_back(-l->neg_coff[j]);
                 }
                 for (int j = 0; j < l->pos_coff.size(); j++) {
-                    if (!_lit_appear[l->lits_index]) {
-                        l->pos_coff_var_idx[j] = (int)transfer_name_to_reduced_var(_resolution_vars[l->pos_coff_var_idx[j]].var_name, true, false);
-                    }
                     v = &(_vars[l->pos_coff_var_idx[j]]);
                     v->literals.push_back(l_sign_idx);
                     v->literal_clause.push_back(clause_idx);
                     v->literal_coff.push_back(l->pos_coff[j]);
                 }
-                _clauses[clause_idx].lia_literals.push_back(l_sign_idx);
+                cl.lia_literals.push_back(l_sign_idx);
             } else {
                 if (l->lits_index == 0)
                     continue;
-                if (!_lit_appear[l->lits_index]) {
-                    l->delta = transfer_name_to_reduced_var(_resolution_vars[l->delta].var_name, false, false);
-                }
                 _vars[l->delta].literals.push_back(l_sign_idx);
                 _vars[l->delta].literal_clause.push_back(clause_idx);
-                _clauses[clause_idx].bool_literals.push_back(l_sign_idx);
-            }
-            if (!_lit_appear[l->lits_index]) {
-                _lit_appear[l->lits_index] = true;
+                cl.bool_literals.push_back(l_sign_idx);
             }
         }
     }  // determine the literals of _vars
-    _vars.resize(_vars.size());
     _num_vars = _vars.size();
     _num_lia_vars = 0;
     for (variable& v : _vars) {
@@ -1060,8 +1221,9 @@ void ls_sampler::reduce_clause() {
             }
         }
         if (v.is_lia) {
-            v.upper_bound = _resolution_vars[transfer_name_to_resolution_var(v.var_name, true, false)].upper_bound;
-            v.low_bound = _resolution_vars[transfer_name_to_resolution_var(v.var_name, true, false)].low_bound;
+            const variable& rv = _resolution_vars[transfer_name_to_resolution_var(v.var_name, true, false)];
+            v.upper_bound = rv.upper_bound;
+            v.low_bound = rv.low_bound;
             _num_lia_vars++;
         }
     }  // determine the clause_idxs of var
@@ -1075,6 +1237,7 @@ void ls_sampler::reduce_clause() {
             max_lit_num = _vars[var_idx].literals.size();
         }
     }
+    is_idl = true;
     for (int lit_idx = 0; lit_idx < _lits.size(); lit_idx++) {
         lit* l = &(_lits[lit_idx]);
         if (l->lits_index == 0 || !l->is_lia_lit) {
@@ -1091,13 +1254,10 @@ void ls_sampler::reduce_clause() {
 uint64_t ls_sampler::transfer_name_to_reduced_var(std::string& name, bool is_lia, bool in_equal) {
     if (_name2var.find(name) == _name2var.end()) {
         _name2var[name] = _vars.size();
-        variable var;
+        variable& var = _vars.emplace_back();
         var.var_name = name;
         var.is_lia = is_lia;
-        if (var.is_in_equal == false) {
-            var.is_in_equal = in_equal;
-        }
-        _vars.push_back(var);
+        var.is_in_equal = in_equal;
         if (is_lia) {
             _lia_var_vec.push_back((int)_vars.size() - 1);
         } else {
@@ -1139,6 +1299,10 @@ void ls_sampler::set_pre_value() {
 
 // Constructing constraint instances
 void ls_sampler::build_instance(std::vector<std::vector<int>>& clause_vec, const std::unordered_map<std::string, std::string>& model) {
+    std::chrono::steady_clock::time_point build_start = std::chrono::steady_clock::now();
+    if (_trace) {
+        trace_instance(clause_vec, model);
+    }
     last_cdcl_model = model;
 
     // iterate over all clauses
@@ -1185,27 +1349,43 @@ void ls_sampler::build_instance(std::vector<std::vector<int>>& clause_vec, const
     }
 
     reduce_vars();  // handling of differential terms
+    if (eliminate_equalities) {
+        eliminate_unit_equalities(clause_vec);
+    }
 
     // Converting Clause Sets 'clause_vec' to Internal Data Structures '_clauses'
-    _clauses.resize(clause_vec.size());
-    _num_clauses = 0;
-    for (auto clause_curr : clause_vec) {
-        bool is_tautology = false;
-        for (auto l_idx : clause_curr) {
+    auto is_tautology = [&](const std::vector<int>& clause_curr) {
+        for (int l_idx : clause_curr) {
             if (_lits[std::abs(l_idx)].lits_index == 0) {
-                is_tautology = true;
-                break;
+                return true;
             }
         }
-        if (is_tautology) {
+        return false;
+    };
+    // counting pass: the clause lists of the boolean vars are filled within their counted size
+    std::vector<uint32_t> num_bool_occs(_resolution_vars.size(), 0);
+    for (const auto& clause_curr : clause_vec) {
+        if (is_tautology(clause_curr)) {
             continue;
         }
-        for (auto l_idx : clause_curr) {
-            _clauses[_num_clauses].literals.push_back(l_idx);
-            lit* l = &(_lits[std::abs(l_idx)]);
-            if (l->lits_index == 0) {  // true literal
-                continue;
+        for (int l_idx : clause_curr) {
+            if (!_lits[std::abs(l_idx)].is_lia_lit) {
+                num_bool_occs[_lits[std::abs(l_idx)].delta]++;
             }
+        }
+    }
+    for (uint64_t var_idx = 0; var_idx < _resolution_vars.size(); var_idx++) {
+        _resolution_vars[var_idx].clause_idxs.reserve(num_bool_occs[var_idx]);
+    }
+    _clauses.resize(clause_vec.size());
+    _num_clauses = 0;
+    for (const auto& clause_curr : clause_vec) {
+        if (is_tautology(clause_curr)) {
+            continue;
+        }
+        _clauses[_num_clauses].literals = clause_curr;
+        for (int l_idx : clause_curr) {
+            lit* l = &(_lits[std::abs(l_idx)]);
             if (!l->is_lia_lit) {  // Marks which clause the boolean variable belongs to
                 _resolution_vars[l->delta].clause_idxs.push_back(_num_clauses);
             }
@@ -1288,6 +1468,17 @@ void ls_sampler::build_instance(std::vector<std::vector<int>>& clause_vec, const
 #endif
 
     calc_var_intervals();
+    build_restart_matrix();
+    _use_pb_engine = pb_applicable();
+    if (_use_pb_engine) {
+        build_pb_structures();
+    }
+    _use_idl_engine = idl_applicable();
+    if (_use_idl_engine) {
+        build_idl_structures();
+    }
+    _build_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - build_start).count();
+    _instance_bytes = instance_bytes();
 
 #ifdef VERBOSE
     std::cout << "num euqal_cnt(==): " << _eq_form_cnt << "\n";
@@ -1298,12 +1489,34 @@ void ls_sampler::build_instance(std::vector<std::vector<int>>& clause_vec, const
 #endif
 }
 
+// heap bytes of the vars, literals and clauses (capacities, the strings of the var names excluded)
+size_t ls_sampler::instance_bytes() const {
+    size_t bytes = 0;
+    for (const std::vector<variable>* vars : {&_resolution_vars, &_tmp_vars, &_vars}) {
+        bytes += vars->capacity() * sizeof(variable);
+        for (const variable& v : *vars) {
+            bytes += v.literals.capacity() * sizeof(int) + v.literal_clause.capacity() * sizeof(int) +
+                     v.literal_coff.capacity() * sizeof(__int128_t) + v.clause_idxs.capacity() * sizeof(uint64_t);
+        }
+    }
+    bytes += _lits.capacity() * sizeof(lit);
+    for (const lit& l : _lits) {
+        bytes += (l.pos_coff_var_idx.capacity() + l.neg_coff_var_idx.capacity()) * sizeof(int) +
+                 (l.pos_coff.capacity() + l.neg_coff.capacity()) * sizeof(__int128_t);
+    }
+    bytes += _clauses.capacity() * sizeof(clause);
+    for (const clause& cl : _clauses) {
+        bytes += (cl.literals.capacity() + cl.lia_literals.capacity() + cl.bool_literals.capacity()) * sizeof(int);
+    }
+    return bytes + _idl_occ.capacity() * sizeof(idl_occurrence);
+}
+
 void ls_sampler::reduce_vars() {
     const uint64_t tmp_vars_size = _tmp_vars.size();
-    std::vector<int> hash_map(tmp_vars_size * tmp_vars_size, 0);  // hash_map[A*(size)+b]=n means A-B has occurred n times
+    std::map<std::pair<int, int>, int> pair_count;                // pair_count[(A,B)]=n, A<B, means A-B has occurred n times
     std::vector<int> occur_time(tmp_vars_size, 0);                // occur_time[a]=n means that a has occured in lits for n times
-    pair_x = new Array((int)tmp_vars_size);
-    pair_y = new Array((int)tmp_vars_size);
+    reset_array(pair_x, (int)tmp_vars_size);
+    reset_array(pair_y, (int)tmp_vars_size);
     lit* l;
     variable* original_var;
     variable* new_var;
@@ -1332,7 +1545,7 @@ void ls_sampler::reduce_vars() {
         _resolution_vars = _tmp_vars;
     }  // if there is no boolean vars and all lia vars are in [0,1], then use pbs, and no need to reduce the vars
     else {
-        // calculate the hash_map
+        // count the x-y pairs
         for (uint64_t l_idx = 0; l_idx < _num_lits; l_idx++) {
             l = &(_lits[l_idx]);
 
@@ -1348,10 +1561,10 @@ void ls_sampler::reduce_vars() {
                     }
                     neg_var_idx = l->neg_coff_var_idx[j];
                     if (neg_var_idx < pos_var_idx) {
-                        hash_map[neg_var_idx * tmp_vars_size + pos_var_idx]++;
-                    }  // small_idx* num_var+ large_idx
+                        pair_count[{neg_var_idx, pos_var_idx}]++;
+                    }  // (small_idx, large_idx)
                     else {
-                        hash_map[pos_var_idx * tmp_vars_size + neg_var_idx]++;
+                        pair_count[{pos_var_idx, neg_var_idx}]++;
                     }
                 }
             }
@@ -1377,12 +1590,15 @@ void ls_sampler::reduce_vars() {
             if (pair_y->is_in_array(pre_idx) || occur_time[pre_idx] == 0) {
                 continue;
             }  // prevent reinsert
-            for (int pos_idx = pre_idx + 1; pos_idx < tmp_vars_size; pos_idx++) {
+            // only pairs that occurred can match, visited in increasing pos_idx
+            auto it_end = pair_count.lower_bound({pre_idx + 1, 0});
+            for (auto it = pair_count.lower_bound({pre_idx, 0}); it != it_end; ++it) {
+                int pos_idx = it->first.second;
                 if (pair_y->is_in_array(pos_idx)) {
                     continue;
                 }  // prevent reinsert
-                if (hash_map[pre_idx * tmp_vars_size + pos_idx] == occur_time[pre_idx] &&  // A-B occurs the same number of times that A occurs
-                    occur_time[pre_idx] == occur_time[pos_idx]) {                          // A occurs the same number of times as B
+                if (it->second == occur_time[pre_idx] &&  // A-B occurs the same number of times that A occurs
+                    occur_time[pre_idx] == occur_time[pos_idx]) {  // A occurs the same number of times as B
                     pair_x->insert_element(pre_idx);
                     pair_y->insert_element(pos_idx);
                     break;
@@ -1511,6 +1727,158 @@ void ls_sampler::reduce_vars() {
     }
 }
 
+// signed (var, coff) terms of a lia literal: pos coffs, then negated neg coffs
+static void lit_terms(const lit& l, std::map<int, __int128_t>& terms) {
+    terms.clear();
+    for (size_t i = 0; i < l.pos_coff.size(); i++) {
+        terms[l.pos_coff_var_idx[i]] += l.pos_coff[i];
+    }
+    for (size_t i = 0; i < l.neg_coff.size(); i++) {
+        terms[l.neg_coff_var_idx[i]] -= l.neg_coff[i];
+    }
+}
+
+/*
+    \brief Solve the unit equalities (a single positive equal literal in a clause) over the unbounded lia vars.
+    An equality with a coefficient +-1 on such a var p is a unimodular pivot: p is replaced in every other
+    literal by the integer-affine expression the equality gives, and the equality is dropped.  LS then moves
+    only the remaining (free) vars; the value of p is restored by choose_value_for_eliminated.
+    Equalities without a unit pivot stay as equal literals.
+*/
+void ls_sampler::eliminate_unit_equalities(std::vector<std::vector<int>>& clause_vec) {
+    _eliminated_vars.clear();
+    _name2eliminated.clear();
+    std::vector<std::vector<int>> var_lits(_resolution_vars.size());  // lia var -> live literals containing it
+    for (uint64_t l_idx = 0; l_idx < _num_lits; l_idx++) {
+        lit* l = &(_lits[l_idx]);
+        if (l->lits_index == 0 || !l->is_lia_lit) {
+            continue;
+        }
+        for (int v : l->pos_coff_var_idx) {
+            var_lits[v].push_back((int)l_idx);
+        }
+        for (int v : l->neg_coff_var_idx) {
+            var_lits[v].push_back((int)l_idx);
+        }
+    }
+    std::vector<int> eq_lits;
+    for (auto& clause_curr : clause_vec) {
+        if (clause_curr.size() == 1 && clause_curr[0] > 0) {
+            lit* l = &(_lits[clause_curr[0]]);
+            if (l->lits_index != 0 && l->is_lia_lit && l->is_equal) {
+                eq_lits.push_back(clause_curr[0]);
+            }
+        }
+    }
+
+    std::vector<bool> eliminated(_resolution_vars.size(), false);
+    std::vector<bool> eq_removed(_num_lits, false);
+    std::map<int, __int128_t> eq_terms, terms;
+    std::vector<std::pair<int, lit>> rewritten;
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (int e_idx : eq_lits) {
+            lit* e = &(_lits[e_idx]);
+            if (eq_removed[e_idx]) {
+                continue;
+            }
+            lit_terms(*e, eq_terms);
+            // the pivot: a unit coefficient on an unbounded var, the one in the fewest literals
+            int pivot = -1;
+            __int128_t pivot_coff = 0;
+            for (auto& [v, c] : eq_terms) {
+                variable* var = &(_resolution_vars[v]);
+                if ((c != 1 && c != -1) || !var->is_lia || eliminated[v] || var->low_bound != -max_int ||
+                    var->upper_bound != max_int || var->var_name.rfind("_new_var_", 0) == 0) {
+                    continue;
+                }
+                if (pivot == -1 || var_lits[v].size() < var_lits[pivot].size()) {
+                    pivot = v;
+                    pivot_coff = c;
+                }
+            }
+            if (pivot == -1) {
+                continue;
+            }
+            // l + f * e with f = -a * pivot_coff cancels the a * pivot term of l
+            rewritten.clear();
+            bool overflow = false;
+            for (int l_idx : var_lits[pivot]) {
+                lit* l = &(_lits[l_idx]);
+                if (l_idx == e_idx || l->lits_index == 0) {
+                    continue;
+                }
+                lit_terms(*l, terms);
+                auto it = terms.find(pivot);
+                if (it == terms.end() || it->second == 0) {
+                    continue;
+                }
+                __int128_t f = -it->second * pivot_coff, tmp;
+                lit new_lit;
+                new_lit.lits_index = l->lits_index;
+                new_lit.is_equal = l->is_equal;
+                new_lit.is_lia_lit = true;
+                overflow |= __builtin_mul_overflow(f, e->key, &tmp);
+                overflow |= __builtin_add_overflow(l->key, tmp, &new_lit.key);
+                for (auto& [v, c] : eq_terms) {
+                    overflow |= __builtin_mul_overflow(f, c, &tmp);
+                    overflow |= __builtin_add_overflow(terms[v], tmp, &terms[v]);
+                }
+                for (auto& [v, c] : terms) {
+                    if (c > 0) {
+                        new_lit.pos_coff.push_back(c);
+                        new_lit.pos_coff_var_idx.push_back(v);
+                    } else if (c < 0) {
+                        new_lit.neg_coff.push_back(-c);
+                        new_lit.neg_coff_var_idx.push_back(v);
+                    }
+                }
+                rewritten.push_back({l_idx, new_lit});
+            }
+            if (overflow) {
+                continue;
+            }
+            for (auto& [l_idx, new_lit] : rewritten) {
+                _lits[l_idx] = new_lit;
+                for (auto& [v, c] : eq_terms) {
+                    if (v != pivot && std::find(var_lits[v].begin(), var_lits[v].end(), l_idx) == var_lits[v].end()) {
+                        var_lits[v].push_back(l_idx);
+                    }
+                }
+            }
+            // pivot = -pivot_coff * (key + rest of e)
+            eliminated_var ev;
+            ev.var_name = _resolution_vars[pivot].var_name;
+            ev.key = -pivot_coff * e->key;
+            for (auto& [v, c] : eq_terms) {
+                if (v != pivot) {
+                    ev.terms.push_back({_resolution_vars[v].var_name, -pivot_coff * c});
+                }
+            }
+            _name2eliminated[ev.var_name] = (int)_eliminated_vars.size();
+            _eliminated_vars.push_back(ev);
+            eliminated[pivot] = true;
+            eq_removed[e_idx] = true;
+            e->lits_index = 0;  // the unit clause and the clauses containing e are satisfied
+            progress = true;
+        }
+    }
+    if (_eliminated_vars.empty()) {
+        return;
+    }
+    // the negation of an eliminated equality is false
+    for (auto& clause_curr : clause_vec) {
+        clause_curr.erase(std::remove_if(clause_curr.begin(), clause_curr.end(), [&](int l_sign_idx) {
+                              return l_sign_idx < 0 && eq_removed[-l_sign_idx];
+                          }),
+                          clause_curr.end());
+    }
+#ifdef VERBOSE
+    std::cout << "num eliminated equalities: " << _eliminated_vars.size() << "\n";
+#endif
+}
+
 void ls_sampler::ls_sampling() {
     _total_start = std::chrono::steady_clock::now();
 
@@ -1518,8 +1886,11 @@ void ls_sampler::ls_sampling() {
         print_interal_data_strcture(tout););
 
     SASSERT(_num_vars == _vars.size());
-    for (variable v : _tmp_vars) {
+    for (const variable& v : _tmp_vars) {
         if (v.low_bound > v.upper_bound) {
+            if (_trace) {
+                end_trace();
+            }
             return;
         }
     }
@@ -1529,22 +1900,101 @@ void ls_sampler::ls_sampling() {
 #endif
 
     _num_vars = _vars.size();
+    if (bit_guided) {
+        load_seen_bits();
+    }
+    _score_cache_lookups = 0;
+    _score_cache_hits = 0;
 
     SAMPLER_TRACE(
         print_interal_data_strcture(tout););
 
     search();
+    if (_trace) {
+        end_trace();
+    }
 
 #ifdef DEBUG
     check_solution();
 #endif
 }
 
+void ls_sampler::load_seen_bits() {
+    _seen_one.resize(_num_vars);
+    _seen_zero.resize(_num_vars);
+    _sample_bits.resize(_num_vars);
+    _gain_stamp.assign(_num_vars, 0);
+    _gain_value.assign(_num_vars, 0);
+    _gain_base.assign(_num_vars, 0);
+    _seen_stamp++;
+    _num_coverable_bits = 0;
+    for (size_t i = 0; i < _num_vars; ++i) {
+        if (!_vars[i].is_lia) {
+            continue;
+        }
+        _num_coverable_bits += bit_width;
+        auto it = _seen_bits->find(_vars[i].var_name);
+        if (it != _seen_bits->end()) {
+            _seen_one.set_var(i, it->second.first);
+            _seen_zero.set_var(i, it->second.second);
+        }
+    }
+    _num_covered_bits = _seen_one.count_and(_seen_zero);
+}
+
+// a bit of a var is covered once some sample had it as 1 and some sample had it as 0
+void ls_sampler::record_sample_bits() {
+    for (size_t i = 0; i < _num_vars; ++i) {
+        _sample_bits.set_var(i, _vars[i].is_lia ? (__uint128_t)_solution[i] : 0);
+    }
+    _seen_one.merge(_sample_bits);
+    for (size_t i = 0; i < _num_vars; ++i) {
+        _sample_bits.set_var(i, _vars[i].is_lia ? ~(__uint128_t)_solution[i] : 0);
+    }
+    _seen_zero.merge(_sample_bits);
+    _num_covered_bits = _seen_one.count_and(_seen_zero);
+    _seen_stamp++;
+
+    for (size_t i = 0; i < _num_vars; ++i) {
+        if (_vars[i].is_lia) {
+            (*_seen_bits)[_vars[i].var_name] = {_seen_one.get_var(i), _seen_zero.get_var(i)};
+        }
+    }
+#ifdef VERBOSE
+    std::cout << "bit coverage: " << _num_covered_bits << " / " << _num_coverable_bits << "\n";
+#endif
+#ifdef PRINT_UNCOV_BITS
+    for (size_t i = 0; i < _num_vars; ++i) {
+        if (_vars[i].is_lia) {
+            std::cout << "  " << _vars[i].var_name << " uncovered bits: " << bit_width - SampleBitSet::popcount128(_seen_one.get_var(i) & _seen_zero.get_var(i)) << "\n";
+        }
+    }
+#endif
+}
+
+int ls_sampler::unseen_bits(uint64_t var_idx, __int128_t value) const {
+    __uint128_t v = (__uint128_t)value;
+    return SampleBitSet::popcount128((v & ~_seen_one.get_var(var_idx)) | (~v & ~_seen_zero.get_var(var_idx)));
+}
+
+// the unseen bits of the current value only change with the value or a new sample, so they are kept per var
+int ls_sampler::bit_gain(uint64_t var_idx, __int128_t change_value) {
+    if (_gain_stamp[var_idx] != _seen_stamp || _gain_value[var_idx] != _solution[var_idx]) {
+        _gain_stamp[var_idx] = _seen_stamp;
+        _gain_value[var_idx] = _solution[var_idx];
+        _gain_base[var_idx] = unseen_bits(var_idx, _solution[var_idx]);
+    }
+    return unseen_bits(var_idx, (__int128_t)((__uint128_t)_solution[var_idx] + (__uint128_t)change_value)) - _gain_base[var_idx];
+}
+
 bool ls_sampler::search() {
+    if (_use_pb_engine) {
+        return pb_search();
+    }
     initialize();
 
 #ifdef DEBUG
-    for (variable v : _tmp_vars) {  // check the bound condition of vars
+    for (const variable& v : _tmp_vars) {  // check the bound condition of vars
         if (v.low_bound > v.upper_bound) {
             std::cout << "bound error!\n";
             return false;
@@ -1586,8 +2036,12 @@ bool ls_sampler::search() {
             std::cout << "_overflow_cnt = " << _overflow_cnt << "\n";
 #endif
             choose_value_for_pair();  // 为前面化简的 IDL 变量赋值
+            choose_value_for_eliminated();
             up_bool_vars();
             SASSERT(!is_overflow);
+            if (bit_guided) {
+                record_sample_bits();
+            }
             return true;
         }
 
@@ -1603,7 +2057,11 @@ bool ls_sampler::search() {
 #ifdef VERBOSE
             std::cout << "restart(step out)...\n";
 #endif
-            initialize();
+            if (_warm_restart_pct > 0) {
+                warm_restart();
+            } else {
+                initialize();
+            }
             no_improve_cnt = 0;
         }
         if (!use_swap_from_from_small_weight || mt() % 100 < 99 || _sat_clause_with_false_literal->size() == 0) {
@@ -1683,6 +2141,9 @@ void ls_sampler::up_bool_vars() {
 
             __int128_t random_val = random_int64_in_range(var.s_lower_bound, var.s_upper_bound);
             SASSERT(random_val >= var.low_bound && random_val <= var.upper_bound);
+            if (_solution.size() <= (size_t)var_idx) {  // more restored vars than the spare slots of make_space
+                _solution.resize(var_idx + 1);
+            }
             _solution[var_idx] = random_val;
         }
     }  // set the var solution
@@ -1793,6 +2254,33 @@ void ls_sampler::choose_value_for_pair() {  // x - y = val
     }
 }
 
+// value of a lia var of the reduced formula, or of a var it does not contain (its bound, else 0)
+__int128_t ls_sampler::reduced_var_value(const std::string& var_name) {
+    auto it = _name2var.find(var_name);
+    if (it != _name2var.end()) {
+        return _solution[it->second];
+    }
+    variable* v = &(_resolution_vars[_name2resolution_var[var_name]]);
+    if (v->low_bound != -max_int) {
+        return v->low_bound;
+    }
+    return (v->upper_bound != max_int) ? v->upper_bound : 0;
+}
+
+// eliminated vars depend only on vars eliminated after them, so evaluate them from the last one
+void ls_sampler::choose_value_for_eliminated() {
+    _eliminated_values.assign(_eliminated_vars.size(), 0);
+    for (int k = (int)_eliminated_vars.size() - 1; k >= 0; k--) {
+        __int128_t value = _eliminated_vars[k].key;
+        for (auto& [name, coff] : _eliminated_vars[k].terms) {
+            auto it = _name2eliminated.find(name);
+            __int128_t term_value = (it != _name2eliminated.end()) ? _eliminated_values[it->second] : reduced_var_value(name);
+            value += coff * term_value;
+        }
+        _eliminated_values[k] = value;
+    }
+}
+
 bool ls_sampler::update_inner_best_solution() {
     if (_unsat_clauses->size() < _best_found_hard_cost_this_lia) {
         _best_found_hard_cost_this_lia = _unsat_clauses->size();
@@ -1823,7 +2311,11 @@ void ls_sampler::enter_bool_mode() {
 
 // sat or unsat a clause, update the delta, dedicated for lia var
 void ls_sampler::critical_score_subscore(uint64_t var_idx, __int128_t change_value) {
-    static std::vector<int> lit_exist(_num_lits + _additional_len, 0);
+    if (_use_idl_engine) {
+        idl_critical_score_subscore(var_idx, change_value);
+        return;
+    }
+    std::vector<int>& lit_exist = _lit_exist;
     variable* var = &(_vars[var_idx]);
     lit* l;
     clause* cp;
@@ -2055,6 +2547,9 @@ void ls_sampler::critical_score_subscore(uint64_t var_idx) {
 
 // calculate score
 __int128_t ls_sampler::critical_score(uint64_t var_idx, __int128_t change_value) {
+    if (_use_idl_engine) {
+        return idl_critical_score(var_idx, change_value);
+    }
     lit* l;
     clause* cp;
     __int128_t critical_score = 0;
@@ -2062,6 +2557,7 @@ __int128_t ls_sampler::critical_score(uint64_t var_idx, __int128_t change_value)
     __int128_t tmp;
     // number of make_lits in a clause
     int make_break_in_clause = 0;
+    _score_makes = 0;
     variable* var = &(_vars[var_idx]);
     for (int i = 0; i < var->literals.size(); i++) {
         l = &(_lits[std::abs(var->literals[i])]);
@@ -2091,9 +2587,10 @@ __int128_t ls_sampler::critical_score(uint64_t var_idx, __int128_t change_value)
         // enter a new clause or the last literal
         if ((i != (var->literals.size() - 1) && l_clause_idx != var->literal_clause[i + 1]) || i == (var->literals.size() - 1)) {
             cp = &(_clauses[abs_128(l_clause_idx)]);
-            if (cp->sat_count == 0 && cp->sat_count + make_break_in_clause > 0)
+            if (cp->sat_count == 0 && cp->sat_count + make_break_in_clause > 0) {
                 critical_score += cp->weight;
-            else if (cp->sat_count > 0 && cp->sat_count + make_break_in_clause == 0)
+                _score_makes++;
+            } else if (cp->sat_count > 0 && cp->sat_count + make_break_in_clause == 0)
                 critical_score -= cp->weight;
             make_break_in_clause = 0;
         }
@@ -2102,10 +2599,69 @@ __int128_t ls_sampler::critical_score(uint64_t var_idx, __int128_t change_value)
     return critical_score;
 }
 
+void ls_sampler::reset_score_cache() {
+    if (_score_cache.size() < 2 * _vars.size()) {
+        _score_cache.resize(2 * _vars.size());
+        _var_score_version.resize(_vars.size(), 0);
+    }
+    _score_reset_version = ++_score_version;
+}
+
+// every lia var of the clause has to be rescored
+void ls_sampler::dirty_clause(int clause_idx) {
+    for (int l_sign_idx : _clauses[clause_idx].lia_literals) {
+        lit* l = &(_lits[std::abs(l_sign_idx)]);
+        for (int v : l->pos_coff_var_idx) {
+            _var_score_version[v] = _score_version;
+        }
+        for (int v : l->neg_coff_var_idx) {
+            _var_score_version[v] = _score_version;
+        }
+    }
+}
+
+// moving var changes the deltas of its literals and the sat counts of its clauses
+void ls_sampler::dirty_var_neighbourhood(uint64_t var_idx) {
+    variable* var = &(_vars[var_idx]);
+    ++_score_version;
+    for (size_t i = 0; i < var->literal_clause.size(); i++) {
+        if (i == 0 || var->literal_clause[i] != var->literal_clause[i - 1]) {
+            dirty_clause(var->literal_clause[i]);
+        }
+    }
+}
+
+__int128_t ls_sampler::cached_critical_score(uint64_t var_idx, __int128_t change_value) {
+    if (_trace) {
+        _trace->event(LS_TRACE_SCORE, var_idx, change_value);
+    }
+    if (!score_cache) {
+        return critical_score(var_idx, change_value);
+    }
+    _score_cache_lookups++;
+    score_cache_entry& e = _score_cache[2 * var_idx + (change_value > 0 ? 1 : 0)];
+    if (e.change_value == change_value && e.version >= _score_reset_version && e.version >= _var_score_version[var_idx]) {
+        // no clause of the var changed its sat count since, so every bump raised the weight of the same made clauses
+        _score_cache_hits++;
+        e.score += (__int128_t)e.makes * (__int128_t)(_weight_bumps - e.weight_bumps);
+        e.weight_bumps = _weight_bumps;
+        return e.score;
+    }
+    __int128_t score = critical_score(var_idx, change_value);
+    if (!is_overflow) {  // an overflowing score triggers a restart, do not keep it
+        e.change_value = change_value;
+        e.score = score;
+        e.version = _score_version;
+        e.weight_bumps = _weight_bumps;
+        e.makes = _score_makes;
+    }
+    return score;
+}
+
 void ls_sampler::modify_CC(uint64_t var_idx, int direction) {
 }
 
-void ls_sampler::insert_operation(int var_idx, __int128_t change_value, int& operation_idx) {
+bool ls_sampler::legal_move(int var_idx, __int128_t change_value) {
     __int128_t future_solution = _solution[var_idx] + change_value;
     bool no_pre_value = (_pre_value_1[var_idx] == INT32_MAX && _pre_value_2[var_idx] == INT32_MAX &&
                          future_solution >= _vars[var_idx].low_bound && future_solution <= _vars[var_idx].upper_bound);
@@ -2113,26 +2669,21 @@ void ls_sampler::insert_operation(int var_idx, __int128_t change_value, int& ope
                             future_solution == _pre_value_1[var_idx]);
     bool has_pre_value_2 = (_pre_value_1[var_idx] != INT32_MAX && _pre_value_2[var_idx] != INT32_MAX &&
                             (future_solution == _pre_value_1[var_idx] || future_solution == _pre_value_2[var_idx]));
-    if (no_pre_value || has_pre_value_1 || has_pre_value_2) {  // if the change is legal, the change is recorded
-        //    if(future_solution>=_vars[var_idx].low_bound&&future_solution<=_vars[var_idx].upper_bound){
+    return no_pre_value || has_pre_value_1 || has_pre_value_2;
+}
+
+void ls_sampler::insert_operation(int var_idx, __int128_t change_value, int& operation_idx) {
+    if (legal_move(var_idx, change_value)) {                          // if the change is legal, the change is recorded
         _operation_var_idx_vec[operation_idx] = var_idx;              // op var
         _operation_change_value_vec[operation_idx++] = change_value;  // op val
     }
 }
 
 void ls_sampler::insert_operation(int var_idx, __int128_t change_value, int& operation_idx, int const& flip_lit) {
-    __int128_t future_solution = _solution[var_idx] + change_value;
-    bool no_pre_value = (_pre_value_1[var_idx] == INT32_MAX && _pre_value_2[var_idx] == INT32_MAX &&
-                         future_solution >= _vars[var_idx].low_bound && future_solution <= _vars[var_idx].upper_bound);
-    bool has_pre_value_1 = (_pre_value_1[var_idx] != INT32_MAX && _pre_value_2[var_idx] == INT32_MAX &&
-                            future_solution == _pre_value_1[var_idx]);
-    bool has_pre_value_2 = (_pre_value_1[var_idx] != INT32_MAX && _pre_value_2[var_idx] != INT32_MAX &&
-                            (future_solution == _pre_value_1[var_idx] || future_solution == _pre_value_2[var_idx]));
-
-    if (no_pre_value || has_pre_value_1 || has_pre_value_2) {         // if the change is legal, the change is recorded
-                                                                      //    if(future_solution>=_vars[var_idx].low_bound&&future_solution<=_vars[var_idx].upper_bound){
+    if (legal_move(var_idx, change_value)) {                          // if the change is legal, the change is recorded
         _operation_var_idx_vec[operation_idx] = var_idx;              // op var
         _operation_lit_idx_vec[operation_idx] = flip_lit;             // op lit
+        _operation_deferred_vec[operation_idx] = false;               // op val is final
         _operation_change_value_vec[operation_idx++] = change_value;  // op val
     }
 }
@@ -2389,6 +2940,131 @@ void ls_sampler::build_occs_closures() {
         } });
 }
 
+/*
+    \brief Collect the lia move candidates that would satisfy a literal of the unsat clause cl;
+    with defer_interval the interval move is postponed until the candidate is scored
+*/
+void ls_sampler::add_clause_operations(clause* cl, int& operation_idx, bool defer_interval) {
+    if (_use_idl_engine) {
+        idl_add_clause_operations(cl, operation_idx, defer_interval);
+        return;
+    }
+    __int128_t change_value = 0;
+    bool should_push_vec;
+    for (int l_sign_ldx : cl->lia_literals) {
+        int l_idx = std::abs(l_sign_ldx);
+        lit* l = &(_lits[l_idx]);
+
+        if (l->is_equal) {
+            // SASSERT(false);
+            if (l_sign_ldx < 0) {  // negative literal, -(a = b) TODO 可以区间采样
+                for (int var_idx : l->pos_coff_var_idx) {
+                    if (_step > _tabulist[2 * var_idx]) {
+                        insert_operation(var_idx, 1, operation_idx, l_idx);
+                    }
+                    if (_step > _tabulist[2 * var_idx + 1]) {
+                        insert_operation(var_idx, -1, operation_idx, l_idx);
+                    }
+                }
+                for (int var_idx : l->neg_coff_var_idx) {
+                    if (_step > _tabulist[2 * var_idx]) {
+                        insert_operation(var_idx, 1, operation_idx, l_idx);
+                    }
+                    if (_step > _tabulist[2 * var_idx + 1]) {
+                        insert_operation(var_idx, -1, operation_idx, l_idx);
+                    }
+                }
+            }  // delta should not be 0, while it is 0, so the var should increase 1/-1
+            else {
+                for (int j = 0; j < l->pos_coff.size(); j++) {
+                    int var_idx = l->pos_coff_var_idx[j];
+                    if ((l->delta % l->pos_coff[j]) != 0) {
+                        continue;
+                    }
+                    if ((l->delta < 0 && _step > _tabulist[2 * var_idx]) ||
+                        (l->delta > 0 && _step > _tabulist[2 * var_idx + 1])) {
+                        insert_operation(var_idx, (-l->delta / l->pos_coff[j]), operation_idx, l_idx);
+                    }
+                }
+                for (int j = 0; j < l->neg_coff.size(); j++) {
+                    int var_idx = l->neg_coff_var_idx[j];
+                    if ((l->delta % l->neg_coff[j]) != 0) {
+                        continue;
+                    }
+                    if ((l->delta > 0 && _step > _tabulist[2 * var_idx]) ||
+                        (l->delta < 0 && _step > _tabulist[2 * var_idx + 1])) {
+                        insert_operation(var_idx, (l->delta / l->neg_coff[j]), operation_idx, l_idx);
+                    }
+                }
+            }  // delta should be 0, while it is not 0, so the var should increase (-delta/coff), while (-delta%coff)==0
+            continue;
+        }
+
+        for (int i = 0; i < l->pos_coff.size(); i++) {
+            should_push_vec = false;
+            int var_idx = l->pos_coff_var_idx[i];
+            if (var_idx == _lia_var_idx_with_most_lits) {
+                continue;
+            }
+            if (l_sign_ldx > 0 && _step > _tabulist[2 * var_idx + 1]) {
+                should_push_vec = true;
+                change_value = devide(-l->delta, l->pos_coff[i]);
+            } else if (l_sign_ldx < 0 && _step > _tabulist[2 * var_idx]) {
+                should_push_vec = true;
+                change_value = devide(1 - l->delta, l->pos_coff[i]);
+            }
+            if (should_push_vec) {
+                add_lia_operation(var_idx, change_value, operation_idx, l_idx, defer_interval);
+            }
+            // if l_idx>0, delta should be <=0, while it is now >0(too large), so the var should enlarge by (-delta/coff) (this is a negative value), if l_idx<0, delta should be >=1, while it is now <1(too small), so the var should enlarge by (1-delta)/coff (positive value)
+        }
+        for (int i = 0; i < l->neg_coff.size(); i++) {
+            should_push_vec = false;
+            int var_idx = l->neg_coff_var_idx[i];
+            if (var_idx == _lia_var_idx_with_most_lits) {
+                continue;
+            }
+            if (l_sign_ldx > 0 && _step > _tabulist[2 * var_idx]) {
+                should_push_vec = true;
+                change_value = devide(l->delta, l->neg_coff[i]);
+            } else if (l_sign_ldx < 0 && _step > _tabulist[2 * var_idx + 1]) {
+                should_push_vec = true;
+                change_value = devide(l->delta - 1, l->neg_coff[i]);
+            }
+            if (should_push_vec) {
+                add_lia_operation(var_idx, change_value, operation_idx, l_idx, defer_interval);
+            }
+            // if l_idx>0, delta should be <=0, while it is now >0(too large), so the var should enlarge by (delta/coff) (this is a positive value since the coff is neg), if l_idx<0, the delta should be >=1, while it is now <1(too small), so the var should enlarge by (delta-1)/coff (neg value)
+        }
+    }
+}
+
+void ls_sampler::add_lia_operation(int var_idx, __int128_t change_value, int& operation_idx, int l_idx, bool defer_interval) {
+#ifndef BAM_V2
+    if (_use_interval_move && !(is_pb || _vars[var_idx].is_in_equal)) {
+        if (defer_interval) {
+            int prev_idx = operation_idx;
+            insert_operation(var_idx, change_value, operation_idx, l_idx);
+            if (operation_idx > prev_idx)
+                _operation_deferred_vec[prev_idx] = true;
+            return;
+        }
+        interval_move(var_idx, change_value);
+    }
+#endif
+    insert_operation(var_idx, change_value, operation_idx, l_idx);
+}
+
+/*
+    \brief Draw an unsat clause, biased towards heavy clauses by a 2-way weight tournament
+*/
+int ls_sampler::sample_unsat_clause() {
+    int n = _unsat_clauses->size();
+    int a = _unsat_clauses->element_at(mt() % n);
+    int b = _unsat_clauses->element_at(mt() % n);
+    return (_clauses[b].weight > _clauses[a].weight) ? b : a;
+}
+
 /*
     \brief Calculate the movement increment 'best_value';
     \return lia variables that need to be changed
@@ -2397,111 +3073,28 @@ int ls_sampler::pick_critical_move(__int128_t& best_value) {
     __int128_t best_score, score;
     int operation_var_idx, operation_lit_idx, best_var_idx, best_lit_idx = -1, cnt;
     double best_lit_idx_rank, operation_lit_idx_rank;
-    int best_bit_gain = 0, curr_bit_gain = 0;
-    __int128_t operation_change_value, change_value;
+    __int128_t best_rank = -1, rank;
+    __int128_t operation_change_value;
     bool BMS = false;  // Best Move Strategy
-    bool should_push_vec;
+    bool operation_deferred;
     best_score = (is_idl) ? 0 : 1;
+    const __int128_t min_score = best_score;
     best_var_idx = -1;
-    change_value = 0;
     uint64_t best_last_move = UINT64_MAX;
     int operation_idx = 0;
     // 计算临界值
-    for (int i = 0; i < _unsat_clauses->size(); i++) {
-        clause* cl = &(_clauses[_unsat_clauses->element_at(i)]);
-        for (int l_sign_ldx : cl->lia_literals) {
-            int l_idx = std::abs(l_sign_ldx);
-            lit* l = &(_lits[l_idx]);
-
-            if (l->is_equal) {
-                // SASSERT(false);
-                if (l_sign_ldx < 0) {  // negative literal, -(a = b) TODO 可以区间采样
-                    for (int var_idx : l->pos_coff_var_idx) {
-                        if (_step > _tabulist[2 * var_idx]) {
-                            insert_operation(var_idx, 1, operation_idx, l_idx);
-                        }
-                        if (_step > _tabulist[2 * var_idx + 1]) {
-                            insert_operation(var_idx, -1, operation_idx, l_idx);
-                        }
-                    }
-                    for (int var_idx : l->neg_coff_var_idx) {
-                        if (_step > _tabulist[2 * var_idx]) {
-                            insert_operation(var_idx, 1, operation_idx, l_idx);
-                        }
-                        if (_step > _tabulist[2 * var_idx + 1]) {
-                            insert_operation(var_idx, -1, operation_idx, l_idx);
-                        }
-                    }
-                }  // delta should not be 0, while it is 0, so the var should increase 1/-1
-                else {
-                    for (int j = 0; j < l->pos_coff.size(); j++) {
-                        int var_idx = l->pos_coff_var_idx[j];
-                        if ((l->delta % l->pos_coff[j]) != 0) {
-                            continue;
-                        }
-                        if ((l->delta < 0 && _step > _tabulist[2 * var_idx]) ||
-                            (l->delta > 0 && _step > _tabulist[2 * var_idx + 1])) {
-                            insert_operation(var_idx, (-l->delta / l->pos_coff[j]), operation_idx, l_idx);
-                        }
-                    }
-                    for (int j = 0; j < l->neg_coff.size(); j++) {
-                        int var_idx = l->neg_coff_var_idx[j];
-                        if ((l->delta % l->neg_coff[j]) != 0) {
-                            continue;
-                        }
-                        if ((l->delta > 0 && _step > _tabulist[2 * var_idx]) ||
-                            (l->delta < 0 && _step > _tabulist[2 * var_idx + 1])) {
-                            insert_operation(var_idx, (l->delta / l->neg_coff[j]), operation_idx, l_idx);
-                        }
-                    }
-                }  // delta should be 0, while it is not 0, so the var should increase (-delta/coff), while (-delta%coff)==0
+    if (_candidate_clauses == 0 || _unsat_clauses->size() <= (int)_candidate_clauses) {
+        for (int i = 0; i < _unsat_clauses->size(); i++) {
+            add_clause_operations(&(_clauses[_unsat_clauses->element_at(i)]), operation_idx, false);
+        }
+    } else {  // bounded candidate set: a sample of the unsat clauses, each taken at most once
+        _clause_pick_stamp++;
+        for (unsigned k = 0; k < _candidate_clauses; k++) {
+            int c_idx = sample_unsat_clause();
+            if (_clause_pick_stamp_vec[c_idx] == _clause_pick_stamp)
                 continue;
-            }
-
-            for (int i = 0; i < l->pos_coff.size(); i++) {
-                should_push_vec = false;
-                int var_idx = l->pos_coff_var_idx[i];
-                if (var_idx == _lia_var_idx_with_most_lits) {
-                    continue;
-                }
-                if (l_sign_ldx > 0 && _step > _tabulist[2 * var_idx + 1]) {
-                    should_push_vec = true;
-                    change_value = devide(-l->delta, l->pos_coff[i]);
-                } else if (l_sign_ldx < 0 && _step > _tabulist[2 * var_idx]) {
-                    should_push_vec = true;
-                    change_value = devide(1 - l->delta, l->pos_coff[i]);
-                }
-                if (should_push_vec) {
-#ifndef BAM_V2
-                    if (_use_interval_move && !(is_pb || _vars[var_idx].is_in_equal))
-                        interval_move(var_idx, change_value);
-#endif
-                    insert_operation(var_idx, change_value, operation_idx, l_idx);
-                }
-                // if l_idx>0, delta should be <=0, while it is now >0(too large), so the var should enlarge by (-delta/coff) (this is a negative value), if l_idx<0, delta should be >=1, while it is now <1(too small), so the var should enlarge by (1-delta)/coff (positive value)
-            }
-            for (int i = 0; i < l->neg_coff.size(); i++) {
-                should_push_vec = false;
-                int var_idx = l->neg_coff_var_idx[i];
-                if (var_idx == _lia_var_idx_with_most_lits) {
-                    continue;
-                }
-                if (l_sign_ldx > 0 && _step > _tabulist[2 * var_idx]) {
-                    should_push_vec = true;
-                    change_value = devide(l->delta, l->neg_coff[i]);
-                } else if (l_sign_ldx < 0 && _step > _tabulist[2 * var_idx + 1]) {
-                    should_push_vec = true;
-                    change_value = devide(l->delta - 1, l->neg_coff[i]);
-                }
-                if (should_push_vec) {
-#ifndef BAM_V2
-                    if (_use_interval_move && !(is_pb || _vars[var_idx].is_in_equal))
-                        interval_move(var_idx, change_value);
-#endif
-                    insert_operation(var_idx, change_value, operation_idx, l_idx);
-                }
-                // if l_idx>0, delta should be <=0, while it is now >0(too large), so the var should enlarge by (delta/coff) (this is a positive value since the coff is neg), if l_idx<0, the delta should be >=1, while it is now <1(too small), so the var should enlarge by (delta-1)/coff (neg value)
-            }
+            _clause_pick_stamp_vec[c_idx] = _clause_pick_stamp;
+            add_clause_operations(&(_clauses[c_idx]), operation_idx, true);
         }
     }
     // go through the forward and backward move of vars, evaluate their score, pick the untabued best one
@@ -2519,19 +3112,34 @@ int ls_sampler::pick_critical_move(__int128_t& best_value) {
             operation_change_value = _operation_change_value_vec[idx];
             operation_var_idx = _operation_var_idx_vec[idx];
             operation_lit_idx = _operation_lit_idx_vec[idx];
+            operation_deferred = _operation_deferred_vec[idx];
             _operation_change_value_vec[idx] = _operation_change_value_vec[operation_idx - i - 1];
             _operation_var_idx_vec[idx] = _operation_var_idx_vec[operation_idx - i - 1];
             _operation_lit_idx_vec[idx] = _operation_lit_idx_vec[operation_idx - i - 1];
+            _operation_deferred_vec[idx] = _operation_deferred_vec[operation_idx - i - 1];
         } else {
             operation_change_value = _operation_change_value_vec[i];
             operation_var_idx = _operation_var_idx_vec[i];
             operation_lit_idx = _operation_lit_idx_vec[i];
+            operation_deferred = _operation_deferred_vec[i];
+        }
+        if (operation_deferred) {  // interval move of a sampled candidate, kept only if the target stays legal
+            __int128_t moved_value = operation_change_value;
+            interval_move(operation_var_idx, moved_value);
+            if (legal_move(operation_var_idx, moved_value))
+                operation_change_value = moved_value;
         }
-        score = critical_score(operation_var_idx, operation_change_value);
+        score = cached_critical_score(operation_var_idx, operation_change_value);
         int opposite_direction = (operation_change_value > 0) ? 1 : 0;  // if the change value is >0, then means it is moving forward, the opposite direction is 1(backward)
         uint64_t last_move_step = _last_move[2 * operation_var_idx + opposite_direction];
 
-        if (score > best_score || (score == best_score && last_move_step < best_last_move)) {
+        if (score < min_score)
+            continue;
+        // bit guided: the score of a move is scaled by the unseen bits it gains or loses, from 0 (all bit_width
+        // bits lost) to twice the score (all gained), so moves toward uncovered values win among decreasing ones
+        rank = bit_guided ? score * (int)(bit_width + bit_gain(operation_var_idx, operation_change_value)) : score;
+        if (rank > best_rank || (rank == best_rank && last_move_step < best_last_move)) {
+            best_rank = rank;
             best_score = score;
             best_var_idx = operation_var_idx;
             best_lit_idx = operation_lit_idx;
@@ -2555,7 +3163,7 @@ int ls_sampler::pick_critical_move(__int128_t& best_value) {
             operation_change_value = _operation_change_value_vec[i];
             operation_var_idx = _operation_var_idx_vec[i];
             operation_lit_idx = _operation_lit_idx_vec[i];
-            score = critical_score(operation_var_idx, operation_change_value);
+            score = cached_critical_score(operation_var_idx, operation_change_value);
             int opposite_direction = (operation_change_value > 0) ? 1 : 0;
             uint64_t last_move_step = _last_move[2 * operation_var_idx + opposite_direction];
             if (score > best_score || (score == best_score && last_move_step < best_last_move)) {
@@ -2676,6 +3284,10 @@ void ls_sampler::interval_move(uint64_t var_idx, __int128_t& change_value) {
 
 // random walk
 void ls_sampler::update_clause_weight() {
+    if (_trace) {
+        _trace->event(LS_TRACE_WEIGHT_UPDATE);
+    }
+    _weight_bumps++;
     for (int i = 0; i < _unsat_clauses->size(); i++) {
         clause* unsat_cl = &(_clauses[_unsat_clauses->element_at(i)]);
         unsat_cl->weight++;
@@ -2687,6 +3299,12 @@ void ls_sampler::update_clause_weight() {
 }
 
 void ls_sampler::smooth_clause_weight() {
+    if (_trace) {
+        _trace->event(LS_TRACE_WEIGHT_SMOOTH);
+    }
+    if (score_cache) {
+        reset_score_cache();
+    }
     for (int i = 0; i < _num_clauses; i++) {
         if (_clauses[i].weight > 1 && !_unsat_clauses->is_in_array(i)) {
             _clauses[i].weight--;
@@ -2842,6 +3460,9 @@ void ls_sampler::random_walk() {
     \brief return the dscore of op(var, change_val)
  */
 __int128_t ls_sampler::critical_subscore(uint64_t var_idx, __int128_t change_value) {
+    if (_trace) {
+        _trace->event(LS_TRACE_SUBSCORE, var_idx, change_value);
+    }
     __int128_t critical_subscore = 0;  // dscore
     __int128_t delta_old, delta_new;
     variable* var = &(_vars[var_idx]);
@@ -2911,7 +3532,13 @@ __int128_t ls_sampler::critical_subscore(uint64_t var_idx, __int128_t change_val
 }
 
 void ls_sampler::critical_move(uint64_t var_idx, __int128_t change_value) {
+    if (_trace) {
+        _trace->event(LS_TRACE_MOVE, var_idx, change_value);
+    }
     int direction = (change_value > 0) ? 0 : 1;
+    if (score_cache) {
+        dirty_var_neighbourhood(var_idx);
+    }
     if (_vars[var_idx].is_lia) {
         critical_score_subscore(var_idx, change_value);  // 修改lia变量取值及对其他文字或子句的影响
         is_overflow = __builtin_add_overflow(_solution[var_idx], change_value, &_solution[var_idx]) || is_overflow;
@@ -3034,7 +3661,7 @@ void ls_sampler::swap_from_small_weight_clause() {
                 if (l->delta == 0 && lit_sign < 0) {
                     for (int var_idx : l->pos_coff_var_idx) {
                         if (_solution[var_idx] + 1 <= _vars[var_idx].upper_bound && _solution[var_idx] + 1 >= _vars[var_idx].low_bound) {
-                            score = critical_score(var_idx, 1);
+                            score = cached_critical_score(var_idx, 1);
                             if (score > best_score) {
                                 best_score = score;
                                 best_operation_var = var_idx;
@@ -3042,7 +3669,7 @@ void ls_sampler::swap_from_small_weight_clause() {
                             }
                         }
                         if (_solution[var_idx] - 1 <= _vars[var_idx].upper_bound && _solution[var_idx] - 1 >= _vars[var_idx].low_bound) {
-                            score = critical_score(var_idx, -1);
+                            score = cached_critical_score(var_idx, -1);
                             if (score > best_score) {
                                 best_score = score;
                                 best_operation_var = var_idx;
@@ -3052,7 +3679,7 @@ void ls_sampler::swap_from_small_weight_clause() {
                     }
                     for (int var_idx : l->neg_coff_var_idx) {
                         if (_solution[var_idx] + 1 <= _vars[var_idx].upper_bound && _solution[var_idx] + 1 >= _vars[var_idx].low_bound) {
-                            score = critical_score(var_idx, 1);
+                            score = cached_critical_score(var_idx, 1);
                             if (score > best_score) {
                                 best_score = score;
                                 best_operation_var = var_idx;
@@ -3060,7 +3687,7 @@ void ls_sampler::swap_from_small_weight_clause() {
                             }
                         }
                         if (_solution[var_idx] - 1 <= _vars[var_idx].upper_bound && _solution[var_idx] - 1 >= _vars[var_idx].low_bound) {
-                            score = critical_score(var_idx, -1);
+                            score = cached_critical_score(var_idx, -1);
                             if (score > best_score) {
                                 best_score = score;
                                 best_operation_var = var_idx;
@@ -3077,7 +3704,7 @@ void ls_sampler::swap_from_small_weight_clause() {
                         }
                         value = (-l->delta / l->pos_coff[j]);
                         if (_solution[var_idx] + value <= _vars[var_idx].upper_bound && _solution[var_idx] + value >= _vars[var_idx].low_bound) {
-                            score = critical_score(var_idx, value);
+                            score = cached_critical_score(var_idx, value);
                             if (score > best_score) {
                                 best_score = score;
                                 best_operation_var = var_idx;
@@ -3092,7 +3719,7 @@ void ls_sampler::swap_from_small_weight_clause() {
                         }
                         value = (l->delta / l->neg_coff[j]);
                         if (_solution[var_idx] + value <= _vars[var_idx].upper_bound && _solution[var_idx] + value >= _vars[var_idx].low_bound) {
-                            score = critical_score(var_idx, value);
+                            score = cached_critical_score(var_idx, value);
                             if (score > best_score) {
                                 best_score = score;
                                 best_operation_var = var_idx;
@@ -3113,7 +3740,7 @@ void ls_sampler::swap_from_small_weight_clause() {
                         value = devide(l->delta - 1, l->neg_coff[i]);
                     }  // delta should >=1, while it is now <=0, it should enlarge by (1-delta/-coff) neg
                     if (_solution[var_idx] + value <= _vars[var_idx].upper_bound && _solution[var_idx] + value >= _vars[var_idx].low_bound) {
-                        score = critical_score(var_idx, value);
+                        score = cached_critical_score(var_idx, value);
                         if (score > best_score) {
                             best_score = score;
                             best_operation_var = var_idx;
@@ -3130,7 +3757,7 @@ void ls_sampler::swap_from_small_weight_clause() {
                         value = devide(1 - l->delta, l->pos_coff[i]);
                     }  // delta should >=1, while it is now <=0, it should enlarge by (1-delta/coff) pos
                     if (_solution[var_idx] + value <= _vars[var_idx].upper_bound && _solution[var_idx] + value >= _vars[var_idx].low_bound) {
-                        score = critical_score(var_idx, value);
+                        score = cached_critical_score(var_idx, value);
                         if (score > best_score) {
                             best_score = score;
                             best_operation_var = var_idx;
@@ -3235,6 +3862,9 @@ void ls_sampler::print_var_solution(std::string& var_name, std::string& var_valu
     } else if (pair_y->is_in_array(origin_var_idx)) {  // x-y=z case y
         var_value = print_128(pair_y_value[pair_y->index_of(origin_var_idx)]);
         return;
+    } else if (_name2eliminated.find(var_name) != _name2eliminated.end()) {  // solved from a unit equality
+        var_value = print_128(_eliminated_values[_name2eliminated[var_name]]);
+        return;
     } else if (_name2var.find(var_name) != _name2var.end()) {
         var_idx = _name2var[var_name];
         var_value = print_128(_solution[var_idx]);
@@ -14,14 +14,18 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <random>
 #include <set>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "Interval.h"
+#include "SampleBitSet.h"
 #include "lia_Array.h"
+#include "ls_trace.h"
 #include "util/debug.h"
 #include "util/trace.h"
 
@@ -41,7 +45,6 @@
 // #define BAM_V2 // 原始cm算子
 
 
-// #define BIT_GUIDED
 // #define CALC_DIVERSE_SAMPLE
 // #define PROB_GUIDED
 
@@ -62,7 +65,8 @@
 
 namespace sampler {
 
-typedef std::vector<__int128_t> SampleBitSet;
+// value bits of each var seen as 1 / as 0 by earlier samples, kept across checks by var name
+typedef std::unordered_map<std::string, std::pair<__uint128_t, __uint128_t>> seen_bits_map;
 
 struct Hash {
     std::size_t operator()(__int128_t x) const {
@@ -92,6 +96,13 @@ struct lit {
     uint64_t sat_steps_count = 0;
 };
 
+// occurrence of a var in a difference literal: moving the var by d moves the side by sign * d
+struct idl_occurrence {
+    int lit;     // signed literal, as in variable::literals
+    int clause;
+    int sign;    // +1 for x, -1 for y of x - y + k
+};
+
 struct variable {
     // literals[i] -- literal_clause[i] -- literal_coff[i] one-to-one correspondence
     std::vector<int> literals;             // literals[i]=l means the ith literal of the var is the pos(neg) of lth of _lits, it can be negative
@@ -128,6 +139,22 @@ struct clause {
     bool is_delete = false;          // true means var is deleted
 };
 
+// a lia var solved from a unit equality: var = key + sum coff * term
+struct eliminated_var {
+    std::string var_name;
+    __int128_t key = 0;
+    std::vector<std::pair<std::string, __int128_t>> terms;
+};
+
+// a scored move of a var in one direction, valid until the var's neighbourhood changes
+struct score_cache_entry {
+    __int128_t change_value = 0;
+    __int128_t score = 0;
+    uint64_t version = 0;       // _score_version when the score was computed
+    uint64_t weight_bumps = 0;  // _weight_bumps the score includes
+    int makes = 0;              // unsat clauses the move satisfies, each bump adds 1 to their weight
+};
+
 class ls_sampler {
    public:
     // debug
@@ -144,6 +171,74 @@ class ls_sampler {
 
     // strategy
     bool bit_guided = false;
+    unsigned _candidate_clauses = 0;  // unsat clauses sampled per step for move candidates, 0 scans all of them
+    bool score_cache = false;
+    bool eliminate_equalities = false;
+    unsigned _warm_restart_pct = 0;  // percent of lia vars re-drawn on a step-out restart, 0 restarts from scratch
+    bool pb_fast_path = true;        // flip search for instances whose lia vars are all 0/1
+    bool idl_fast_path = true;       // edge-list scoring for difference logic instances
+
+    // move score cache: _score_cache[2*var+1] for change_value > 0, [2*var] otherwise
+    std::vector<score_cache_entry> _score_cache;
+    std::vector<uint64_t> _var_score_version;  // version at which a clause of the var last changed
+    uint64_t _score_version = 1;
+    uint64_t _score_reset_version = 1;  // entries older than this are all invalid
+    uint64_t _weight_bumps = 0;         // update_clause_weight calls, added to the cached scores lazily
+    int _score_makes = 0;               // clauses made sat by the last critical_score
+    uint64_t _score_cache_lookups = 0;
+    uint64_t _score_cache_hits = 0;
+
+    // restart kernels: lia coefficients as a CSR matrix (row per literal) and the clause literals flattened
+    std::vector<uint64_t> _lit_row_start;
+    std::vector<int> _lit_col_var;
+    std::vector<__int128_t> _lit_col_coff;  // neg coffs are stored negated
+    std::vector<uint64_t> _clause_row_start;
+    std::vector<int> _clause_flat_lits;
+    std::vector<__int128_t> _lit_dtt;  // [2*lit] distance to true of the positive literal, [2*lit+1] of the negative one
+
+    // pseudo-Boolean fast path (pb_search.cpp): 0/1 assignment bit-packed, 64-bit literal sides
+    bool _use_pb_engine = false;
+    std::vector<uint64_t> _pb_assign;
+    std::vector<int64_t> _pb_lhs;              // per lit, lit::delta in 64 bits
+    std::vector<uint64_t> _pb_occ_start;       // var -> (lit, coff), a bool var has coff 0 in its own lits
+    std::vector<int> _pb_occ_lit;
+    std::vector<int64_t> _pb_occ_coff;
+    std::vector<uint64_t> _pb_lit_clause_start;  // lit -> clause + 1, negated for a negative occurrence
+    std::vector<int> _pb_lit_clause;
+    std::vector<int64_t> _pb_score;  // weighted make - break of flipping the var
+    std::vector<char> _pb_score_valid;
+    std::vector<char> _pb_fixed;
+    std::vector<int> _pb_clause_dsat;  // scratch of pb_score
+    std::vector<int> _pb_touched;
+    std::vector<int> _pb_candidates;
+    std::vector<uint64_t> _pb_candidate_stamp;
+
+    // difference-logic fast path (idl_search.cpp): literal x - y + k as the edge (x, y), k folded into lit::delta
+    bool _use_idl_engine = false;
+    std::vector<int> _idl_edge_x;
+    std::vector<int> _idl_edge_y;
+    std::vector<uint64_t> _idl_occ_start;  // var -> occurrences, in the order of variable::literals
+    std::vector<idl_occurrence> _idl_occ;
+
+    // instance construction: occurrence arrays are counted before they are filled
+    double _build_time = 0;      // seconds spent in the last build_instance
+    size_t _instance_bytes = 0;  // bytes held by the instance after the last build_instance
+
+    // move trace (ls_trace.cpp)
+    std::unique_ptr<ls_trace_writer> _trace;
+    bool _trace_taken = false;  // a sampler records one search at most
+
+    // bit coverage (bit guided mode)
+    seen_bits_map* _seen_bits = nullptr;
+    SampleBitSet _seen_one;     // bits of lia vars seen as 1
+    SampleBitSet _seen_zero;    // bits of lia vars seen as 0
+    SampleBitSet _sample_bits;  // scratch for the current sample
+    size_t _num_covered_bits = 0;
+    size_t _num_coverable_bits = 0;     // bit_width per lia var
+    uint64_t _seen_stamp = 0;           // bumped whenever _seen_one / _seen_zero change
+    std::vector<uint64_t> _gain_stamp;  // per var: _seen_stamp and value _gain_base was computed for
+    std::vector<__int128_t> _gain_value;
+    std::vector<int> _gain_base;        // unseen bits of the var's current value
 
     // CDCL(T) model
     std::unordered_map<std::string, std::string> last_cdcl_model;
@@ -178,19 +273,23 @@ class ls_sampler {
     // literals
     std::vector<lit> _lits;
     std::vector<int> _bound_lits;   // record the index of bounded lits
-    Array* _lit_occur;              // the lit containing the lia var in one single clause
+    Array* _lit_occur = nullptr;    // the lit containing the lia var in one single clause
     std::vector<bool> _lit_appear;  // ??
     // clauses
     std::vector<clause> _clauses;
-    Array* _unsat_clauses;                  // the set of unsat clauses
-    Array* _sat_clause_with_false_literal;  // clauses with 0<sat_num<literal_num, from which swap operation are choosen
-    Array* _contain_bool_unsat_clauses;     // unsat clause with at least one boolean var
+    Array* _unsat_clauses = nullptr;        // the set of unsat clauses
+    Array* _sat_clause_with_false_literal = nullptr;  // clauses with 0<sat_num<literal_num, from which swap operation are choosen
+    Array* _contain_bool_unsat_clauses = nullptr;     // unsat clause with at least one boolean var
     // diff logic
-    Array* pair_x;  // x-y-->z
-    Array* pair_y;
+    Array* pair_x = nullptr;  // x-y-->z
+    Array* pair_y = nullptr;
     std::vector<__int128_t> pair_x_value;  // x - y
     std::vector<__int128_t> pair_y_value;
     std::vector<std::pair<int, int>> equal_table;
+    // unit equalities
+    std::vector<eliminated_var> _eliminated_vars;  // in elimination order
+    std::unordered_map<std::string, int> _name2eliminated;
+    std::vector<__int128_t> _eliminated_values;
 
     /* auxiliary variables */
     const uint64_t _additional_len;
@@ -207,7 +306,7 @@ class ls_sampler {
 
     std::mt19937 mt;  // random number generator
     // step
-    uint64_t _step;              // the number of steps executed by the algorithm
+    uint64_t _step = 0;          // the number of steps executed by the algorithm
     uint64_t _outer_layer_step;  // the steps of the outer loop
     const uint64_t _max_step;    // the maximum allowed number of steps
     // data structure for clause weighting
@@ -236,10 +335,14 @@ class ls_sampler {
     std::vector<int> _operation_var_idx_vec;              // indices of variables involved in operations
     std::vector<__int128_t> _operation_change_value_vec;  // the change values for the variables involved in operations
     std::vector<int> _operation_lit_idx_vec;
+    std::vector<bool> _operation_deferred_vec;            // the interval move of the operation is applied when it is scored
+    std::vector<uint64_t> _clause_pick_stamp_vec;         // clauses already sampled in the current pick
+    uint64_t _clause_pick_stamp = 0;
     std::vector<int> _operation_var_idx_bool_vec;  // the indices of Boolean variables involved in operations
     std::vector<uint64_t> _last_move;              // the last move step for each variable. (上次移动是在第几步)
                                                    // for lia operations, _last_move[2*var+1] means change_value > 0; _last_move[2*var+0] means change_value <= 0;
     std::vector<bool> _is_chosen_bool_var;         // indicating which Boolean variables are chosen for operations
+    std::vector<int> _lit_exist;                   // scratch marks of critical_score_subscore, all zero between calls
     std::vector<int> _pre_value_1;                 // the 1st pre-set value of a var, if the var is in the form of (a==0 OR a==1)
     std::vector<int> _pre_value_2;                 // the 2nd pre-set value of a var
     // time
@@ -289,13 +392,29 @@ class ls_sampler {
         // std::random_device rd;
         mt.seed(seed);
     }
+    ~ls_sampler() { free_space(); }
+    ls_sampler(const ls_sampler&) = delete;
+    ls_sampler& operator=(const ls_sampler&) = delete;
     void make_space();
     void free_space();
+    void set_bit_coverage(seen_bits_map* seen_bits) {
+        _seen_bits = seen_bits;
+        bit_guided = seen_bits != nullptr;
+    }
+    void set_candidate_clauses(unsigned num_clauses) { _candidate_clauses = num_clauses; }
+    void set_score_cache(bool enable) { score_cache = enable; }
+    void set_eliminate_equalities(bool enable) { eliminate_equalities = enable; }
+    void set_warm_restart(unsigned pct) { _warm_restart_pct = std::min(pct, 100u); }
+    void set_pb_fast_path(bool enable) { pb_fast_path = enable; }
+    void set_idl_fast_path(bool enable) { idl_fast_path = enable; }
     void make_lits_space(uint64_t num_lits) {
         _num_lits = num_lits;
         _lits.resize(num_lits + _additional_len);
     };
     void initialize();
+    void warm_restart();
+    void end_restart();
+    void build_restart_matrix();
     void initialize_variable_datas();
     void initialize_lit_datas();
     void initialize_clause_datas();
@@ -305,6 +424,9 @@ class ls_sampler {
     void reduce_clause();
     void set_pre_value();
     void reduce_vars();
+    void eliminate_unit_equalities(std::vector<std::vector<int>>& clause_vec);
+    void choose_value_for_eliminated();
+    __int128_t reduced_var_value(const std::string& var_name);
     void calc_var_intervals();
 
     // random walk
@@ -320,9 +442,17 @@ class ls_sampler {
     void update_literals_sat_steps_count();
     // move
     void modify_CC(uint64_t var_idx, int direction);
+    void reset_score_cache();
+    void dirty_clause(int clause_idx);
+    void dirty_var_neighbourhood(uint64_t var_idx);
+    __int128_t cached_critical_score(uint64_t var_idx, __int128_t change_value);
+    int sample_unsat_clause();
+    void add_clause_operations(clause* cl, int& operation_idx, bool defer_interval);
+    void add_lia_operation(int var_idx, __int128_t change_value, int& operation_idx, int l_idx, bool defer_interval);
     int pick_critical_move(__int128_t& best_value);
     int pick_critical_move_bool();
     void critical_move(uint64_t var_idx, __int128_t change_value);
+    bool legal_move(int var_idx, __int128_t change_value);
     void insert_operation(int var_idx, __int128_t change_value, int& operation_idx);
     void insert_operation(int var_idx, __int128_t change_value, int& operation_idx, int const& flip_lit);
     __int128_t devide(__int128_t a, __int128_t b);
@@ -343,20 +473,65 @@ class ls_sampler {
     void convert_to_pos_delta(__int128_t& delta, int l_idx);  // Convert the value of delta to a positive value
     __int128_t critical_score(uint64_t var_idx, __int128_t change_value);
     __int128_t critical_subscore(uint64_t var_idx, __int128_t change_value);  // calculate dscore
+    int unseen_bits(uint64_t var_idx, __int128_t value) const;               // bits of the value no sample had yet
+    int bit_gain(uint64_t var_idx, __int128_t change_value);                   // unseen bits the move adds to the var's value
     void critical_score_subscore(uint64_t var_idx, __int128_t change_value);
     void critical_score_subscore(uint64_t var_idx);  // dedicated for boolean var
     // clean
     void clear_prev_data();
     void construct_solution_score();  // construct the solution based on score
+    void construct_var_value(int i);
     bool update_best_solution();
 
     // time
     double TimeElapsed_total();
 
+    /* bit coverage */
+    void load_seen_bits();
+    void record_sample_bits();
+    size_t num_covered_bits() const { return _num_covered_bits; }
+    size_t num_coverable_bits() const { return _num_coverable_bits; }
+    uint64_t num_steps() const { return _step; }
+    uint64_t num_score_cache_lookups() const { return _score_cache_lookups; }
+    uint64_t num_score_cache_hits() const { return _score_cache_hits; }
+    size_t instance_bytes() const;
+    double build_time() const { return _build_time; }
+    size_t num_instance_bytes() const { return _instance_bytes; }
+
+    /* move trace */
+    void set_trace(const std::string& path);
+    void trace_instance(const std::vector<std::vector<int>>& clause_vec, const std::unordered_map<std::string, std::string>& model);
+    void end_trace();
+    bool replay_trace(ls_trace_reader& in, ls_replay_stats& st);  // on the instance built from the trace
+
     /* ls_sampling */
     void ls_sampling();
     void shrinkSampleInterval(lit* l);
 
+    /* pseudo-Boolean fast path */
+    bool pb_applicable();
+    void build_pb_structures();
+    inline bool pb_value(int v) const { return (_pb_assign[v >> 6] >> (v & 63)) & 1; }
+    bool pb_lit_true(int l_idx) const;
+    void pb_invalidate_clause(int c_idx);
+    void pb_initialize();
+    int64_t pb_score(int v);
+    void pb_flip(int v);
+    void pb_update_weights();
+    int pb_pick_var();
+    void pb_store_solution();
+    bool pb_search();
+    bool using_pb_engine() const { return _use_pb_engine; }
+
+    /* difference-logic fast path */
+    bool idl_applicable();
+    void build_idl_structures();
+    __int128_t idl_moved_delta(const idl_occurrence& o, lit* l, __int128_t change_value);
+    __int128_t idl_critical_score(uint64_t var_idx, __int128_t change_value);
+    void idl_critical_score_subscore(uint64_t var_idx, __int128_t change_value);
+    void idl_add_clause_operations(clause* cl, int& operation_idx, bool defer_interval);
+    bool using_idl_engine() const { return _use_idl_engine; }
+
     /* search */
     bool search();
     void swap_from_small_weight_clause();
@@ -26,6 +26,18 @@ void smt_params::updt_local_params(params_ref const & _p) {
     m_auto_config = p.auto_config() && gparams::get_value("auto_config") == "true"; // auto-config is not scoped by smt in gparams.
     m_random_seed = p.random_seed();
     m_ls_sampling = p.ls_sampling();
+    m_ls_timeout = p.ls_timeout();
+    m_ls_bit_guided = p.ls_bit_guided();
+    m_ls_candidate_clauses = p.ls_candidate_clauses();
+    m_ls_score_cache = p.ls_score_cache();
+    m_ls_warm_restart = p.ls_warm_restart();
+    m_ls_eliminate_equalities = p.ls_eliminate_equalities();
+    m_ls_pb_fast_path = p.ls_pb_fast_path();
+    m_ls_idl_fast_path = p.ls_idl_fast_path();
+    m_ls_trace = p.ls_trace();
+    m_cdcl_diversify = p.cdcl_diversify();
+    m_cdcl_diversify_activity = p.cdcl_diversify_activity();
+    m_cdcl_diversify_lra = p.cdcl_diversify_lra();
     m_relevancy_lvl = p.relevancy();
     m_ematching   = p.ematching();
     m_induction   = p.induction();
@@ -49,6 +61,8 @@ void smt_params::updt_local_params(params_ref const & _p) {
     m_threads       = p.threads();
     m_threads_max_conflicts  = p.threads_max_conflicts();
     m_threads_cube_frequency = p.threads_cube_frequency();
+    m_threads_sample_models = p.threads_sample_models();
+    m_threads_sample_timeout = p.threads_sample_timeout();
     m_core_validate = p.core_validate();
     m_sls_enable = p.sls_enable();
     m_sls_parallel = p.sls_parallel();
@@ -125,6 +139,8 @@ void smt_params::display(std::ostream & out) const {
     DISPLAY_PARAM(m_threads);
     DISPLAY_PARAM(m_threads_max_conflicts);
     DISPLAY_PARAM(m_threads_cube_frequency);
+    DISPLAY_PARAM(m_threads_sample_models);
+    DISPLAY_PARAM(m_threads_sample_timeout);
     DISPLAY_PARAM(m_simplify_clauses);
     DISPLAY_PARAM(m_tick);
     DISPLAY_PARAM(m_display_features);
@@ -189,6 +205,17 @@ void smt_params::display(std::ostream & out) const {
     DISPLAY_PARAM(m_auto_config);
     DISPLAY_PARAM(m_ls_sampling);
     DISPLAY_PARAM(m_ls_timeout);
+    DISPLAY_PARAM(m_ls_bit_guided);
+    DISPLAY_PARAM(m_ls_candidate_clauses);
+    DISPLAY_PARAM(m_ls_score_cache);
+    DISPLAY_PARAM(m_ls_warm_restart);
+    DISPLAY_PARAM(m_ls_eliminate_equalities);
+    DISPLAY_PARAM(m_ls_pb_fast_path);
+    DISPLAY_PARAM(m_ls_idl_fast_path);
+    DISPLAY_PARAM(m_ls_trace);
+    DISPLAY_PARAM(m_cdcl_diversify);
+    DISPLAY_PARAM(m_cdcl_diversify_activity);
+    DISPLAY_PARAM(m_cdcl_diversify_lra);
 }
 
 void smt_params::validate_string_solver(symbol const& s) const {
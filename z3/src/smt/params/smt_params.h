@@ -106,6 +106,8 @@ struct smt_params : public preprocessor_params,
     unsigned         m_threads = 1;
     unsigned         m_threads_max_conflicts = UINT_MAX;
     unsigned         m_threads_cube_frequency = 2;
+    unsigned         m_threads_sample_models = 0;
+    unsigned         m_threads_sample_timeout = 0;
     bool             m_simplify_clauses = true;
     unsigned         m_tick = 1000;
     bool             m_display_features = false;
@@ -236,6 +238,17 @@ struct smt_params : public preprocessor_params,
     bool                m_auto_config = true;
     bool                m_ls_sampling = false;
     unsigned            m_ls_timeout = 50;
+    bool                m_ls_bit_guided = false;
+    unsigned            m_ls_candidate_clauses = 0;
+    bool                m_ls_score_cache = false;
+    unsigned            m_ls_warm_restart = 0;
+    bool                m_ls_eliminate_equalities = false;
+    bool                m_ls_pb_fast_path = true;
+    bool                m_ls_idl_fast_path = true;
+    symbol              m_ls_trace;
+    bool                m_cdcl_diversify = false;
+    double              m_cdcl_diversify_activity = 0.5;
+    bool                m_cdcl_diversify_lra = true;
 
     // -----------------------------------
     //
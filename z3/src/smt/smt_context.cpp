@@ -85,7 +85,6 @@ context::context(ast_manager& m, smt_params& p, params_ref const& _p) : m(m),
                                                                         m_mk_enode_trail(*this),
                                                                         m_mk_lambda_trail(*this),
                                                                         m_lemma_visitor(m) {
-    m_ls_sampler = new sampler::ls_sampler(m_fparams.m_random_seed, m_fparams.m_ls_timeout);
     SASSERT(m_scope_lvl == 0);
     SASSERT(m_base_lvl == 0);
     SASSERT(m_search_lvl == 0);
@@ -3424,6 +3423,7 @@ bool context::check_preamble(bool reset_cancel) {
     }
     reset_tmp_clauses();
     m_unsat_core.reset();
+    m_sampled_models.reset();
     m_stats.m_num_checks++;
     pop_to_base_lvl();
     m_conflict_resolution->reset();
@@ -3566,13 +3566,24 @@ lbool context::setup_and_check(bool reset_cancel) {
         TRACE("before_search", display(tout););
 
         if (m_fparams.m_ls_sampling) {  // sampling flag
-            expr_bool_var_map(m_ls_sampler);
+            if (!m_ls_sampler)
+                m_ls_sampler = alloc(sampler::ls_sampler, m_fparams.m_random_seed, m_fparams.m_ls_timeout);
+            if (m_fparams.m_ls_trace.is_non_empty_string())
+                m_ls_sampler->set_trace(m_fparams.m_ls_trace.str());
+            expr_bool_var_map(m_ls_sampler.get());
+            m_ls_sampler->set_eliminate_equalities(m_fparams.m_ls_eliminate_equalities);
+            m_ls_sampler->set_pb_fast_path(m_fparams.m_ls_pb_fast_path);
+            m_ls_sampler->set_idl_fast_path(m_fparams.m_ls_idl_fast_path);
             m_ls_sampler->build_instance(clauses_vec, m.last_CDCL_model);
+            m_ls_sampler->set_bit_coverage(m_fparams.m_ls_bit_guided ? &m.ls_seen_bits : nullptr);
+            m_ls_sampler->set_candidate_clauses(m_fparams.m_ls_candidate_clauses);
+            m_ls_sampler->set_score_cache(m_fparams.m_ls_score_cache);
+            m_ls_sampler->set_warm_restart(m_fparams.m_ls_warm_restart);
             m_ls_sampler->ls_sampling();
             if (m_ls_sampler->_best_found_cost == 0) {
                 try {
                     m_model_generator->reset();
-                    m_proto_model = m_model_generator->mk_model_sampling(m_ls_sampler);
+                    m_proto_model = m_model_generator->mk_model_sampling(m_ls_sampler.get());
                 } catch (default_exception& ex) {
                     return check_finalize(l_undef);
                 }
@@ -3702,6 +3713,8 @@ void context::init_search() {
     m_final_check_idx = 0;
     m_phase_default = false;
     m_case_split_queue->init_search_eh();
+    if (m_fparams.m_cdcl_diversify && m_stats.m_num_checks > 1)
+        diversify_search();
     m_next_progress_sample = 0;
     m_internal_completed = l_undef;
     if (m.has_type_vars() && !m_theories.get_plugin(poly_family_id))
@@ -3709,6 +3722,40 @@ void context::init_search() {
     TRACE("literal_occ", display_literal_num_occs(tout););
 }
 
+/**
+   \brief Sampling mode: move the next model away from the previous one.
+   The decision phases are redrawn, the activities perturbed and the theories
+   may shift their assignment; learned clauses and the LP tableau are kept.
+*/
+void context::diversify_search() {
+    double amp = std::max(0.0, std::min(m_fparams.m_cdcl_diversify_activity, 1.0));
+    double max_act = 0.0;
+    unsigned num_vars = get_num_bool_vars();
+    for (bool_var v = 0; v < static_cast<bool_var>(num_vars); ++v) {
+        bool_var_data & d = m_bdata[v];
+        d.m_phase_available = true;
+        d.m_phase = m_random() % 2 == 0;
+        if (amp == 0.0)
+            continue;
+        double u = static_cast<double>(m_random()) / random_gen::max_value();
+        double old_act = m_activity[v];
+        double new_act = old_act * (1.0 + amp * (2.0 * u - 1.0)) + m_bvar_inc * amp * u;
+        m_activity[v] = new_act;
+        max_act = std::max(max_act, new_act);
+        if (new_act > old_act)
+            m_case_split_queue->activity_increased_eh(v);
+        else if (new_act < old_act)
+            m_case_split_queue->activity_decreased_eh(v);
+    }
+    if (max_act > ACTIVITY_LIMIT)
+        rescale_bool_var_activity();
+    if (m_fparams.m_cdcl_diversify_lra) {
+        for (theory* th : m_theory_set)
+            th->diversify_eh();
+    }
+    TRACE("search", tout << "diversified " << num_vars << " bool vars\n";);
+}
+
 void context::end_search() {
     m_case_split_queue->end_search_eh();
 }
@@ -93,7 +93,7 @@ namespace smt {
 
 
     protected:
-        sampler::ls_sampler *       m_ls_sampler;
+        scoped_ptr<sampler::ls_sampler> m_ls_sampler;  // allocated by the first check with ls_sampling
         ast_manager &               m;
         smt_params &                m_fparams;
         params_ref                  m_params;
@@ -231,6 +231,7 @@ namespace smt {
         // -----------------------------------
         proto_model_ref            m_proto_model;
         model_ref                  m_model;
+        vector<model_ref>          m_sampled_models;  // all models of the last parallel check in sampling mode
         const char *               m_unknown;
         void                       mk_proto_model();
         void                       reset_model() { m_model = nullptr; m_proto_model = nullptr; }
@@ -1270,6 +1271,8 @@ namespace smt {
 
         void init_search();
 
+        void diversify_search();
+
         void end_search();
 
         lbool search();
@@ -1737,6 +1740,8 @@ namespace smt {
 
         void set_model(model* m) { m_model = m; }
 
+        vector<model_ref> const& get_sampled_models() const { return m_sampled_models; }
+
         bool update_model(bool refinalize);
 
         bool validate_model();
@@ -601,6 +601,21 @@ void context::collect_statistics(::statistics& st) const {
     st.update("minimized lits", m_stats.m_num_minimized_lits);
     st.update("num checks", m_stats.m_num_checks);
     st.update("mk bool var", m_stats.m_num_mk_bool_var ? m_stats.m_num_mk_bool_var - 1 : 0);
+    if (m_fparams.m_ls_sampling && m_ls_sampler) {
+        st.update("ls-sampler-steps", (double)m_ls_sampler->num_steps());
+        st.update("ls-sampler-pb-engine", m_ls_sampler->using_pb_engine() ? 1u : 0u);
+        st.update("ls-sampler-idl-engine", m_ls_sampler->using_idl_engine() ? 1u : 0u);
+        st.update("ls-sampler-build-time", m_ls_sampler->build_time());
+        st.update("ls-sampler-instance-mb", (double)m_ls_sampler->num_instance_bytes() / (1024 * 1024));
+        if (m_fparams.m_ls_bit_guided) {
+            st.update("ls-sampler-covered-bits", (double)m_ls_sampler->num_covered_bits());
+            st.update("ls-sampler-coverable-bits", (double)m_ls_sampler->num_coverable_bits());
+        }
+        if (m_fparams.m_ls_score_cache) {
+            st.update("ls-sampler-score-lookups", (double)m_ls_sampler->num_score_cache_lookups());
+            st.update("ls-sampler-score-hits", (double)m_ls_sampler->num_score_cache_hits());
+        }
+    }
     m_qmanager->collect_statistics(st);
     m_asserted_formulas.collect_statistics(st);
     for (theory* th : m_theory_set) {
@@ -151,6 +151,10 @@ namespace smt {
         m_imp->m_kernel.get_model(m);
     }
 
+    void kernel::get_sampled_models(vector<model_ref> & models) {
+        models.append(m_imp->m_kernel.get_sampled_models());
+    }
+
     proof * kernel::get_proof() {
         return m_imp->m_kernel.get_proof();
     }
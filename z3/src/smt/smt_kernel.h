@@ -164,6 +164,12 @@ namespace smt {
         */
         void get_model(model_ref & m);
 
+        /**
+           \brief Return the models the workers of the last parallel check found
+           besides the one of get_model (smt.threads.sample_models).
+        */
+        void get_sampled_models(vector<model_ref> & models);
+
         /**
            \brief Return the proof of unsatisfiability associated with the last check command.
         */
@@ -17,6 +17,7 @@ Author:
 
 
 #include "util/scoped_ptr_vector.h"
+#include "util/stopwatch.h"
 #include "ast/ast_util.h"
 #include "ast/ast_pp.h"
 #include "ast/ast_ll_pp.h"
@@ -46,12 +47,31 @@ namespace smt {
         flet<unsigned> _nt(ctx.m_fparams.m_threads, 1);
         unsigned thread_max_conflicts = ctx.get_fparams().m_threads_max_conflicts;
         unsigned max_conflicts = ctx.get_fparams().m_max_conflicts;
+        // sampling: the workers go on after a model until sample_models models or sample_timeout ms
+        unsigned sample_models = ctx.get_fparams().m_threads_sample_models;
+        unsigned sample_timeout = ctx.get_fparams().m_threads_sample_timeout;
+        vector<model_ref> sampled;
+        stopwatch sample_sw;
+        sample_sw.start();
+        auto sampling_done = [&]() {
+            return sampled.size() >= sample_models || (sample_timeout > 0 && sample_sw.get_current_seconds() * 1000 >= sample_timeout);
+        };
 
         // try first sequential with a low conflict budget to make super easy problems cheap
         unsigned max_c = std::min(thread_max_conflicts, 40u);
         flet<unsigned> _mc(ctx.get_fparams().m_max_conflicts, max_c);
         result = ctx.check(asms.size(), asms.data());
-        if (result != l_undef || ctx.m_num_conflicts < max_c) {
+        if (result == l_true && sample_models > 0) {
+            model_ref mdl;
+            ctx.get_model(mdl);
+            if (mdl)
+                sampled.push_back(mdl);
+            if (sampling_done()) {
+                ctx.m_sampled_models.swap(sampled);
+                return result;
+            }
+        }
+        else if (result != l_undef || ctx.m_num_conflicts < max_c) {
             return result;
         }        
 
@@ -156,6 +176,27 @@ namespace smt {
                            if (c) verbose_stream() << " :cube " << mk_bounded_pp(c, pm, 3);
                            verbose_stream() << ")\n";);
                 lbool r = pctx.check(lasms.size(), lasms.data());
+
+                // sampling: hand every model over and search on with a new seed and diversified phases
+                if (sample_models > 0) {
+                    ast_translation tr(pm, m);
+                    pctx.get_fparams().m_cdcl_diversify = true;
+                    while (r == l_true) {
+                        model_ref mdl;
+                        pctx.get_model(mdl);
+                        {
+                            std::lock_guard<std::mutex> lock(mux);
+                            if (done)
+                                return;
+                            if (mdl)
+                                sampled.push_back(mdl->translate(tr));
+                            if (sampling_done())
+                                break;
+                        }
+                        pctx.set_random_seed(pctx.get_random_value());
+                        r = pctx.check(lasms.size(), lasms.data());
+                    }
+                }
                 
                 if (r == l_undef && pctx.m_num_conflicts >= max_conflicts) 
                     ; // no-op
@@ -223,6 +264,7 @@ namespace smt {
                 th.join();
             }
             if (done) break;
+            if (!sampled.empty() && sampling_done()) break;  // sample timeout between rounds
 
             collect_units();
             ++num_rounds;
@@ -234,6 +276,14 @@ namespace smt {
             c->collect_statistics(ctx.m_aux_stats);
         }
 
+        if (!sampled.empty()) {
+            ctx.m_sampled_models.swap(sampled);
+            if (finished_id == UINT_MAX) {
+                ctx.set_model(ctx.m_sampled_models.back().get());
+                return l_true;
+            }
+        }
+
         if (finished_id == UINT_MAX) {
             switch (ex_kind) {
             case ERROR_EX: throw z3_error(error_code);
@@ -208,6 +208,10 @@ namespace {
             m_context.get_levels(vars, depth);
         }
 
+        void get_sampled_models_core(vector<model_ref>& models) override {
+            m_context.get_sampled_models(models);
+        }
+
         expr_ref_vector get_trail(unsigned max_level) override {
             return m_context.get_trail(max_level);
         }
@@ -311,6 +311,14 @@ namespace smt {
         virtual void init_search_eh() {
         }
 
+        /**
+           \brief This method is invoked before the search of a check that follows
+           another one when smt.cdcl_diversify is set. The theory may move its
+           current assignment so that the next model differs from the last one.
+        */
+        virtual void diversify_eh() {
+        }
+
         /**
            \brief This method is invoked when the logical context assigned
            a truth value to all boolean variables and no inconsistency was 
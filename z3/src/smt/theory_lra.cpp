@@ -1418,6 +1418,20 @@ public:
         m_num_conflicts = 0;
     }
 
+    // shift the non-basic columns inside their bounds, as random_update does for model equalities;
+    // after a pop the tableau may not be feasible, then the values are left alone
+    void diversify_eh() {
+        if (!m_lia || m_nla || !lp().check_feasible())
+            return;
+        svector<lpvar> vars;
+        for (lpvar j = 0; j < lp().column_count(); ++j) {
+            if (!lp().column_is_fixed(j) && !lp().is_base(j))
+                vars.push_back(j);
+        }
+        if (!vars.empty())
+            lp().random_update(vars.size(), vars.data());
+    }
+
     bool can_get_value(theory_var v) const {
         return is_registered_var(v) && m_model_is_initialized;
     }
@@ -4250,6 +4264,9 @@ void theory_lra::relevant_eh(app* e) {
 void theory_lra::init_search_eh() {
     m_imp->init_search_eh();
 }
+void theory_lra::diversify_eh() {
+    m_imp->diversify_eh();
+}
 final_check_status theory_lra::final_check_eh() {
     return m_imp->final_check_eh();
 }
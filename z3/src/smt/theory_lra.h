@@ -63,6 +63,8 @@ namespace smt {
 
         void init_search_eh() override;
 
+        void diversify_eh() override;
+
         final_check_status final_check_eh() override;
 
         bool is_shared(theory_var v) const override;
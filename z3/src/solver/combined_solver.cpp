@@ -317,6 +317,13 @@ public:
             m_solver2->get_levels(vars, depth);
     }
 
+    void get_sampled_models_core(vector<model_ref>& models) override {
+        if (m_use_solver1_results)
+            m_solver1->get_sampled_models(models);
+        else
+            m_solver2->get_sampled_models(models);
+    }
+
     expr_ref_vector get_trail(unsigned max_level) override {
         if (m_use_solver1_results)
             return m_solver1->get_trail(max_level);
@@ -400,6 +400,7 @@ public:
     void get_units_core(expr_ref_vector& units) override { s->get_units_core(units); }
     expr_ref_vector get_trail(unsigned max_level) override { return s->get_trail(max_level); }
     void get_levels(ptr_vector<expr> const& vars, unsigned_vector& depth) override { s->get_levels(vars, depth); }
+    void get_sampled_models_core(vector<model_ref>& models) override { s->get_sampled_models(models); }
 
     void register_on_clause(void* ctx, user_propagator::on_clause_eh_t& on_clause) override {
         s->register_on_clause(ctx, on_clause);
@@ -296,6 +296,20 @@ public:
     
     virtual void get_levels(ptr_vector<expr> const& vars, unsigned_vector& depth) = 0;
 
+    /**
+       \brief models found besides the model of the last check,
+       e.g. by the other workers of a parallel check (smt.threads.sample_models).
+    */
+    void get_sampled_models(vector<model_ref>& models) {
+        get_sampled_models_core(models);
+        if (mc0()) {
+            for (model_ref& mdl : models)
+                (*mc0())(mdl);
+        }
+    }
+
+    virtual void get_sampled_models_core(vector<model_ref>& models) {}
+
     class scoped_push {
         solver& s;
         bool    m_nopop;
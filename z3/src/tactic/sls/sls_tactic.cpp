@@ -36,11 +36,14 @@ class sls_smt_tactic : public tactic {
     params_ref   m_params;
     sls::smt_solver*     m_sls;
     statistics   m_st;
+    expr_ref_vector m_initial_vars, m_initial_values;
 
 public:
     sls_smt_tactic(ast_manager& _m, params_ref const& p) :
         m(_m),
-        m_params(p) {
+        m_params(p),
+        m_initial_vars(_m),
+        m_initial_values(_m) {
         m_sls = alloc(sls::smt_solver, m, p);
     }
 
@@ -63,6 +66,12 @@ public:
         sls_params::collect_param_descrs(r);
     }
 
+    // initial values only seed the next check, m_sls is recreated by cleanup
+    void user_propagate_initialize_value(expr* var, expr* value) override {
+        m_initial_vars.push_back(var);
+        m_initial_values.push_back(value);
+    }
+
     void run(goal_ref const& g, model_converter_ref& mc) {
         if (g->inconsistent()) {
             mc = nullptr;
@@ -71,6 +80,10 @@ public:
 
         for (unsigned i = 0; i < g->size(); i++)
             m_sls->assert_expr(g->form(i));
+        for (unsigned i = 0; i < m_initial_vars.size(); i++)
+            m_sls->set_initial_value(m_initial_vars.get(i), m_initial_values.get(i));
+        m_initial_vars.reset();
+        m_initial_values.reset();
 
 
         m_st.reset();
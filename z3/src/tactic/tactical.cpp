@@ -1049,6 +1049,7 @@ public:
     char const* name() const override { return "try_for"; }
     
     void operator()(goal_ref const & in, goal_ref_buffer& result) override {
+        m_clean = false;
         cancel_eh<reslimit> eh(in->m().limit());
         { 
             scoped_timer timer(m_timeout, &eh);
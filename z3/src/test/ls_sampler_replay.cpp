@@ -0,0 +1,104 @@
+/*++
+Module Name:
+
+    ls_sampler_replay.cpp
+
+Abstract:
+
+    Replay of a CCSS move trace (smt.ls_trace): rebuilds the recorded
+    instance, re-executes its moves and scorings and reports the time per
+    call of each kernel.
+
+    test-z3 ls_sampler_replay <trace> [-r <repetitions>] [-c <0|1>]
+
+    -c replays the scorings with (1) or without (0) the score cache
+    instead of the setting of the recorded run.
+
+--*/
+#include <chrono>
+#include <iostream>
+#include "sampler/sampler.h"
+#include "util/statistics.h"
+
+// time of an empty steady_clock interval, subtracted from every replayed call
+static double clock_overhead_ns() {
+    const unsigned n = 100000;
+    double total = 0;
+    for (unsigned k = 0; k < n; ++k) {
+        auto start = std::chrono::steady_clock::now();
+        total += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    return total / n;
+}
+
+void tst_ls_sampler_replay(char** argv, int argc, int& i) {
+    if (argc < i + 2) {
+        std::cout << "require trace file name\n";
+        return;
+    }
+    char const* file_name = argv[i + 1];
+    ++i;
+    unsigned repetitions = 1;
+    int score_cache = -1;
+    while (i + 2 < argc && argv[i + 1][0] == '-') {
+        switch (argv[i + 1][1]) {
+        case 'r':
+            repetitions = std::max(atoi(argv[i + 2]), 1);
+            break;
+        case 'c':
+            score_cache = atoi(argv[i + 2]) != 0;
+            break;
+        default:
+            break;
+        }
+        i += 2;
+    }
+
+    sampler::ls_trace_reader reader;
+    sampler::ls_trace_instance instance;
+    if (!reader.open(file_name, instance)) {
+        std::cout << "not an ls trace: " << file_name << "\n";
+        return;
+    }
+    sampler::ls_sampler s(instance.seed, 0);
+    s.set_eliminate_equalities(instance.eliminate_equalities);
+    s.set_pb_fast_path(false);
+    s.set_idl_fast_path(instance.idl_fast_path);
+    s.make_lits_space(instance.num_lits);
+    for (std::string& l : instance.lits) {
+        s.build_lits(l);
+    }
+    std::unordered_map<std::string, std::string> model(instance.model.begin(), instance.model.end());
+    s.build_instance(instance.clauses, model);
+    s.set_score_cache(score_cache == -1 ? instance.score_cache : score_cache == 1);
+
+    sampler::ls_replay_stats st;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < repetitions; ++r) {
+        reader.rewind();
+        if (!s.replay_trace(reader, st)) {
+            std::cout << "the trace does not match its instance\n";
+            return;
+        }
+    }
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double overhead = clock_overhead_ns();
+
+    statistics stats;
+    std::vector<std::string> names;  // statistics keeps the key pointers
+    names.reserve(2 * sampler::LS_TRACE_NUM_KINDS);
+    stats.update("replay-build-time", s.build_time());
+    stats.update("replay-time", total);
+    stats.update("replay-clock-overhead-ns", overhead);
+    for (unsigned k = sampler::LS_TRACE_INIT; k < sampler::LS_TRACE_NUM_KINDS; ++k) {
+        if (st.count[k] == 0) {
+            continue;
+        }
+        std::string name = std::string("replay-") + sampler::ls_trace_kind_name(k);
+        names.push_back(name + "-calls");
+        stats.update(names.back().c_str(), (double)st.count[k]);
+        names.push_back(name + "-ns");
+        stats.update(names.back().c_str(), std::max(st.ns[k] / st.count[k] - overhead, 0.0));
+    }
+    stats.display_smt2(std::cout);
+}
@@ -257,6 +257,7 @@ int main(int argc, char ** argv) {
     TST_ARGV(sat_lookahead);
     TST_ARGV(sat_local_search);
     TST_ARGV(cnf_backbones);
+    TST_ARGV(ls_sampler_replay);
     TST(bdd);
     TST(pdd);
     TST(pdd_solver);